@@ -0,0 +1,43 @@
+#!/bin/bash
+die() { echo "$@" >&2; exit 1
+}
+
+echo 'Testing the binary .sgb networks of -mode convert'
+
+TEST_DIR=`pwd`/regression-tests/BinaryGraph
+[ -d "$TEST_DIR" ] || die "should be run from top-level directory of the SANA repo"
+
+# a .gw and an edge list from the other tests; convert writes the .sgb files next to -o
+G1="`pwd`/regression-tests/CompressedFiles/yeast-reduced-wayne.gw"
+G2="`pwd`/regression-tests/DifferentFormat/yeast.el"
+rm -f "$TEST_DIR"/*.sgb
+
+exitCode=0
+
+echo "Converting yeast-reduced-wayne.gw and yeast.el to .sgb"
+if ./sana -mode convert -fg1 "$G1" -fg2 "$G2" -o "$TEST_DIR/convert" &> "$TEST_DIR/convert.progress"; then
+    :
+else
+    die "Conversion to .sgb failed"
+fi
+
+# a fixed seed and schedule, so that both runs make the same moves
+ARGS="-s3 1 -usingIterations -t 1 -tinitial 1 -tdecay 10 -seed 1"
+echo "Aligning the text networks"
+./sana -fg1 "$G1" -fg2 "$G2" $ARGS -o "$TEST_DIR/text" &> "$TEST_DIR/text.progress" || die "Alignment of the text networks failed"
+echo "Aligning the .sgb networks"
+./sana -fg1 "$TEST_DIR/yeast-reduced-wayne.sgb" -fg2 "$TEST_DIR/yeast.sgb" $ARGS -o "$TEST_DIR/binary" &> "$TEST_DIR/binary.progress" || die "Alignment of the .sgb networks failed"
+
+scores() { sed -n '/^Scores:/,/^Common subgraph:/p' "$1"
+}
+if [ "`scores $TEST_DIR/text.out`" != "`scores $TEST_DIR/binary.out`" ]; then
+    echo "The .sgb networks give different scores than the text networks"
+    exitCode=1
+fi
+if ! cmp -s "$TEST_DIR/text.align" "$TEST_DIR/binary.align"; then
+    echo "The .sgb networks give a different alignment than the text networks"
+    exitCode=1
+fi
+
+echo 'Done testing .sgb networks'
+exit $exitCode
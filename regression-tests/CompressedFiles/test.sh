@@ -24,13 +24,54 @@ fi
 
 echo "Test 2: Testing compressed edgelists AThaliana.el.gz and yeast-reduced-wayne.gw.gz"
 ./sana -t 1 -fg1 "$TEST_DIR/AThaliana.el.gz" -fg2 "$TEST_DIR/yeast-reduced-wayne.gw.gz"  -o "$TEST_DIR/test2" &> "$TEST_DIR/test2.progress"
-lines=`wc -l $TEST_DIR/test1.align | awk '{print $1}'`;
+lines=`wc -l $TEST_DIR/test2.align | awk '{print $1}'`;
 if [ $lines -lt 100 ]
 then
     echo "Test 2: Failed to load networks AThaliana.el.gz and yeast-reduced-wayne.gw.gz"
     exitCode=1
 fi
 
+
+# Tests 3 and 4 compress yeast-reduced-wayne.gw with each format, in one stream and
+# in two concatenated ones; every file must align exactly like the uncompressed one
+WORK_DIR=`mktemp -d`
+trap 'rm -rf "$WORK_DIR"' EXIT
+G1="$TEST_DIR/yeast-reduced-wayne.gw"
+head -9000 "$G1" > "$WORK_DIR/first"
+tail -n +9001 "$G1" > "$WORK_DIR/second"
+ARGS="-s3 1 -usingIterations -t 1 -tinitial 1 -tdecay 10 -seed 1 -fg2 $TEST_DIR/../DifferentFormat/yeast.el"
+./sana -fg1 "$G1" $ARGS -o "$WORK_DIR/plain" &> "$TEST_DIR/plain.progress"
+
+for format in gzip bzip2 xz; do
+    case $format in gzip) ext=gz;; bzip2) ext=bz2;; xz) ext=xz;; esac
+    if ! command -v $format > /dev/null; then
+	echo "Tests 3 and 4: $format is not installed, skipping .$ext"
+	continue
+    fi
+    $format -c "$G1" > "$WORK_DIR/single.gw.$ext"
+    ($format -c "$WORK_DIR/first"; $format -c "$WORK_DIR/second") > "$WORK_DIR/multi.gw.$ext"
+
+    for streams in single multi; do
+	echo "Test 3: Testing $streams-stream .$ext network"
+	./sana -fg1 "$WORK_DIR/$streams.gw.$ext" $ARGS -o "$WORK_DIR/$streams-$ext" &> "$TEST_DIR/$streams-$ext.progress"
+	if ! cmp -s "$WORK_DIR/plain.align" "$WORK_DIR/$streams-$ext.align"; then
+	    echo "Test 3: $streams-stream .$ext network does not align like the uncompressed one"
+	    exitCode=1
+	fi
+    done
+
+    echo "Test 4: Testing truncated .$ext network"
+    size=`wc -c < "$WORK_DIR/single.gw.$ext"`
+    head -c $((size/2)) "$WORK_DIR/single.gw.$ext" > "$WORK_DIR/truncated.gw.$ext"
+    if ./sana -fg1 "$WORK_DIR/truncated.gw.$ext" $ARGS -o "$WORK_DIR/truncated-$ext" &> "$TEST_DIR/truncated-$ext.progress"; then
+	echo "Test 4: truncated .$ext network was loaded"
+	exitCode=1
+    elif ! grep -q "Corrupted" "$TEST_DIR/truncated-$ext.progress"; then
+	echo "Test 4: truncated .$ext network was not reported as corrupted"
+	exitCode=1
+    fi
+done
+
 echo 'Done testing compression'
 exit $exitCode
 
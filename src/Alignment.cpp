@@ -242,7 +242,7 @@ uint Alignment::numAlignedEdges(const Graph& G1, const Graph& G2) const {
     uint count = 0;
     for (const auto& edge: G1EdgeList) {
         uint node1 = edge[0], node2 = edge[1];
-        count += G2Matrix[A[node1]][A[node2]];
+        count += G2Matrix.get(A[node1], A[node2]);
     }
     return count;
 }
@@ -277,9 +277,9 @@ int Alignment::numSquaredAlignedEdges(const Graph& G1, const Graph& G2) const {
     uint n2 = G2.getNumNodes(); 
     for(uint i = 0; i < n2; i++){
         for(uint j = 0; j < i; j++){
-            int rungs  = G2Matrix[i][j];
+            int rungs  = G2Matrix.get(i, j);
             count += rungs * rungs;
-			assert(count > 0); // guard against overflow
+			assert(count >= 0); // guard against overflow
         }
     }
     return count;
@@ -305,15 +305,15 @@ int Alignment::numExposedEdges(const Graph& G1, const Graph& G2) const {
 
 	for (uint i = 0; i < n2; ++i) for (uint j = 0; j < i; ++j)
 	{
-		bool exposed = (G2Matrix[i][j] > 0);
+		bool exposed = (G2Matrix.get(i, j) > 0);
 		if(!exposed && whichPeg[i] < n1 && whichPeg[j] < n1)
 		{
-			if(G1Matrix[whichPeg[i]][whichPeg[j]])
+			if(G1Matrix.get(whichPeg[i], whichPeg[j]))
 			{
-				//assert(G1Matrix[whichPeg[j]][whichPeg[i]]);
+				//assert(G1Matrix.get(whichPeg[j], whichPeg[i]));
 				exposed = true;
 			} else
-				; // assert(!G1Matrix[whichPeg[j]][whichPeg[i]]);
+				; // assert(!G1Matrix.get(whichPeg[j], whichPeg[i]));
 		}
 		if(exposed) ret++;
 	}
@@ -340,18 +340,18 @@ int Alignment::numExposedEdges(const Graph& G1, const Graph& G2) const {
 				hole2 = true; // hole2 exposure already counted
 			}
 			
-			if (G2Matrix[i][j] && (hole1 && !hole2)) // hole1 counted, but hole2 not yet counted
+			if (G2Matrix.get(i, j) && (hole1 && !hole2)) // hole1 counted, but hole2 not yet counted
 			{
 				++ret;
 				holes.insert(j);
 			}
-			else if (G2Matrix[i][j] && (!hole1 && hole2)) // hole2 counted, but hole1 not yet counted
+			else if (G2Matrix.get(i, j) && (!hole1 && hole2)) // hole2 counted, but hole1 not yet counted
 			{
 				++ret;
 				holes.insert(i);
 				hole1 = true;
 			}
-			else if (G2Matrix[i][j] && (!hole1 && !hole2)) // neither hole counted
+			else if (G2Matrix.get(i, j) && (!hole1 && !hole2)) // neither hole counted
 			{
 				ret += 2;
 				holes.insert(i);
@@ -376,7 +376,7 @@ unsigned Alignment::multiS3Numerator(const Graph& G1, const Graph& G2) const {
     for (const auto& edge: G1EdgeList)
     {
         node1 = edge[0], node2 = edge[1];
-        ret += G2Matrix[A[node1]][A[node2]] + 1; // +1 because G1 was pruned out of G2
+        ret += G2Matrix.get(A[node1], A[node2]) + 1; // +1 because G1 was pruned out of G2
     }
     return ret;
 }
@@ -395,7 +395,7 @@ Graph Alignment::commonSubgraph(const Graph& G1, const Graph& G2) const {
     vector<vector<uint> > edgeList(0);
     for (const auto& edge: G1EdgeList) {
         uint node1 = edge[0], node2 = edge[1];
-        if (G2Matrix[A[node1]][A[node2]]) {
+        if (G2Matrix.get(A[node1], A[node2])) {
             edgeList.push_back(edge);
         }
     }
@@ -8,6 +8,11 @@
 #include <errno.h>
 #include <unistd.h>
 #include <regex>
+#include <mutex>
+#include "utils/SparseMatrix.hpp"
+#include "utils/parallelFor.hpp"
+#include "utils/Xoshiro256.hpp"
+#include "utils/FileContents.hpp"
 
 using namespace std;
 
@@ -15,6 +20,13 @@ using namespace std;
 const int Graph::NODE_TYPE_GENE  = 1;
 const int Graph::NODE_TYPE_MIRNA = 2;
 
+// a dense bit matrix of this many nodes already takes more than 1GB
+const uint Graph::SPARSE_MATRIX_MIN_NODES = 100000;
+
+bool Graph::useSparseMatrix(uint numNodes) {
+    return sparseMatrix or numNodes >= SPARSE_MATRIX_MIN_NODES;
+}
+
 
 Graph& Graph::loadGraph(string name, Graph& g) {
     //g.maxsize = max;
@@ -38,6 +50,9 @@ Graph& Graph::loadGraphFromPath(string path, string name, Graph& g, bool nodesHa
         g.parseFloatWeight = true;
         Graph::loadFromEdgeListFile(path, name, g, nodesHaveTypes);
     }
+    else if(format == "sgb"){
+        Graph::loadFromBinaryGraphFile(path, name, g, nodesHaveTypes);
+    }
     else if(format == "lgf"){
         Graph::loadFromLgfFile(path, name, g, nodesHaveTypes);
     }
@@ -68,6 +83,10 @@ void Graph::setMaxGraphletSize(double number){
     //Graph::computeGraphletDegreeVectors();
 }
 
+double Graph::getMaxGraphletSize() const {
+    return maxGraphletSize;
+}
+
 void Graph::serializeGraph(Graph& G, string outputName, bool typedNodes, bool locked)
 {
     bool multi_pairwise = false;
@@ -176,6 +195,235 @@ void Graph::loadGraphFromBinary(Graph& g, string graphName, string lockFile, boo
 
 
 
+namespace {
+
+/*
+Compact binary graph format (.sgb), written by the "convert" mode. A
+BinaryGraphHeader is followed by these sections, each padded to 8 bytes:
+  edges        numEdges pairs of uint32
+  values       numEdges uint32, if HAS_VALUES (MULTI_PAIRWISE edge values)
+  weights      numEdges float, if HAS_WEIGHTS (.elw files)
+  offsets      numNodes+1 uint64, start of each node in neighbors
+  neighbors    offsets[numNodes] uint32, the adjacency lists, in order
+  types        numNodes int32, if HAS_TYPES
+  nameOffsets  numNodes+1 uint64, start of each node name in names
+  names        nameOffsets[numNodes] chars
+  source       sourceLength chars, the path of the converted file
+Its size is linear in the graph, unlike the cereal dump of the n x n matrix.
+*/
+const char BINARY_GRAPH_MAGIC[8] = {'S','A','N','A','G','R','P','H'};
+const uint32_t BINARY_GRAPH_VERSION = 1;
+enum : uint32_t { HAS_VALUES = 1, HAS_WEIGHTS = 2, HAS_TYPES = 4 };
+
+struct BinaryGraphHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t numNodes;
+    uint64_t numEdges;
+    uint64_t sourceLength;
+    uint64_t sourceHash;  //hashBytes of the (decompressed) contents of the source
+    uint64_t payloadHash; //hashBytes of everything after the header
+    uint64_t reserved;
+};
+
+template<class T>
+void appendSection(string& payload, const T* data, size_t count) {
+    payload.append((const char*) data, count*sizeof(T));
+    payload.resize((payload.size()+7) & ~(size_t) 7, '\0');
+}
+
+//walks the sections of a mapped .sgb file, checking that they fit in it
+class SectionReader {
+public:
+    SectionReader(const char* begin, const char* end, const string& fileName):
+        p(begin), end(end), fileName(fileName) {}
+
+    template<class T>
+    const T* next(size_t count) {
+        size_t bytes = (count*sizeof(T)+7) & ~(size_t) 7;
+        if (count > (size_t)(end-p)/sizeof(T) or bytes > (size_t)(end-p)) {
+            throw runtime_error("Truncated binary graph file: "+fileName);
+        }
+        const T* res = (const T*) p;
+        p += bytes;
+        return res;
+    }
+
+private:
+    const char* p;
+    const char* end;
+    const string& fileName;
+};
+
+uint64_t fileContentsHash(const string& fileName) {
+    FileContents contents(fileName);
+    return hashBytes(contents.begin(), contents.end()-contents.begin());
+}
+
+}
+
+void Graph::saveBinaryGraph(const string& fileName, const string& sourceFile) const {
+    uint n = getNumNodes();
+    uint m = getNumEdges();
+    BinaryGraphHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic));
+    header.version = BINARY_GRAPH_VERSION;
+    header.numNodes = n;
+    header.numEdges = m;
+    header.sourceLength = sourceFile.size();
+    header.sourceHash = fileContentsHash(sourceFile);
+
+    string payload;
+    vector<uint32_t> column(2*(size_t)m);
+    for (uint i = 0; i < m; i++) {
+        column[2*i] = edgeList[i][0];
+        column[2*i+1] = edgeList[i][1];
+    }
+    appendSection(payload, column.data(), column.size());
+    if (m > 0 and edgeList[0].size() > 2) {
+        header.flags |= HAS_VALUES;
+        for (uint i = 0; i < m; i++) column[i] = edgeList[i][2];
+        appendSection(payload, column.data(), m);
+    }
+    if (parseFloatWeight) {
+        header.flags |= HAS_WEIGHTS;
+        vector<float> weights(m);
+        for (uint i = 0; i < m; i++) weights[i] = floatWeights.get(edgeList[i][0], edgeList[i][1]);
+        appendSection(payload, weights.data(), m);
+    }
+    vector<uint64_t> offsets(n+1, 0);
+    for (uint i = 0; i < n; i++) offsets[i+1] = offsets[i] + adjLists[i].size();
+    appendSection(payload, offsets.data(), n+1);
+    vector<uint32_t> neighbors;
+    neighbors.reserve(offsets[n]);
+    for (uint i = 0; i < n; i++) neighbors.insert(neighbors.end(), adjLists[i].begin(), adjLists[i].end());
+    appendSection(payload, neighbors.data(), neighbors.size());
+    if (nodeTypes.size() == n and n > 0) {
+        header.flags |= HAS_TYPES;
+        vector<int32_t> types(nodeTypes.begin(), nodeTypes.end());
+        appendSection(payload, types.data(), n);
+    }
+    vector<string> names = getNodeNames();
+    string allNames;
+    for (uint i = 0; i < n; i++) {
+        offsets[i] = allNames.size();
+        allNames += names[i];
+    }
+    offsets[n] = allNames.size();
+    appendSection(payload, offsets.data(), n+1);
+    appendSection(payload, allNames.data(), allNames.size());
+    appendSection(payload, sourceFile.data(), sourceFile.size());
+    header.payloadHash = hashBytes(payload.data(), payload.size());
+
+    //written under a temporary name, so a reader never sees half a file
+    string tmpName = fileName + ".tmp" + to_string(getpid());
+    ofstream ofs(tmpName.c_str(), ofstream::binary);
+    ofs.write((const char*) &header, sizeof(header));
+    ofs.write(payload.data(), payload.size());
+    ofs.close();
+    if (not ofs or rename(tmpName.c_str(), fileName.c_str()) != 0) {
+        remove(tmpName.c_str());
+        throw runtime_error("Cannot write "+fileName);
+    }
+}
+
+void Graph::loadFromBinaryGraphFile(string fin, string graphName, Graph& g, bool nodesHaveTypes) {
+    FileContents contents(fin);
+    size_t length = contents.end()-contents.begin();
+    if (length < sizeof(BinaryGraphHeader)) {
+        throw runtime_error("Not a binary graph file: "+fin);
+    }
+    const BinaryGraphHeader& header = *(const BinaryGraphHeader*) contents.begin();
+    if (memcmp(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic)) != 0) {
+        throw runtime_error("Not a binary graph file: "+fin);
+    }
+    if (header.version != BINARY_GRAPH_VERSION) {
+        throw runtime_error("Unsupported binary graph version "+to_string(header.version)+": "+fin);
+    }
+    const char* payload = contents.begin()+sizeof(header);
+    if (hashBytes(payload, contents.end()-payload) != header.payloadHash) {
+        throw runtime_error("Corrupted binary graph file (hash mismatch): "+fin);
+    }
+    uint n = header.numNodes;
+    uint m = header.numEdges;
+    SectionReader reader(payload, contents.end(), fin);
+    const uint32_t* edges = reader.next<uint32_t>(2*(size_t)m);
+#ifdef MULTI_PAIRWISE
+    const uint32_t* values = header.flags & HAS_VALUES ? reader.next<uint32_t>(m) : nullptr;
+#else
+    if (header.flags & HAS_VALUES) reader.next<uint32_t>(m); //edge values only count in multi-pairwise builds
+#endif
+    const float* weights = header.flags & HAS_WEIGHTS ? reader.next<float>(m) : nullptr;
+    const uint64_t* offsets = reader.next<uint64_t>(n+1);
+    const uint32_t* neighbors = reader.next<uint32_t>(offsets[n]);
+    const int32_t* types = header.flags & HAS_TYPES ? reader.next<int32_t>(n) : nullptr;
+    const uint64_t* nameOffsets = reader.next<uint64_t>(n+1);
+    const char* names = reader.next<char>(nameOffsets[n]);
+    string source(reader.next<char>(header.sourceLength), header.sourceLength);
+
+    //a converted file that has changed since would silently give another graph
+    if (fileExists(source) and fileContentsHash(source) != header.sourceHash) {
+        throw runtime_error(fin+" is out of date: "+source+" has changed since it was converted");
+    }
+
+    g.name = graphName;
+    g.nodeNameToIndexMap.clear();
+    g.nodeNameToIndexMap.reserve(n);
+    for (uint i = 0; i < n; i++) {
+        g.nodeNameToIndexMap[string(names+nameOffsets[i], nameOffsets[i+1]-nameOffsets[i])] = i;
+    }
+    g.adjLists = vector<vector<uint> > (n);
+    for (uint i = 0; i < n; i++) g.adjLists[i].assign(neighbors+offsets[i], neighbors+offsets[i+1]);
+
+#ifdef MULTI_PAIRWISE
+    g.edgeList = vector<vector<uint> > (m, vector<uint>(3));
+#else
+    g.edgeList = vector<vector<uint> > (m, vector<uint>(2));
+#endif
+    g.matrix = Matrix<MATRIX_UNIT>(n, n, useSparseMatrix(n));
+    g.parseFloatWeight = weights != nullptr;
+    if (weights) g.floatWeights = Matrix<float>(n, n, useSparseMatrix(n));
+    for (uint i = 0; i < m; i++) {
+        uint node1 = edges[2*i], node2 = edges[2*i+1];
+        g.edgeList[i][0] = node1;
+        g.edgeList[i][1] = node2;
+#ifdef MULTI_PAIRWISE
+        g.edgeList[i][2] = values ? values[i] : 1;
+        g.matrix[node1][node2] = g.matrix[node2][node1] = g.edgeList[i][2];
+#else
+        g.matrix[node1][node2] = g.matrix[node2][node1] = true;
+#endif
+        if (weights) g.floatWeights[node1][node2] = g.floatWeights[node2][node1] = weights[i];
+    }
+
+    g.geneCount = g.miRNACount = 0;
+    g.geneIndexList.clear();
+    g.miRNAIndexList.clear();
+    g.nodeTypes.clear();
+    if (types) {
+        g.nodeTypes.assign(types, types+n);
+        for (uint i = 0; i < n; i++) {
+            if (types[i] == Graph::NODE_TYPE_GENE) {
+                g.geneIndexList.push_back(i);
+                ++g.geneCount;
+            } else if (types[i] == Graph::NODE_TYPE_MIRNA) {
+                g.miRNAIndexList.push_back(i);
+                ++g.miRNACount;
+            }
+        }
+    }
+    g.lockedList = vector<bool> (n, false);
+    g.lockedTo = vector<string> (n, "");
+    if(nodesHaveTypes)
+        g.updateUnlockedGeneCount();
+    g.matrix.compress();
+    g.floatWeights.compress();
+    g.initConnectedComponents();
+}
+
+
 void Graph::loadFromLgfFile(string fin, string graphName, Graph& g, bool nodesHaveTypes) {
     ifstream infile;
     infile.open(fin,ifstream::in);
@@ -385,9 +633,9 @@ void Graph::loadFromLgfFile(string fin, string graphName, Graph& g, bool nodesHa
     nodes.shrink_to_fit();
     const size_t nodeSize = nodes.size();
     g.adjLists = vector<vector<uint> > (nodeSize, vector<uint>(0));
-    g.matrix = Matrix<MATRIX_UNIT>(nodeSize);
+    g.matrix = Matrix<MATRIX_UNIT>(nodeSize, nodeSize, useSparseMatrix(nodeSize));
     if (g.parseFloatWeight) {
-        g.floatWeights = Matrix<float>(nodeSize);
+        g.floatWeights = Matrix<float>(nodeSize, nodeSize, useSparseMatrix(nodeSize));
     }
     uint node1;
     uint node2;
@@ -429,6 +677,8 @@ void Graph::loadFromLgfFile(string fin, string graphName, Graph& g, bool nodesHa
     g.edgeList = edgeList;
     if(nodesHaveTypes)
         g.updateUnlockedGeneCount();
+    g.matrix.compress();
+    g.floatWeights.compress();
     g.initConnectedComponents();
 }
 
@@ -662,9 +912,9 @@ void Graph::loadFromGraphmlFile(string fin, string graphName, Graph& g, bool nod
     nodes.shrink_to_fit();
     const size_t nodeSize = nodes.size();
     g.adjLists = vector<vector<uint> > (nodeSize, vector<uint>(0));
-    g.matrix = Matrix<MATRIX_UNIT>(nodeSize);
+    g.matrix = Matrix<MATRIX_UNIT>(nodeSize, nodeSize, useSparseMatrix(nodeSize));
     if (g.parseFloatWeight) {
-        g.floatWeights = Matrix<float>(nodeSize);
+        g.floatWeights = Matrix<float>(nodeSize, nodeSize, useSparseMatrix(nodeSize));
     }
     uint node1;
     uint node2;
@@ -706,6 +956,8 @@ void Graph::loadFromGraphmlFile(string fin, string graphName, Graph& g, bool nod
     g.edgeList = edgeList;
     if(nodesHaveTypes)
         g.updateUnlockedGeneCount();
+    g.matrix.compress();
+    g.floatWeights.compress();
     g.initConnectedComponents();
 }
 
@@ -882,9 +1134,9 @@ void Graph::loadFromCsvFile(string fin, string graphName, Graph& g, bool nodesHa
     nodes.shrink_to_fit();
     const size_t nodeSize = nodes.size();
     g.adjLists = vector<vector<uint> > (nodeSize, vector<uint>(0));
-    g.matrix = Matrix<MATRIX_UNIT>(nodeSize);
+    g.matrix = Matrix<MATRIX_UNIT>(nodeSize, nodeSize, useSparseMatrix(nodeSize));
     if (g.parseFloatWeight) {
-        g.floatWeights = Matrix<float>(nodeSize);
+        g.floatWeights = Matrix<float>(nodeSize, nodeSize, useSparseMatrix(nodeSize));
     }
     uint node1;
     uint node2;
@@ -926,6 +1178,8 @@ void Graph::loadFromCsvFile(string fin, string graphName, Graph& g, bool nodesHa
     g.edgeList = edgeList;
     if(nodesHaveTypes)
         g.updateUnlockedGeneCount();
+    g.matrix.compress();
+    g.floatWeights.compress();
     g.initConnectedComponents();
 }
 
@@ -1104,9 +1358,9 @@ void Graph::loadFromGmlFile(string fin, string graphName, Graph& g, bool nodesHa
     nodes.shrink_to_fit();
     const size_t nodeSize = nodes.size();
     g.adjLists = vector<vector<uint> > (nodeSize, vector<uint>(0));
-    g.matrix = Matrix<MATRIX_UNIT>(nodeSize);
+    g.matrix = Matrix<MATRIX_UNIT>(nodeSize, nodeSize, useSparseMatrix(nodeSize));
     if (g.parseFloatWeight) {
-        g.floatWeights = Matrix<float>(nodeSize);
+        g.floatWeights = Matrix<float>(nodeSize, nodeSize, useSparseMatrix(nodeSize));
     }
     uint node1;
     uint node2;
@@ -1148,167 +1402,232 @@ void Graph::loadFromGmlFile(string fin, string graphName, Graph& g, bool nodesHa
     g.edgeList = edgeList;
     if(nodesHaveTypes)
         g.updateUnlockedGeneCount();
+    g.matrix.compress();
+    g.floatWeights.compress();
     g.initConnectedComponents();
 }
 
 
 
 
-void Graph::loadFromEdgeListFile(string fin, string graphName, Graph& g, bool nodesHaveTypes) {
-    unordered_set<string> record;
-    size_t lineCount = 0;
-    stdiobuf sbuf = readFileAsStreamBuffer(fin);
-    istream infile(&sbuf);
-    for (string line; getline(infile, line); ) {
-        string node1, node2;
-        istringstream iss(line);
-        iss >> node1 >> node2;
-        record.insert(node1);
-        record.insert(node2);
-        ++lineCount;
-    }
-    const size_t nodeLen = record.size();
-    const size_t vecLen = lineCount;
-    cout << graphName << ": number of nodes = " << nodeLen << ", number of edges = " << vecLen << endl;
+namespace {
 
-    g.name = graphName;
-    g.geneCount = 0;
-    g.miRNACount = 0;
+//a line of an edge list, as spans of the file contents
+struct EdgeLine {
+    Token node1, node2, value;
+    uint64_t hash1, hash2;
+    uint line; //0-based line number in the file
+};
 
+//open-addressing table from node names (spans of the file contents) to indices,
+//given in order of first insertion
+class NameTable {
+public:
+    NameTable(): slots(1024, NONE) {}
+
+    //index of name, adding it if new; isNew tells which one happened
+    uint insert(const Token& name, uint64_t hash, bool& isNew) {
+        if (2*(names.size()+1) > slots.size()) grow();
+        size_t mask = slots.size()-1;
+        for (size_t s = hash & mask; ; s = (s+1) & mask) {
+            if (slots[s] == NONE) {
+                slots[s] = names.size();
+                names.push_back(name);
+                hashes.push_back(hash);
+                isNew = true;
+                return slots[s];
+            }
+            if (hashes[slots[s]] == hash and names[slots[s]] == name) {
+                isNew = false;
+                return slots[s];
+            }
+        }
+    }
+    const vector<Token>& getNames() const { return names; }
 
-#ifdef MULTI_PAIRWISE
-    g.edgeList = vector<vector<uint>>(vecLen, vector<uint>(3));
-#else
-    g.edgeList = vector<vector<uint>>(vecLen, vector<uint>(2));
-    if (g.parseFloatWeight) {
-        g.floatWeights = Matrix<float>(nodeLen);
+private:
+    enum : uint { NONE = 0xFFFFFFFF };
+    vector<uint> slots;
+    vector<Token> names;
+    vector<uint64_t> hashes;
+
+    void grow() {
+        slots.assign(2*slots.size(), NONE);
+        size_t mask = slots.size()-1;
+        for (uint i = 0; i < names.size(); i++) {
+            size_t s = hashes[i] & mask;
+            while (slots[s] != NONE) s = (s+1) & mask;
+            slots[s] = i;
+        }
     }
-#endif
-    stringstream errorMsg;
-    string edgeValue;
-    uint index1;
-    uint index2;
-    unordered_map<string, unordered_map<string, uint>* > adjMatrix;
-    g.nodeNameToIndexMap.reserve(nodeLen);
+};
 
-    checkFileExists(fin);
-    stdiobuf sbuf2 = readFileAsStreamBuffer(fin);
-    istream ifs(&sbuf2);
-    size_t nodesCount = 0;
-    string line;
-    for (uint i = 0; getline(ifs, line); ++i) {
-        /*-------------------------- Parse -------------------------*/
+//the number of nodes of a .gw file, whose first lines are p; p is left at the
+//first node. line is the line the number was read from
+int readGwNodeCount(const char*& p, const char* end, string& line) {
+    //ignore header
+    for (int i = 0; i < 4; ++i) line = nextLine(p, end).str();
+    if (not line.empty() and line.back() == '\r') line.pop_back();
+    if (line == "-2") {
+        line = nextLine(p, end).str();
+        int n = 0;
         istringstream iss(line);
-        vector<string> words;
-        words.reserve(3);
-        copy(istream_iterator<string>(iss), istream_iterator<string>(), back_inserter(words));
-        string node1s = words[0];
-        string node2s = words[1];
-
-        /*---------------------- Fill into nodeNameToIndexMap -------*/
-        if(g.nodeNameToIndexMap.find(node1s) == g.nodeNameToIndexMap.end()){
-            g.nodeNameToIndexMap[node1s] = nodesCount;
-            ++nodesCount;
-            if(nodesHaveTypes){
-                g.nodeTypes.push_back(Graph::NODE_TYPE_GENE);//"gene");
-                g.geneIndexList.push_back(g.nodeNameToIndexMap[node1s]);
-                ++g.geneCount;
-            }
-        }
+        iss >> n;
+        return n;
+    }
+    return stoi(line);
+}
 
-       if(g.nodeNameToIndexMap.find(node2s) == g.nodeNameToIndexMap.end()){
-            g.nodeNameToIndexMap[node2s] = nodesCount;
-            ++nodesCount;
-            if(nodesHaveTypes){
-                g.nodeTypes.push_back(Graph::NODE_TYPE_MIRNA);//"miRNA");
-                g.miRNAIndexList.push_back(g.nodeNameToIndexMap[node2s]);
-                ++g.miRNACount;
-            }
-        }
+}
 
+void Graph::loadFromEdgeListFile(string fin, string graphName, Graph& g, bool nodesHaveTypes) {
+    FileContents contents(fin);
+    uint numThreads = defaultNumThreads();
+
+    /*---------------- Tokenize the lines, in parallel chunks ----------------*/
+    vector<const char*> chunks = contents.lineChunks(4*numThreads);
+    uint numChunks = chunks.size()-1;
+    vector<vector<EdgeLine> > chunkEdges(numChunks);
+    vector<uint> chunkLines(numChunks, 0);
+    vector<bool> chunkFailed(numChunks, false);
+    parallelFor(numChunks, numThreads, 1, [&](uint kBegin, uint kEnd, uint) {
+        for (uint k = kBegin; k < kEnd; k++) {
+            for (const char* p = chunks[k]; p < chunks[k+1]; chunkLines[k]++) {
+                Token line = nextLine(p, chunks[k+1]);
+                const char* q = line.begin;
+                const char* lineEnd = line.begin + line.length;
+                EdgeLine edge;
+                edge.node1 = nextToken(q, lineEnd);
+                if (edge.node1.empty()) continue; //blank line
+                edge.node2 = nextToken(q, lineEnd);
+                edge.value = nextToken(q, lineEnd);
+                uint numWords = edge.node2.empty() ? 1 : edge.value.empty() ? 2 :
+                                nextToken(q, lineEnd).empty() ? 3 : 4;
 #ifdef MULTI_PAIRWISE
-        if (words.size() == 2) {
-            edgeValue = '1';
-        }
-        else if (words.size() == 3) {
-            edgeValue = words[2];
-        }
-        else {
-            throw runtime_error("File not in edge-list format: "+fin);
-        }
+                bool valid = numWords == 2 or numWords == 3;
 #else
-        if (g.parseFloatWeight) {
-            if (words.size() != 3)
-                throw runtime_error("File not in edge-list-weight format: "+fin);
-            // Get float weight
-            edgeValue = words[2];
+                bool valid = numWords == (g.parseFloatWeight ? 3u : 2u);
+#endif
+                if (not valid) {
+                    chunkFailed[k] = true;
+                    break;
+                }
+                edge.hash1 = hashBytes(edge.node1.begin, edge.node1.length);
+                edge.hash2 = hashBytes(edge.node2.begin, edge.node2.length);
+                edge.line = chunkLines[k];
+                chunkEdges[k].push_back(edge);
+            }
         }
-        else if (words.size() != 2) {
+    });
+    uint firstLine = 0;
+    for (uint k = 0; k < numChunks; k++) {
+        if (chunkFailed[k]) {
+#ifndef MULTI_PAIRWISE
+            if (g.parseFloatWeight) throw runtime_error("File not in edge-list-weight format: "+fin);
+#endif
             throw runtime_error("File not in edge-list format: "+fin);
         }
-#endif
-        /*------------------ Detects duplicate edges ------------------ */
-        unordered_map<string, uint> *adjTo1;
-        if(adjMatrix.count(node1s) == 0)
-            adjMatrix[node1s] = new unordered_map<string, uint>();
-        adjTo1 = adjMatrix.at(node1s);
-
-        unordered_map<string, uint> *adjTo2;
-        if(adjMatrix.count(node2s) == 0)
-            adjMatrix[node2s] = new unordered_map<string, uint>();
-        adjTo2 = adjMatrix.at(node2s);
+        for (EdgeLine& edge : chunkEdges[k]) edge.line += firstLine;
+        firstLine += chunkLines[k];
+    }
 
-        if( (adjTo1->count(node2s) != 0) || (adjTo2->count(node1s) != 0) ) {
-            uint dupEdgeLineNum = adjTo1->at(node2s);
-            errorMsg << "duplicate edges not allowed in file\n" <<
-                "\t'" << fin << ":" << dupEdgeLineNum+1 << "' " << node1s << " - " << node2s << '\n' <<
-                "\t'" << fin << ":" << i+1              << "' " << node1s << " - " << node2s << '\n';
-            throw runtime_error(errorMsg.str().c_str());
-        }else{
-            (*adjTo1)[node2s] = i;
-            (*adjTo2)[node1s] = i;
+    /*----------- Intern node names, in order of first appearance -----------*/
+    g.name = graphName;
+    g.geneCount = 0;
+    g.miRNACount = 0;
+    size_t numEdges = 0;
+    for (const vector<EdgeLine>& edges : chunkEdges) numEdges += edges.size();
+    NameTable nameTable;
+    vector<uint> endpoints;
+    endpoints.reserve(2*numEdges);
+    for (const vector<EdgeLine>& edges : chunkEdges) {
+        for (const EdgeLine& edge : edges) {
+            bool isNew;
+            uint index1 = nameTable.insert(edge.node1, edge.hash1, isNew);
+            if (isNew and nodesHaveTypes) {
+                g.nodeTypes.push_back(Graph::NODE_TYPE_GENE);
+                g.geneIndexList.push_back(index1);
+                ++g.geneCount;
+            }
+            uint index2 = nameTable.insert(edge.node2, edge.hash2, isNew);
+            if (isNew and nodesHaveTypes) {
+                g.nodeTypes.push_back(Graph::NODE_TYPE_MIRNA);
+                g.miRNAIndexList.push_back(index2);
+                ++g.miRNACount;
+            }
+            endpoints.push_back(index1);
+            endpoints.push_back(index2);
         }
+    }
+    const vector<Token>& names = nameTable.getNames();
+    const size_t nodeLen = names.size();
+    cout << graphName << ": number of nodes = " << nodeLen << ", number of edges = " << numEdges << endl;
+    g.nodeNameToIndexMap.clear();
+    g.nodeNameToIndexMap.reserve(nodeLen);
+    for (uint i = 0; i < nodeLen; i++) g.nodeNameToIndexMap[names[i].str()] = i;
 
-        /*------------------------ Fill edge list ------------------*/
-        index1 = g.nodeNameToIndexMap[node1s];
-        index2 = g.nodeNameToIndexMap[node2s];
-        g.edgeList[i][0] = index1;
-        g.edgeList[i][1] = index2;
-        
+    /*---------- Fill edge list, weights, matrix and adjLists in one pass ----------*/
 #ifdef MULTI_PAIRWISE
-        g.edgeList[i][2] = stoi(edgeValue);
-        assert(g.edgeList[i][2] < (1L << 8*sizeof(MATRIX_UNIT)) -1 ); // ensure type is large enough
-#endif
-      /*----------------------------- Fill float weight ----------------------- */
-      if (g.parseFloatWeight) {
-            g.floatWeights[index1][index2] = g.floatWeights[index2][index1] = stof(edgeValue);
-      }
+    g.edgeList = vector<vector<uint>>(numEdges, vector<uint>(3));
+#else
+    g.edgeList = vector<vector<uint>>(numEdges, vector<uint>(2));
+    if (g.parseFloatWeight) {
+        g.floatWeights = Matrix<float>(nodeLen, nodeLen, useSparseMatrix(nodeLen));
     }
-    g.edgeList.shrink_to_fit();
-    for(auto itr : adjMatrix) { delete itr.second; }
-
-    /*----------------------------- Fill adjLists and matrix ------------------------- */
-    g.adjLists = vector<vector<uint> > (nodeLen, vector<uint>(0));
-    g.matrix = Matrix<MATRIX_UNIT>(nodeLen);
-    uint node1;
-    uint node2;
-    for(unsigned i = 0; i < g.edgeList.size(); ++i){
-        node1 = g.edgeList[i][0];
-        node2 = g.edgeList[i][1];
-
-        // Note that when MULTI_PAIRWISE is on, the adjacency matrix contains full integers, not just bits.
-        #ifdef MULTI_PAIRWISE
+#endif
+    g.matrix = Matrix<MATRIX_UNIT>(nodeLen, nodeLen, useSparseMatrix(nodeLen));
+    vector<uint> degrees(nodeLen, 0);
+    for (size_t i = 0; i < numEdges; i++) {
+        degrees[endpoints[2*i]]++;
+        if (endpoints[2*i] != endpoints[2*i+1]) degrees[endpoints[2*i+1]]++;
+    }
+    g.adjLists = vector<vector<uint> > (nodeLen);
+    for (uint i = 0; i < nodeLen; i++) g.adjLists[i].reserve(degrees[i]);
+
+    size_t i = 0;
+    for (const vector<EdgeLine>& edges : chunkEdges) {
+        for (const EdgeLine& edge : edges) {
+            uint node1 = endpoints[2*i], node2 = endpoints[2*i+1];
+            /*------------------ Detects duplicate edges ------------------ */
+            if (g.matrix[node1][node2]) {
+                size_t dup = 0;
+                while (not ((endpoints[2*dup] == node1 and endpoints[2*dup+1] == node2) or
+                            (endpoints[2*dup] == node2 and endpoints[2*dup+1] == node1))) dup++;
+                uint dupEdgeLineNum = 0;
+                for (const vector<EdgeLine>& earlier : chunkEdges) {
+                    if (dup < earlier.size()) {
+                        dupEdgeLineNum = earlier[dup].line;
+                        break;
+                    }
+                    dup -= earlier.size();
+                }
+                stringstream errorMsg;
+                errorMsg << "duplicate edges not allowed in file\n" <<
+                    "\t'" << fin << ":" << dupEdgeLineNum+1 << "' " << edge.node1.str() << " - " << edge.node2.str() << '\n' <<
+                    "\t'" << fin << ":" << edge.line+1      << "' " << edge.node1.str() << " - " << edge.node2.str() << '\n';
+                throw runtime_error(errorMsg.str().c_str());
+            }
+            g.edgeList[i][0] = node1;
+            g.edgeList[i][1] = node2;
+#ifdef MULTI_PAIRWISE
+            // Note that when MULTI_PAIRWISE is on, the adjacency matrix contains full integers, not just bits.
+            g.edgeList[i][2] = edge.value.empty() ? 1 : stoi(edge.value.str());
+            assert(g.edgeList[i][2] < (1L << 8*sizeof(MATRIX_UNIT)) -1 ); // ensure type is large enough
             g.matrix[node1][node2] = g.matrix[node2][node1] = g.edgeList[i][2];
-        #else
+#else
             g.matrix[node1][node2] = g.matrix[node2][node1] = true;
-        #endif
-
-        // Self-loop
-        if(node1 == node2) {
-            g.adjLists[node1].push_back(node1);
-        }else{
-            g.adjLists[node1].push_back(node2);
-            g.adjLists[node2].push_back(node1);
+            if (g.parseFloatWeight) {
+                g.floatWeights[node1][node2] = g.floatWeights[node2][node1] = stof(edge.value.str());
+            }
+#endif
+            // Self-loop
+            if(node1 == node2) {
+                g.adjLists[node1].push_back(node1);
+            }else{
+                g.adjLists[node1].push_back(node2);
+                g.adjLists[node2].push_back(node1);
+            }
+            i++;
         }
     }
 
@@ -1317,6 +1636,8 @@ void Graph::loadFromEdgeListFile(string fin, string graphName, Graph& g, bool no
     g.lockedTo = vector<string> (nodeLen, "");
     if(nodesHaveTypes)
         g.updateUnlockedGeneCount();
+    g.matrix.compress();
+    g.floatWeights.compress();
     g.initConnectedComponents();
 }
 
@@ -1453,7 +1774,7 @@ Graph::Graph(const Graph& G) {
 
 Graph::Graph(uint n, const vector<vector<uint> > edges) {
     adjLists = vector<vector<uint> > (n, vector<uint> (0));
-    matrix = Matrix<MATRIX_UNIT> (n);
+    matrix = Matrix<MATRIX_UNIT>(n, n, useSparseMatrix(n));
     edgeList = edges;
 
     lockedList = vector<bool> (n, false);
@@ -1474,6 +1795,7 @@ Graph::Graph(uint n, const vector<vector<uint> > edges) {
 #endif
     }
     updateUnlockedGeneCount();
+    matrix.compress();
     initConnectedComponents();
 }
 
@@ -1552,51 +1874,75 @@ void Graph::loadGwFile(const string& fileName) {
     //this function could be improved to deal with blank lines and comments
     stringstream errorMsg;
 
-    stdiobuf sbuf = readFileAsStreamBuffer(fileName);
-    istream infile(&sbuf);
+    FileContents contents(fileName);
+    const char* p = contents.begin();
+    const char* end = contents.end();
     string line;
-    
-    //ignore header
-    for (int i = 0; i < 4; ++i)
-        getline(infile, line);
     //read number of nodes
-    int n;
-    if(line == "-2") {
-        getline(infile, line);
-        istringstream iss2(line);
-        (iss2 >> n);
-    } else {
-        n = stoi(line);
-    }
+    int n = readGwNodeCount(p, end, line);
     if (n <= 0) {
         errorMsg << "Failed to read node number: " << line << " read as " << n;
         throw runtime_error(errorMsg.str().c_str());
     }
     //read (and ditch) nodes
-    string node;
     for (int i = 0; i < n; ++i) {
-        getline(infile, line);
-        istringstream iss(line);
-        if (!(iss >> node)) {
-            errorMsg << "Failed to read node " << i << " of " << n << ": " << line << " (" << node << ")";
+        Token lineToken = nextLine(p, end);
+        const char* q = lineToken.begin;
+        if (nextToken(q, lineToken.begin + lineToken.length).empty()) {
+            errorMsg << "Failed to read node " << i << " of " << n << ": " << lineToken.str() << " ()";
             throw runtime_error(errorMsg.str().c_str());
         }
     }
     //read number of edges
     int m;
-    getline(infile, line);
+    line = nextLine(p, end).str();
     istringstream iss2(line);
     if (!(iss2 >> m)) {
         errorMsg << "Failed to read edge number: " << line;
         throw runtime_error(errorMsg.str().c_str());
     }
 
-    adjLists = vector<vector<uint> > (n, vector<uint>(0));
-    matrix = Matrix<MATRIX_UNIT>(n);
+    //parse the edge lines in parallel chunks; only the first m count
+    struct GwEdge {
+        uint node1, node2;
+        MATRIX_UNIT value;
+        bool valid;
+    };
+    uint numThreads = defaultNumThreads();
+    vector<const char*> chunks = contents.lineChunks(4*numThreads, p);
+    uint numChunks = chunks.size()-1;
+    vector<vector<GwEdge> > chunkEdges(numChunks);
+    vector<vector<Token> > chunkLines(numChunks);
+    parallelFor(numChunks, numThreads, 1, [&](uint kBegin, uint kEnd, uint) {
+        for (uint k = kBegin; k < kEnd; k++) {
+            for (const char* q = chunks[k]; q < chunks[k+1]; ) {
+                Token lineToken = nextLine(q, chunks[k+1]);
+                const char* r = lineToken.begin;
+                const char* lineEnd = lineToken.begin + lineToken.length;
+                GwEdge edge;
+                edge.valid = parseUint(nextToken(r, lineEnd), edge.node1) and
+                             parseUint(nextToken(r, lineEnd), edge.node2);
 #ifdef MULTI_PAIRWISE
-    char dump;
-    uint edgeValue;
+                //3 non-blank characters (the "{ }|" wrapper) precede the edge value
+                for (uint dumped = 0; edge.valid and dumped < 3; dumped++) {
+                    while (r < lineEnd and isspace(*r)) r++;
+                    edge.valid = r++ < lineEnd;
+                }
+                edge.value = 0;
+                while (r < lineEnd and isspace(*r)) r++;
+                if (r == lineEnd or not isdigit(*r)) edge.value = 1;
+                else for (; r < lineEnd and isdigit(*r); r++) edge.value = 10*edge.value + (*r - '0');
+#else
+                edge.value = true;
 #endif
+                chunkEdges[k].push_back(edge);
+                chunkLines[k].push_back(lineToken);
+            }
+        }
+    });
+
+    adjLists = vector<vector<uint> > (n, vector<uint>(0));
+    matrix = Matrix<MATRIX_UNIT>(n, n, useSparseMatrix(n));
     edgeList = vector<vector<uint> > (m, vector<uint>(2));
     lockedList = vector<bool> (n, false);
     lockedTo = vector<string> (n, "");
@@ -1604,50 +1950,45 @@ void Graph::loadGwFile(const string& fileName) {
 
     geneCount = miRNACount = 0;
 
-    //read edges
-    uint node1;
-    uint node2;
-
-    for (int i = 0; i < m; ++i) {
-        getline(infile, line);
-        istringstream iss(line);
-#ifdef MULTI_PAIRWISE
-        if (!(iss >> node1 >> node2 >> dump >> dump >> dump)) {
-#else
-        if (!(iss >> node1 >> node2)) {
-#endif
-            errorMsg << "Failed to read edge: " << line;
-            throw runtime_error(errorMsg.str().c_str());
-        }
-
-#ifdef MULTI_PAIRWISE
-        if (!(iss >> edgeValue)) {
-            errorMsg << "No edge value: " << line;
-            edgeValue = 1;
-        }
-#endif
-        node1--; node2--; //-1 because of remapping
+    //check and store edges, in file order
+    int i = 0;
+    for (uint k = 0; k < numChunks and i < m; k++) {
+        for (uint j = 0; j < chunkEdges[k].size() and i < m; j++, i++) {
+            const GwEdge& edge = chunkEdges[k][j];
+            if (!edge.valid) {
+                errorMsg << "Failed to read edge: " << chunkLines[k][j].str();
+                throw runtime_error(errorMsg.str().c_str());
+            }
+            uint node1 = edge.node1-1, node2 = edge.node2-1; //-1 because of remapping
 
-        if(matrix[node1][node2] || matrix[node2][node1]){
-            errorMsg << "duplicate edges not allowed (in either direction), node numbers are " << node1+1 << " " << node2+1 << '\n';
-	    //errorMsg << "In graph [" << graphName << "]: duplicate edges not allowed (in either direction), node names are " << nodeName2IndexMap[node1+1] << " " << nodeName2IndexMap[node2+1] << '\n';
-            throw runtime_error(errorMsg.str().c_str());
-        }
-        if(node1 == node2) {
-            errorMsg << "self-loops not allowed, node number " << node1+1 << '\n';
-            throw runtime_error(errorMsg.str().c_str());
+            if(matrix[node1][node2] || matrix[node2][node1]){
+                errorMsg << "duplicate edges not allowed (in either direction), node numbers are " << node1+1 << " " << node2+1 << '\n';
+                throw runtime_error(errorMsg.str().c_str());
+            }
+            if(node1 == node2) {
+                errorMsg << "self-loops not allowed, node number " << node1+1 << '\n';
+                throw runtime_error(errorMsg.str().c_str());
+            }
+            edgeList[i][0] = node1;
+            edgeList[i][1] = node2;
+            matrix[node1][node2] = matrix[node2][node1] = edge.value;
         }
-        edgeList[i][0] = node1;
-        edgeList[i][1] = node2;
-
-#ifdef MULTI_PAIRWISE
-        matrix[node1][node2] = matrix[node2][node1] = edgeValue;
-#else
-        matrix[node1][node2] = matrix[node2][node1] = true;
-#endif
-        adjLists[node1].push_back(node2);
-        adjLists[node2].push_back(node1);
     }
+    if (i < m) {
+        errorMsg << "Failed to read edge: ";
+        throw runtime_error(errorMsg.str().c_str());
+    }
+    vector<uint> degrees(n, 0);
+    for (const vector<uint>& edge : edgeList) {
+        degrees[edge[0]]++;
+        degrees[edge[1]]++;
+    }
+    for (int u = 0; u < n; u++) adjLists[u].reserve(degrees[u]);
+    for (const vector<uint>& edge : edgeList) {
+        adjLists[edge[0]].push_back(edge[1]);
+        adjLists[edge[1]].push_back(edge[0]);
+    }
+    matrix.compress();
     initConnectedComponents();
 }
 
@@ -1690,7 +2031,7 @@ void Graph::multGwFile(const string& fileName, uint path) {
     SparseMatrix<uint> sparse_graph2(n);
 
     adjLists = vector<vector<uint> > (n, vector<uint>(0));
-    matrix = Matrix<MATRIX_UNIT>(n);
+    matrix = Matrix<MATRIX_UNIT>(n, n, useSparseMatrix(n));
     //edgeList = vector<vector<uint> > (m, vector<uint>(2));
     lockedList = vector<bool> (n, false);
     lockedTo = vector<string> (n, "");
@@ -1740,6 +2081,7 @@ void Graph::multGwFile(const string& fileName, uint path) {
         }
     }
 
+    matrix.compress();
     initConnectedComponents();
 }
 
@@ -1802,7 +2144,7 @@ Graph Graph::nodeInducedSubgraph(const vector<uint>& nodes) const {
     unordered_set<uint> nodeSet(nodes.begin(), nodes.end());
     Graph G;
     G.adjLists = vector<vector<uint> > (n, vector<uint> (0));
-    G.matrix = Matrix<MATRIX_UNIT>(n);
+    G.matrix = Matrix<MATRIX_UNIT>(n, n, useSparseMatrix(n));
     //only add edges between induced nodes
     for (const auto& edge: edgeList) {
         uint node1 = edge[0], node2 = edge[1];
@@ -1822,6 +2164,7 @@ Graph Graph::nodeInducedSubgraph(const vector<uint>& nodes) const {
 #endif
         }
     }
+    G.matrix.compress();
     G.initConnectedComponents();
     return G;
 }
@@ -1839,50 +2182,99 @@ void Graph::printStats(int numConnectedComponentsToPrint, ostream& stream) const
     stream << endl;
 }
 
-void Graph::getDistanceMatrix(vector<vector<short> >& dist) const {
-#if USE_CACHED_FILES
-// By default, USE_CACHED_FILES is 0 and SANA does not cache files. Change USE_CACHED_FILES at your own risk.
-    string distMatrixFile = "networks/"+name+"/autogenerated/"+name+"_distMatrix.txt";
-    if (fileExists(distMatrixFile)) {
-        readMatrixFromFile(dist, getNumNodes(), getNumNodes(), distMatrixFile);
-        return;
-    }
-#endif
+//Bit-parallel BFS (Then et al., "The More the Merrier", VLDB 2015): the
+//sources are taken 64 at a time, and bit k of a node's word says whether the
+//k-th source of the batch has reached it, so a single sweep over the
+//adjacency lists advances all 64 searches by one level. Batches are spread
+//over the cores. visit(thread, k, node, dist) is called once for every
+//source sources[k] and node it reaches, including node == sources[k] with
+//dist 0; calls with the same k come from the same thread, in order of dist.
+template<class Visit>
+void Graph::multiSourceBFS(const vector<uint>& sources, Visit visit) const {
+    const uint BATCH = 64;
+    uint n = getNumNodes();
+    uint numBatches = (sources.size() + BATCH - 1) / BATCH;
+    uint numThreads = min(defaultNumThreads(), max(1u, numBatches));
+    parallelFor(numBatches, numThreads, 1, [&](uint batchBegin, uint batchEnd, uint thread) {
+        vector<uint64_t> seen(n), frontier(n), next(n);
+        for (uint b = batchBegin; b < batchEnd; b++) {
+            uint first = b*BATCH, count = min<size_t>(BATCH, sources.size() - first);
+            fill(seen.begin(), seen.end(), 0);
+            fill(frontier.begin(), frontier.end(), 0);
+            for (uint k = 0; k < count; k++) {
+                uint64_t bit = uint64_t(1) << k;
+                seen[sources[first+k]] |= bit;
+                frontier[sources[first+k]] |= bit;
+                visit(thread, first+k, sources[first+k], 0);
+            }
+            for (uint dist = 1; ; dist++) {
+                for (uint v = 0; v < n; v++) {
+                    if (frontier[v] == 0) continue;
+                    for (uint u : adjLists[v]) next[u] |= frontier[v];
+                }
+                bool reachedAny = false;
+                for (uint u = 0; u < n; u++) {
+                    uint64_t reached = next[u] & ~seen[u];
+                    next[u] = 0;
+                    frontier[u] = reached;
+                    if (reached == 0) continue;
+                    reachedAny = true;
+                    seen[u] |= reached;
+                    for (; reached; reached &= reached - 1) {
+                        visit(thread, first + __builtin_ctzll(reached), u, dist);
+                    }
+                }
+                if (not reachedAny) break;
+            }
+        }
+    });
+}
+
+const uint8_t Graph::UNREACHABLE;
+
+//row-major n x n matrix; UNREACHABLE between different connected components
+void Graph::getDistanceMatrix(vector<uint8_t>& dist) const {
     Timer T;
     T.start();
     cout << "Computing "+name+" distance matrix...";
-    computeDistanceMatrix(dist);
+    uint n = getNumNodes();
+    dist = vector<uint8_t>((size_t)n*n, UNREACHABLE);
+    vector<uint> sources(n);
+    for (uint i = 0; i < n; i++) sources[i] = i;
+    atomic<bool> tooFar(false);
+    multiSourceBFS(sources, [&](uint, uint source, uint node, uint d) {
+        if (d >= UNREACHABLE) tooFar = true;
+        else dist[(size_t)source*n + node] = d;
+    });
+    if (tooFar) {
+        throw runtime_error("Graph::getDistanceMatrix: "+name+" has shortest paths of "+
+            to_string(UNREACHABLE)+" or more edges, which do not fit in the distance matrix");
+    }
     cout << "Graph::getDistanceMatrix done (" << T.elapsedString() << ")" << endl;
-#if USE_CACHED_FILES
-// By default, USE_CACHED_FILES is 0 and SANA does not cache files. Change USE_CACHED_FILES at your own risk.
-    writeMatrixToFile(dist, distMatrixFile);
-#endif
 }
 
-//a -1 indicates that the distance is infinite
-//floyd-warshall algorithm
-void Graph::computeDistanceMatrix(vector<vector<short> >& dist) const {
+vector<ulong> Graph::distanceHistogram(uint numSources) const {
     uint n = getNumNodes();
-    dist = vector<vector<short> > (n, vector<short> (n, -1));
-    assert(false); // replace this with iterated Dijkstra, which is MUCH faster on sparse graphs
-    for (uint v = 0; v < n; v++) {
-        dist[v][v] = 0;
-        for (uint i = 0; i < adjLists[v].size(); i++) {
-            uint u = adjLists[v][i];
-            dist[u][v] = 1;
-        }
-    }
-    for (uint k = 0; k < n; k++) {
-        for (uint i = 0; i < n; i++) {
-            for (uint j = 0; j < n; j++) {
-                if (dist[i][k] != -1 and dist[k][j] != -1) {
-                    if (dist[i][j] == -1 or dist[i][j] > dist[i][k] + dist[k][j]) {
-                        dist[i][j] = dist[i][k] + dist[k][j];
-                    }
-                }
-            }
-        }
+    vector<uint> sources(n);
+    for (uint i = 0; i < n; i++) sources[i] = i;
+    if (numSources > 0 and numSources < n) {
+        //a fixed sample, so the estimates are reproducible
+        Xoshiro256 gen(n);
+        for (uint i = 0; i < numSources; i++) swap(sources[i], sources[i + gen.below(n - i)]);
+        sources.resize(numSources);
+    }
+    vector<vector<ulong> > counts(defaultNumThreads());
+    multiSourceBFS(sources, [&counts](uint thread, uint, uint, uint d) {
+        vector<ulong>& hist = counts[thread];
+        if (d >= hist.size()) hist.resize(d+1, 0);
+        hist[d]++;
+    });
+    vector<ulong> res;
+    for (const vector<ulong>& hist : counts) {
+        if (hist.size() > res.size()) res.resize(hist.size(), 0);
+        for (uint d = 0; d < hist.size(); d++) res[d] += hist[d];
     }
+    return res;
 }
 
 //The first line contains two integers n and e - the number of nodes and edges.
@@ -2086,6 +2478,7 @@ void Graph::addRandomEdges(double addedEdgesProportion) {
     for (uint i = 0; i <= n; i++) {
         addRandomEdge();
     }
+    matrix.compress();
     initConnectedComponents();
 }
 
@@ -2094,6 +2487,7 @@ void Graph::removeRandomEdges(double removedEdgesProportion) {
     for (uint i = 0; i <= n; i++) {
         removeRandomEdge();
     }
+    matrix.compress();
     initConnectedComponents();
 }
 
@@ -2103,6 +2497,7 @@ void Graph::rewireRandomEdges(double rewiredEdgesProportion) {
         addRandomEdge();
         removeRandomEdge();
     }
+    matrix.compress();
     initConnectedComponents();
 }
 
@@ -2111,6 +2506,11 @@ string Graph::autogenFilesFolder() {
 }
 
 vector<vector<uint> > Graph::loadGraphletDegreeVectors() {
+    if (not cacheGraphletDegreeVectors) return computeGraphletDegreeVectors();
+    //the graphlet measures are built concurrently: the first one computes and
+    //writes the file, the others wait and read it
+    static mutex gdvsFileMutex;
+    lock_guard<mutex> lock(gdvsFileMutex);
     std::ostringstream oss;
     oss << Graph::maxGraphletSize;
     string gdvsFileName = autogenFilesFolder() + name + "_gdv"+oss.str()+".bin";
@@ -2138,21 +2538,7 @@ vector<vector<uint> > Graph::loadGraphletDegreeVectors() {
 
 vector<vector<uint> > Graph::computeGraphletDegreeVectors() {
     std::cout<<"Computing Graphlet Degree Vectors... "<<endl;
-    uint n = getNumNodes();
-    uint m = getNumEdges();
-
-
-    string fileName = "tmp/compute_dgvs.txt";
-    ofstream fout(fileName.c_str());
-    fout << n << " " << m << endl;
-    for (uint i = 0; i < m; i++) {
-        fout << edgeList[i][0] << " " << edgeList[i][1] << endl;
-    }
-    fout.close();
-    double GraphletSizemax = Graph::maxGraphletSize;
-
-    vector<vector<uint> > gdvs = computeGraphlets(GraphletSizemax, fileName);
-    return gdvs;
+    return computeGraphlets(Graph::maxGraphletSize, getNumNodes(), edgeList);
 }
 
 unordered_map<string,uint> Graph::getNodeNameToIndexMap() const {
@@ -2164,35 +2550,25 @@ unordered_map<string,uint> Graph::getNodeNameToIndexMap() const {
     if(this -> path != "")
         networkFile = this -> path;
 
-    stdiobuf sbuf = readFileAsStreamBuffer(networkFile);
-    istream infile(&sbuf);
+    FileContents contents(networkFile);
+    const char* p = contents.begin();
     string line;
-    //ignore header
-    for (int i = 0; i < 4; i++) getline(infile, line);
-    //read number of nodes
-    int n;
-    if(line == "-2") {
-    getline(infile, line);
-    istringstream iss2(line);
-    (iss2 >> n);
-    } else {
-    n = stoi(line);
-    }
+    int n = readGwNodeCount(p, contents.end(), line);
     if (n <= 0) {
         throw runtime_error("Failed to read node number: " + line);
     }
 
     //read nodes
     unordered_map<string, uint> res;
-    string node;
+    res.reserve(n);
     for (uint i = 0; i < (uint) n; i++) {
-        getline(infile, line);
-        istringstream iss(line);
-        if (!(iss >> node)) {
-            throw runtime_error("Failed to read node "+intToString(i)+" of "+intToString(n)+": "+line+" ("+node+")");
+        Token lineToken = nextLine(p, contents.end());
+        const char* q = lineToken.begin;
+        Token node = nextToken(q, lineToken.begin + lineToken.length);
+        if (node.empty()) {
+            throw runtime_error("Failed to read node "+intToString(i)+" of "+intToString(n)+": "+lineToken.str()+" ()");
         }
-        node = node.substr(2,node.size()-4); //strip |{ and }|
-        res[node] = i;
+        res[node.str().substr(2,node.length-4)] = i; //strip |{ and }|
     }
     return res;
 }
@@ -2207,23 +2583,51 @@ unordered_map<uint,string> Graph::getIndexToNodeNameMap() const {
 }
 
 bool Graph::hasSelfLoop(uint source) const {
-#ifdef SPARSE
-    vector<uint> neighbors = adjLists[source];
-    return std::find(neighbors.begin(), neighbors.end(), source) != neighbors.end();
-#else
-    return (matrix.get(source, source)); // || (std::find(neighbors.begin(), neighbors.end(), source) != neighbors.end());
-#endif
+    return matrix.get(source, source);
 }
 
 vector<string> Graph::getNodeNames() const {
     vector<string> result(getNumNodes());
-    unordered_map<uint,string> map = getIndexToNodeNameMap();
-    for (uint i = 0; i < getNumNodes(); i++) {
-        result[i] = map[i];
+    for (const auto &nameIndexPair : getNodeNameToIndexMap()) {
+        result[nameIndexPair.second] = nameIndexPair.first;
     }
     return result;
 }
 
+uint64_t Graph::contentHash() const {
+    uint n = getNumNodes();
+    uint64_t hash = hashBytes(&n, sizeof(n));
+    vector<string> names = getNodeNames();
+    for (uint i = 0; i < n; i++) {
+        hash = hashBytes(names[i].c_str(), names[i].size()+1, hash);
+    }
+    hash = hashBytes(&nodesHaveTypesEnabled, sizeof(nodesHaveTypesEnabled), hash);
+    if (nodesHaveTypesEnabled) {
+        hash = hashBytes(nodeTypes.data(), nodeTypes.size()*sizeof(int), hash);
+    }
+    vector<uint> neighbors;
+    for (uint i = 0; i < n; i++) {
+        neighbors = adjLists[i];
+        sort(neighbors.begin(), neighbors.end());
+        uint degree = neighbors.size();
+        hash = hashBytes(&degree, sizeof(degree), hash);
+        hash = hashBytes(neighbors.data(), degree*sizeof(uint), hash);
+#if defined(MULTI_PAIRWISE) && !defined(NO_ADJ_MATRIX)
+        for (uint j : neighbors) {
+            MATRIX_UNIT weight = matrix.get(i, j);
+            hash = hashBytes(&weight, sizeof(weight), hash);
+        }
+#endif
+        if (parseFloatWeight) {
+            for (uint j : neighbors) {
+                float weight = floatWeights.get(i, j);
+                hash = hashBytes(&weight, sizeof(weight), hash);
+            }
+        }
+    }
+    return hash;
+}
+
 vector<uint> Graph::degreeDistribution() const {
     uint n = getNumNodes();
     uint maxDegree = adjLists[0].size();
@@ -2237,19 +2641,16 @@ vector<uint> Graph::degreeDistribution() const {
     return res;
 }
 
+//exact up to MAX_EXACT_NODES nodes; beyond that, estimated from the
+//distances of SAMPLED_SOURCES random nodes to all the others
 double Graph::getAverageDistance() const {
-    vector<vector<short> > dists;
-    getDistanceMatrix(dists);
-    uint n = getNumNodes();
+    const uint MAX_EXACT_NODES = 20000, SAMPLED_SOURCES = 4096;
+    vector<ulong> hist = distanceHistogram(getNumNodes() <= MAX_EXACT_NODES ? 0 : SAMPLED_SOURCES);
     double distSum = 0;
     double distCount = 0;
-    for (uint i = 0; i < n; i++) {
-        for (uint j = i+1; j < n; j++) {
-            if (dists[i][j] > 0) {
-                distSum += dists[i][j];
-                distCount++;
-            }
-        }
+    for (uint d = 1; d < hist.size(); d++) {
+        distSum += (double) d*hist[d];
+        distCount += hist[d];
     }
     return distSum/distCount;
 }
@@ -2723,14 +3124,15 @@ unordered_map<uint, uint> Graph::getNodeTypes_ReIndexMap() const{
 
 void Graph::reIndexGraph(unordered_map<uint, uint> reIndexMap){
     uint n = getNumNodes();
-    Matrix<MATRIX_UNIT> matrixCopy(n);
+    Matrix<MATRIX_UNIT> matrixCopy(n, n, useSparseMatrix(n));
     for (uint i = 0; i < n; i++) {
-         for (uint j = 0; j < n; j++){
+         for (uint j : adjLists[i]){
                uint a = reIndexMap[i];
                uint b = reIndexMap[j];
-               matrixCopy[a][b] = matrix[i][j];
+               matrixCopy[a][b] = matrix.get(i, j);
          }
      }
+    matrixCopy.compress();
     matrix = matrixCopy;
 
     // Adj List
@@ -2789,6 +3191,71 @@ uint Graph::getWeightedNumEdges() {
         weightedNumEdges += matrix.get(c[0], c[1]);
     return weightedNumEdges;
 }
+
+Graph::Graph(const string& name, uint numNodes) : Graph() {
+    this->name = name;
+    adjLists = vector<vector<uint> > (numNodes);
+    matrix = Matrix<MATRIX_UNIT>(numNodes, numNodes, useSparseMatrix(numNodes));
+    lockedList = vector<bool> (numNodes, false);
+    lockedTo = vector<string> (numNodes, "");
+    nodeNameToIndexMap.reserve(numNodes);
+    for (uint i = 0; i < numNodes; i++) nodeNameToIndexMap["shadow"+to_string(i)] = i;
+    initConnectedComponents();
+}
+
+void Graph::addMappedEdges(const Graph& G, const vector<uint>& A, int sign) {
+    assert(A.size() == G.getNumNodes() and (sign == 1 or sign == -1));
+    //A is injective, so no two edges of G land on the same pair
+    vector<pair<uint,uint> > appeared, vanished;
+    for (const auto& edge : G.edgeList) {
+        uint node1 = A[edge[0]], node2 = A[edge[1]];
+        int oldWeight = matrix.get(node1, node2);
+        int weight = oldWeight + sign * (int) G.matrix.get(edge[0], edge[1]);
+        assert(weight >= 0 and weight < (1L << 8*sizeof(MATRIX_UNIT)) - 1); // ensure type is large enough
+        matrix[node1][node2] = matrix[node2][node1] = weight;
+        if (oldWeight == 0 and weight > 0) appeared.push_back(minmax(node1, node2));
+        else if (oldWeight > 0 and weight == 0) vanished.push_back(minmax(node1, node2));
+    }
+    matrix.compress();
+
+    sort(vanished.begin(), vanished.end());
+    auto isVanished = [&](uint node1, uint node2) {
+        return binary_search(vanished.begin(), vanished.end(), pair<uint,uint>(minmax(node1, node2)));
+    };
+    size_t kept = 0;
+    for (size_t i = 0; i < edgeList.size(); i++) {
+        if (not vanished.empty() and isVanished(edgeList[i][0], edgeList[i][1])) continue;
+        edgeList[i][2] = matrix.get(edgeList[i][0], edgeList[i][1]);
+        if (kept != i) edgeList[kept] = move(edgeList[i]);
+        kept++;
+    }
+    edgeList.resize(kept);
+    auto unlink = [&](uint node, uint other) {
+        vector<uint>& neighbors = adjLists[node];
+        auto it = find(neighbors.begin(), neighbors.end(), other);
+        *it = neighbors.back();
+        neighbors.pop_back();
+    };
+    for (const auto& ends : vanished) {
+        unlink(ends.first, ends.second);
+        if (ends.first != ends.second) unlink(ends.second, ends.first);
+    }
+    for (const auto& ends : appeared) {
+        edgeList.push_back({ends.first, ends.second, (uint) matrix.get(ends.first, ends.second)});
+        adjLists[ends.first].push_back(ends.second);
+        if (ends.first != ends.second) adjLists[ends.second].push_back(ends.first);
+    }
+    weightedNumEdges = 0;
+    initConnectedComponents();
+}
+
+Graph Graph::prunedShadow(const Graph& G, const vector<uint>& A, const string& name) const {
+    Graph shadow(*this);
+    shadow.name = name;
+    shadow.cacheGraphletDegreeVectors = false;
+    shadow.addMappedEdges(G, A, -1);
+    return shadow;
+}
 #endif
 
 bool Graph::hasFloatWeight() const {
@@ -36,6 +36,7 @@ public:
     static const int NODE_TYPE_MIRNA; // = 2;
 
     void setMaxGraphletSize(double number);
+    double getMaxGraphletSize() const;
     static Graph& loadGraph(string name, Graph& g);
     static Graph& loadGraphFromPath(string path, string name, Graph& g, bool nodesHaveTypes = false);
     static Graph& multGraph(string name, uint path, Graph& g);
@@ -46,11 +47,16 @@ public:
     static void loadFromGmlFile(string fin, string graphName, Graph& g, bool nodesHaveTypes = false);
     static void loadFromGraphmlFile(string fin, string graphName, Graph& g, bool nodesHaveTypes = false);
     static void loadFromCsvFile(string fin, string graphName, Graph& g, bool nodesHaveTypes = false);
+    //compact binary format (.sgb) written by saveBinaryGraph; checks the file
+    //against its own hash and, if it still exists, against the source it was converted from
+    static void loadFromBinaryGraphFile(string fin, string graphName, Graph& g, bool nodesHaveTypes = false);
 
 
     static void loadGraphFromBinary(Graph& g, string graphName, string lockFile, bool nodesHaveTypes, bool lockedSameName);
     static void serializeGraph(Graph& G, string outputName, bool typedNodes, bool locked);
     void serializeShadow(Graph& G);
+    //saves this graph, loaded from sourceFile, in the .sgb format
+    void saveBinaryGraph(const string& fileName, const string& sourceFile) const;
 
     static void saveInGWFormat(string outputFile, const vector<string>& nodeNames,
         const vector<vector<uint>>& edgeList);
@@ -68,12 +74,24 @@ public:
     //double maxsize;
 
     Graph(uint n, const vector<vector<uint> > edgeList);
+#ifdef MULTI_PAIRWISE
+    //shadow network of a multiple alignment: numNodes nodes named shadow0,
+    //shadow1, ..., and no edges until addMappedEdges
+    Graph(const string& name, uint numNodes);
+#endif
 
     string getName() const;
 
     uint getNumNodes() const;
 #ifdef MULTI_PAIRWISE
     uint getWeightedNumEdges();
+    //adds the edges of G, mapped into this graph by A, to the edge weights, or
+    //subtracts them if sign is -1. The matrix is updated in place; the edge list
+    //and adjacency lists only change for the pairs whose weight becomes or stops being 0.
+    void addMappedEdges(const Graph& G, const vector<uint>& A, int sign);
+    //copy of this shadow network, named name, without the edges of G mapped by A.
+    //Its graphlet degree vectors are not cached, as no other run uses the same copy
+    Graph prunedShadow(const Graph& G, const vector<uint>& A, const string& name) const;
 #endif
     uint getNumEdges() const;
     const vector<vector<uint> >& getConnectedComponents() const;
@@ -97,6 +115,11 @@ public:
 
     vector<string> getNodeNames() const;
 
+    //hash of the node names (in index order), the node types, the adjacency
+    //lists and the edge weights; two graphs with the same hash produce the
+    //same node-indexed matrices
+    uint64_t contentHash() const;
+
     //loads graph from file in GraphWin (.gw) format:
     //http://www.algorithmic-solutions.info/leda_guide/graphs/leda_native_graph_fileformat.html
     //note: it does not parse correctly files with comments or blank lines.
@@ -132,7 +155,14 @@ public:
 
     bool hasSelfLoop(uint source) const;
 
-    void getDistanceMatrix(vector<vector<short> >& dist) const;
+    //distance between nodes i and j in dist[i*n+j], found by BFS from every node
+    static const uint8_t UNREACHABLE = 255;
+    void getDistanceMatrix(vector<uint8_t>& dist) const;
+
+    //res[d] is the number of (source, node) pairs at distance d, over all the
+    //sources or a fixed sample of numSources of them; unreachable pairs are not
+    //counted. Needs no n x n memory.
+    vector<ulong> distanceHistogram(uint numSources = 0) const;
 
     vector<uint> degreeDistribution() const;
 
@@ -185,6 +215,7 @@ private:
     bool parseFloatWeight = false;
     Matrix<float> floatWeights;
     double maxGraphletSize = 4; //default is 4, 5 is too big
+    bool cacheGraphletDegreeVectors = true; //in networks/<name>/autogenerated/
     string name;
     string path;
     //double maxsize;
@@ -210,6 +241,10 @@ private:
 
     void updateUnlockedGeneCount();
 
+    //adjacency matrices of graphs with at least this many nodes use the sparse layout even without -sparse
+    static const uint SPARSE_MATRIX_MIN_NODES;
+    static bool useSparseMatrix(uint numNodes);
+
     void initConnectedComponents();
 
     void addEdge(uint node1, uint node2);
@@ -219,8 +254,8 @@ private:
     string autogenFilesFolder();
     vector<vector<uint> > computeGraphletDegreeVectors();
 
-    //places in dist a matrix with the distance between every pair of nodes (a -1 indicates infinity)
-    void computeDistanceMatrix(vector<vector<short> >& dist) const;
+    template<class Visit>
+    void multiSourceBFS(const vector<uint>& sources, Visit visit) const;
 
     //serialization
     friend class cereal::access;
@@ -32,5 +32,8 @@ vector<string> defaultArguments = {
 "-paretoInitial 1",
 "-paretoCapacity 200",
 "-paretoIterations 10000",
-"-paretoThreads 1"
+"-paretoThreads 1",
+"-score-check-every 1",
+"-checkpoint-every 600",
+"-multi-iterations 10"
 };
@@ -1,7 +1,10 @@
 #include <cassert>
 #include <iostream>
+#include <functional>
+#include <exception>
 
 #include "measureSelector.hpp"
+#include "../utils/parallelFor.hpp"
 
 #include "../measures/EdgeCorrectness.hpp"
 #include "../measures/EdgeDifference.hpp"
@@ -230,28 +233,37 @@ void initMeasures(MeasureCombination& M, Graph& G1, Graph& G2, ArgumentParser& a
     //local measures must be initialized before wec,
     //as wec uses one of the local measures
 
+    //The local measures compute their similarity matrices in their constructors,
+    //so the measures below are only queued here, built concurrently, and then
+    //added in this same order. The lambdas copy their arguments, as args is not
+    //safe to read from several threads.
+    Graph* g1 = &G1;
+    Graph* g2 = &G2;
+    vector<function<Measure*()> > queuedMeasures;
+    vector<double> queuedWeights;
+
     if (shouldInit("nodec", G1, G2, args)) {
-        m = new NodeCount(&G1, &G2, args.doubleVectors["-nodecweights"]);
-        double nodecWeight = getWeight("nodec", G1, G2, args);
-        M.addMeasure(m, nodecWeight);
+        vector<double> nodecWeights = args.doubleVectors["-nodecweights"];
+        queuedMeasures.push_back([=]() { return new NodeCount(g1, g2, nodecWeights); });
+        queuedWeights.push_back(getWeight("nodec", G1, G2, args));
     }
 
     if (shouldInit("noded", G1, G2, args)) {
-        m = new NodeDensity(&G1, &G2, args.doubles["-maxDist"]);
-        double nodedWeight = getWeight("noded", G1, G2, args);
-        M.addMeasure(m, nodedWeight);
+        double maxDist = args.doubles["-maxDist"];
+        queuedMeasures.push_back([=]() { return new NodeDensity(g1, g2, maxDist); });
+        queuedWeights.push_back(getWeight("noded", G1, G2, args));
     }
 
     if (shouldInit("edgec", G1, G2, args)) {
-        m = new EdgeCount(&G1, &G2, args.doubleVectors["-edgecweights"]);
-        double edgecWeight = getWeight("edgec", G1, G2, args);
-        M.addMeasure(m, edgecWeight);
+        vector<double> edgecWeights = args.doubleVectors["-edgecweights"];
+        queuedMeasures.push_back([=]() { return new EdgeCount(g1, g2, edgecWeights); });
+        queuedWeights.push_back(getWeight("edgec", G1, G2, args));
     }
 
     if (shouldInit("edged", G1, G2, args)) {
-        m = new EdgeDensity(&G1, &G2, args.doubles["-maxDist"]);
-        double edgedWeight = getWeight("edged", G1, G2, args);
-        M.addMeasure(m, edgedWeight);
+        double maxDist = args.doubles["-maxDist"];
+        queuedMeasures.push_back([=]() { return new EdgeDensity(g1, g2, maxDist); });
+        queuedWeights.push_back(getWeight("edged", G1, G2, args));
     }
 
     if (shouldInit("esim", G1, G2, args)) {
@@ -264,29 +276,30 @@ void initMeasures(MeasureCombination& M, Graph& G1, Graph& G2, ArgumentParser& a
 
         cout << n_esim << '\n';
         for (int i = 0; i < n_esim; i++){
-            cout << args.stringVectors["-simFile"][i] << ' ' << args.doubleVectors["-simFormat"][i] << endl << flush;
-            m = new ExternalSimMatrix(&G1, &G2, args.stringVectors["-simFile"][i], args.doubleVectors["-simFormat"][i]);
-            double esimWeight = getWeight("esim", G1, G2, args, i);
-            M.addMeasure(m, esimWeight);
+            string simFile = args.stringVectors["-simFile"][i];
+            int simFormat = args.doubleVectors["-simFormat"][i];
+            cout << simFile << ' ' << simFormat << endl << flush;
+            queuedMeasures.push_back([=]() { return new ExternalSimMatrix(g1, g2, simFile, simFormat); });
+            queuedWeights.push_back(getWeight("esim", G1, G2, args, i));
         }
     }
 
     if (shouldInit("ewec", G1, G2, args)) {
-        m = new ExternalWeightedEdgeConservation(&G1, &G2, args.strings["-ewecFile"]);
-        double ewecWeight = getWeight("ewec", G1, G2, args);
-        M.addMeasure(m, ewecWeight);
+        string ewecFile = args.strings["-ewecFile"];
+        queuedMeasures.push_back([=]() { return new ExternalWeightedEdgeConservation(g1, g2, ewecFile); });
+        queuedWeights.push_back(getWeight("ewec", G1, G2, args));
     }
 
     if (GoSimilarity::fulfillsPrereqs(&G1, &G2)) {
         if (shouldInit("go", G1, G2, args)) {
-            m = new GoSimilarity(&G1, &G2,
-                args.doubleVectors["-goweights"], args.doubles["-gofrac"]);
-            double goWeight = getWeight("go", G1, G2, args);
-            M.addMeasure(m, goWeight);
+            vector<double> goWeights = args.doubleVectors["-goweights"];
+            double goFrac = args.doubles["-gofrac"];
+            queuedMeasures.push_back([=]() { return new GoSimilarity(g1, g2, goWeights, goFrac); });
+            queuedWeights.push_back(getWeight("go", G1, G2, args));
         }
         if (detRep || args.doubles["-netgo"] > 0) {
-            m = new NetGO(&G1, &G2);
-            M.addMeasure(m);
+            queuedMeasures.push_back([=]() { return new NetGO(g1, g2); });
+            queuedWeights.push_back(0);
         }
         //commented because it takes really long to compute,
         //and only works with yeast and human networks
@@ -296,42 +309,59 @@ void initMeasures(MeasureCombination& M, Graph& G1, Graph& G2, ArgumentParser& a
 
     if (Importance::fulfillsPrereqs(&G1, &G2)) {
         if (shouldInit("importance", G1, G2, args)) {
-            m = new Importance(&G1, &G2);
             double impWeight = getWeight("importance", G1, G2, args);
 	    assert(impWeight > 0.0);
-            M.addMeasure(m, impWeight);
+            queuedMeasures.push_back([=]() { return new Importance(g1, g2); });
+            queuedWeights.push_back(impWeight);
         }
     }
 
     if (Sequence::fulfillsPrereqs(&G1, &G2)) {
         if (shouldInit("sequence", G1, G2, args)) {
-            m = new Sequence(&G1, &G2);
-            double seqWeight = getWeight("sequence", G1, G2, args);
-            M.addMeasure(m, seqWeight);
+            queuedMeasures.push_back([=]() { return new Sequence(g1, g2); });
+            queuedWeights.push_back(getWeight("sequence", G1, G2, args));
         }
     }
 
     if (shouldInit("graphlet", G1, G2, args)) {
-        m = new Graphlet(&G1, &G2);
-        double graphletWeight = getWeight("graphlet", G1, G2, args);
-        M.addMeasure(m, graphletWeight);
+        queuedMeasures.push_back([=]() { return new Graphlet(g1, g2); });
+        queuedWeights.push_back(getWeight("graphlet", G1, G2, args));
     }
 
     if (shouldInit("graphletlgraal", G1, G2, args)) {
-        m = new GraphletLGraal(&G1, &G2);
-        double graphletLgraalWeight = getWeight("graphletlgraal", G1, G2, args);
-        M.addMeasure(m, graphletLgraalWeight);
+        queuedMeasures.push_back([=]() { return new GraphletLGraal(g1, g2); });
+        queuedWeights.push_back(getWeight("graphletlgraal", G1, G2, args));
     }
 
     if (shouldInit("graphletcosine", G1, G2, args)) {
-        m = new GraphletCosine(&G1, &G2);
-        double graphletWeight = getWeight("graphletcosine", G1, G2, args);
-        M.addMeasure(m, graphletWeight);
+        queuedMeasures.push_back([=]() { return new GraphletCosine(g1, g2); });
+        queuedWeights.push_back(getWeight("graphletcosine", G1, G2, args));
     }
     if (shouldInit("graphletnorm", G1, G2, args)) {
-        m = new GraphletNorm(&G1, &G2);
-        double graphletWeight = getWeight("graphletnorm", G1, G2, args);
-        M.addMeasure(m, graphletWeight);
+        queuedMeasures.push_back([=]() { return new GraphletNorm(g1, g2); });
+        queuedWeights.push_back(getWeight("graphletnorm", G1, G2, args));
+    }
+
+    uint numQueued = queuedMeasures.size();
+    vector<Measure*> built(numQueued, nullptr);
+    vector<exception_ptr> errors(numQueued);
+    parallelFor(numQueued, min(numQueued, defaultNumThreads()), 1, [&](uint begin, uint end, uint) {
+        for (uint i = begin; i < end; i++) {
+            try {
+                built[i] = queuedMeasures[i]();
+            } catch (...) {
+                errors[i] = current_exception();
+            }
+        }
+    });
+    for (uint i = 0; i < numQueued; i++) {
+        if (errors[i]) {
+            for (Measure* measure : built) delete measure;
+            rethrow_exception(errors[i]);
+        }
+    }
+    for (uint i = 0; i < numQueued; i++) {
+        M.addMeasure(built[i], queuedWeights[i]);
     }
 
     double wecWeight = getWeight("wec", G1, G2, args);
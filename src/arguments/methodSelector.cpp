@@ -5,6 +5,7 @@
 #include "measureSelector.hpp"
 
 #include "../utils/Timer.hpp"
+#include "../utils/parallelFor.hpp"
 #include "../methods/NoneMethod.hpp"
 #include "../methods/GreedyLCCS.hpp"
 #include "../methods/WeightedAlignmentVoter.hpp"
@@ -113,31 +114,51 @@ Method* initSANA(Graph& G1, Graph& G2, ArgumentParser& args, MeasureCombination&
 #endif
     ((SANA*) sana)->setOutputFilenames(args.strings["-o"], args.strings["-localScoresFile"]);
 
-    // t_initial "auto" defaults to by-linear-regression
-    if (args.strings["-tinitial"] == "by-linear-regression") {
-        Timer T;
-        T.start();
-        ((SANA*) sana)->searchTemperaturesByLinearRegression();
-        cout << endl << "TInitial took " << T.elapsed() << " seconds to complete." << endl << endl;
-    } else if (args.strings["-tinitial"] == "by-statistical-test") {
+    // an automatic schedule fitted by an earlier run on the same networks and objective is reused
+    bool autoSchedule = args.strings["-tinitial"] == "by-linear-regression" || args.strings["-tinitial"] == "by-statistical-test"
+        || args.strings["-tdecay"] == "by-linear-regression" || args.strings["-tdecay"] == "by-statistical-test";
+    bool scheduleCache = autoSchedule && not args.bools["-no-schedule-cache"];
+    string scheduleSettings = "tinitial=" + args.strings["-tinitial"] + " tdecay=" + args.strings["-tdecay"]
+        + " lock=" + args.strings["-lock"] + (args.bools["-lock-same-names"] ? " lock-same-names" : "");
+    if (args.strings["-tdecay"] == "by-statistical-test")
+        scheduleSettings += " t=" + to_string(args.doubles["-t"]);
+#ifdef MULTI_PAIRWISE
+    scheduleSettings += " start=" + startAligName;
+#endif
+    if (args.strings["-resume"] != "") {
+        // the schedule and run length of a resumed run come from its checkpoint
+        ((SANA*) sana)->resumeFrom(args.strings["-resume"]);
+    } else if (not (scheduleCache && ((SANA*) sana)->loadSchedule(scheduleSettings))) {
+        // t_initial "auto" defaults to by-linear-regression
+        if (args.strings["-tinitial"] == "by-linear-regression") {
+            Timer T;
+            T.start();
+            ((SANA*) sana)->searchTemperaturesByLinearRegression();
+            cout << endl << "TInitial took " << T.elapsed() << " seconds to complete." << endl << endl;
+        } else if (args.strings["-tinitial"] == "by-statistical-test") {
+            Timer T;
+            T.start();
+            ((SANA*) sana)->searchTemperaturesByStatisticalTest();
+            cout << endl << "TInitial took " << T.elapsed() << " seconds to complete." << endl << endl;
+        }
+
         Timer T;
         T.start();
-        ((SANA*) sana)->searchTemperaturesByStatisticalTest();
-        cout << endl << "TInitial took " << T.elapsed() << " seconds to complete." << endl << endl;
-    }
+        if(args.strings["-tdecay"] == "by-linear-regression") {
+	    if (args.strings["-tinitial"] == "by-linear-regression" || args.strings["-tinitial"] == "by-statistical-test"){
+	        ((SANA*) sana)->setTDecayAutomatically();
+	    } else
+	        ((SANA*) sana)->setAcceptableTFinalFromManualTInitial();
+        } else if(args.strings["-tdecay"] == "by-statistical-test") {
+	    TDecay = ((SANA*) sana)->searchTDecay(((SANA*)sana)->getTInitial(), args.doubles["-t"]);
+	    ((SANA*) sana)->setTDecay(TDecay);
+        }
+        cout << endl << "TFinal took " << T.elapsed() << " seconds to complete." << endl << endl;
 
-    Timer T;
-    T.start();
-    if(args.strings["-tdecay"] == "by-linear-regression") {
-	if (args.strings["-tinitial"] == "by-linear-regression" || args.strings["-tinitial"] == "by-statistical-test"){
-	    ((SANA*) sana)->setTDecayAutomatically();
-	} else
-	    ((SANA*) sana)->setAcceptableTFinalFromManualTInitial();
-    } else if(args.strings["-tdecay"] == "by-statistical-test") {
-	TDecay = ((SANA*) sana)->searchTDecay(((SANA*)sana)->getTInitial(), args.doubles["-t"]);
-	((SANA*) sana)->setTDecay(TDecay);
+        if (scheduleCache) {
+            ((SANA*) sana)->saveSchedule(scheduleSettings);
+        }
     }
-    cout << endl << "TFinal took " << T.elapsed() << " seconds to complete." << endl << endl;
 
 
     if (args.bools["-restart"]) {
@@ -152,6 +173,13 @@ Method* initSANA(Graph& G1, Graph& G2, ArgumentParser& args, MeasureCombination&
     if (args.bools["-dynamictdecay"]) {
        ((SANA*) sana)->setDynamicTDecay();
     }
+    if (args.doubles["-threads"] > 1) {
+        ((SANA*) sana)->enableReplicas(args.doubles["-threads"]);
+    }
+    ((SANA*) sana)->setScoreCheck(args.doubles["-score-check-every"], args.bools["-score-check-sync"]);
+    if (args.strings["-checkpoint"] != "") {
+        ((SANA*) sana)->enableCheckpoints(args.strings["-checkpoint"], args.doubles["-checkpoint-every"]);
+    }
     if (args.strings["-lock"] != ""){
       sana->setLockFile(args.strings["-lock"] );
     }
@@ -173,7 +201,7 @@ Method* initMethod(Graph& G1, Graph& G2, ArgumentParser& args, MeasureCombinatio
 
     if (name == "greedylccs")
         return new GreedyLCCS(&G1, &G2, startAligName);
-    if (name == "waveSim") {
+    if (name == "wavesim") {
         LocalMeasure* waveNodeSim =
             (LocalMeasure*) M.getMeasure(args.strings["-wavenodesim"]);
         return new WeightedAlignmentVoter(&G1, &G2, waveNodeSim);
@@ -214,8 +242,10 @@ Method* initMethod(Graph& G1, Graph& G2, ArgumentParser& args, MeasureCombinatio
 #else
         return initSANA(G1, G2, args, M);
 #endif
-    if (name == "hc")
-        return new HillClimbing(&G1, &G2, &M, startAligName);
+    if (name == "hc") {
+        uint hcThreads = args.doubles["-hc-threads"] > 0 ? args.doubles["-hc-threads"] : defaultNumThreads();
+        return new HillClimbing(&G1, &G2, &M, startAligName, hcThreads, args.bools["-hc-first-improvement"]);
+    }
     if (name == "random")
         return new RandomAligner(&G1, &G2);
     if (name == "none")
@@ -9,13 +9,15 @@
 #include "../modes/AnalysisMode.hpp"
 #include "../modes/SimilarityMode.hpp"
 #include "../modes/ParetoMode.hpp"
+#include "../modes/ConvertMode.hpp"
+#include "../modes/MultiAlignMode.hpp"
 
 #include "../utils/utils.hpp"
 
 bool validMode(string name) {
     vector<string> validModes = {
         "cluster", "exp", "param", "alpha", "dbg",
-        "normal", "analysis", "similarity", "pareto",
+        "normal", "analysis", "similarity", "pareto", "convert", "multi",
     };
     for (string s : validModes) {
         if (s == name) return true;
@@ -47,6 +49,10 @@ Mode* selectMode(ArgumentParser& args) {
         mode = new NormalMode();
     } else if(name == "pareto") {
         mode = new ParetoMode();
+    } else if (name == "convert") {
+        mode = new ConvertMode();
+    } else if (name == "multi") {
+        mode = new MultiAlignMode();
     } else {
         throw runtime_error("Error: unknown mode: " + name);
     }
@@ -35,6 +35,8 @@ vector<array<string, 6>> supportedArguments = {
     { "-truealignment", "string", "", "True Alignment", "Alignment file containing the \"true\" alignment. This is used to evaluate the NC measure. In its absence, NC assumes that the true alignment is the identity (the node with index i in G1 is mapped to the node with index i in G2). In any case, NC is expressed as the fraction of nodes in the smaller network aligned correctly.", "0" },
     { "-rewire1", "double", "0", "Add rewiring noise to G1", "If set greater than 0, the corresponding fraction of edges in G1 is randomly rewired.", "0" },
     { "-rewire2", "double", "0", "Add rewiring noise to G2", "If set greater than 0, the corresponding fraction of edges in G2 is randomly rewired.", "0" },
+    { "-sparse", "bool", "false", "Sparse Adjacency Matrices", "Store the adjacency matrices in compressed sparse row form (sorted neighbor arrays) instead of a dense n*n bit matrix. Needed for networks with hundreds of thousands of nodes; graphs with at least 100000 nodes use it even without this option.", "0" },
+    { "-no-sim-cache", "bool", "false", "Disable Similarity Matrix Cache", "Always recompute local measure similarity matrices instead of mapping them from matrices/autogenerated/. Cached matrices are keyed on the contents of both networks and the measure parameters, and are shared between SANA processes running on the same networks.", "0" },
     { "End General Options", "", "banner", "", "", "0" },
     //---------------------------------END GENERAL---------------------------------------
 
@@ -48,11 +50,18 @@ vector<array<string, 6>> supportedArguments = {
     { "", "", "banner", "", "Additional options to consider when method is \"sana\" (the default)", "0" },
     { "-tinitial", "dblS", "auto", "Initial Temperature", "Starting temperature of the simulated annealing. \"auto\" means calculate optimal starting temperature (requires extra CPU time).", "1" },
     { "-tdecay", "dblS", "auto", "Rate of Decay", "Exponential decay parameter of the temperature schedule. \"auto\" means calculate optimal starting temperature (requires extra CPU time).", "1" },
+    { "-no-schedule-cache", "bool", "false", "Disable Temperature Schedule Cache", "Always estimate an automatic temperature schedule instead of reusing the one fitted by an earlier run. Fitted schedules are kept in networks/<G1>/autogenerated/ and are keyed on the contents of both networks, the objective and the -tinitial and -tdecay options.", "0" },
     { "-combinedScoreAs", "string", "sum", "Score Combo Method", "If multiple objectives are specified, this specifies how to combine them. Choices are: sum, product, inverse, max, min, maxFactor.", "1" },
     { "-dynamictdecay", "bool", "0", "Dynamically control temperature decay", "Whether or not tdecay is set to auto, this Boolean specifies if we should dynamically adjust the temperature schedule as the anneal progresses. Gives potentially better results than fixed decay rate.", "1" },
     { "-lock", "string", "", "Node-to-Node Locking", "Specify a two column file of node pairs that are locked in the alignment.", "0" },
     { "-lock-same-names", "bool", "false", "Node-to-Node Locking", "Locks nodes with same name together.", "0" },
-    { "-seed", "double", "RANDOM", "Random Seed", "Serves as a random seed in SANA.", "0" },
+    { "-seed", "double", "RANDOM", "Random Seed", "Serves as a random seed in SANA. Two runs with the same seed, networks and arguments produce the same alignment on any machine, as long as the run length is given in iterations (-usingIterations) rather than in minutes. With -threads N, replica i uses seed+i.", "0" },
+    { "-threads", "double", "1", "Parallel Replicas", "Number of annealing replicas to run in parallel, one per thread. All replicas follow the same temperature schedule and share a single copy of the networks and similarity matrices. Every 10 million iterations the replica with the lowest score continues from a copy of the one with the highest score, and the best alignment is returned.", "0" },
+    { "-score-check-every", "double", "1", "Score Check Cadence", "Every N-th progress report (one per 10 million iterations), SANA evaluates the measures in its objective from scratch and corrects the incrementally computed score if it has drifted. The alignment of each run is also checked when it ends. 0 turns the check off.", "0" },
+    { "-checkpoint", "string", "", "Checkpoint File", "Periodically write the whole state of the anneal to this file, so that a run that gets killed can be continued with -resume. The file is replaced atomically, so it always holds a complete checkpoint. Does not work with -threads or -restart.", "0" },
+    { "-checkpoint-every", "double", "600", "Checkpoint Interval", "Seconds of annealing between two checkpoints (see -checkpoint). Checkpoints are written at progress reports, so at most one per 10 million iterations.", "0" },
+    { "-resume", "string", "", "Resume From Checkpoint", "Continue the run saved in this checkpoint file exactly where it was written: same alignment, iteration, temperature schedule, random generator state and pBad statistics. The networks and objective must be the same as in the original run; the temperature schedule and run length are taken from the checkpoint. Does not work with -threads or -restart.", "0" },
+    { "-score-check-sync", "bool", "false", "Synchronous Score Check", "Run the periodic score check on the annealing thread. By default it runs on a background thread, on a snapshot of the alignment, while the annealing goes on.", "0" },
     { "-restart", "bool", "false", "(DEPRECATED)Restart Scheme", "(DEPRECATED)Active the restart scheme in SANA.", "0" },
     { "-scheduleOnly", "bool", "false", "Temperature schedule only", "Compute temperature schedule and exit", "0" },
     { "-multi-iteration-only", "bool", "false", "Multi-Pairwise Iteration", "Skip all analysis for a normal iteration, just do the anneal", "0"},
@@ -81,6 +90,13 @@ vector<array<string, 6>> supportedArguments = {
     { "END Additional options to consider when method is \"dijkstra\"", "", "banner", "", "", "0" },
     //---------------------------------END Dikstra---------------------------------------
 
+    //------------------------------------HC---------------------------------------------
+    { "", "", "banner", "", "Additional options to consider when method is \"hc\"", "0" },
+    { "-hc-threads", "double", "0", "Hill Climbing Threads", "Number of threads that score the neighborhood of the current alignment at every step. 0 means one per core. The resulting alignment does not depend on it.", "0" },
+    { "-hc-first-improvement", "bool", "false", "First Improvement", "Make the first improving move found in the neighborhood instead of the best one. Steps are much cheaper, but more of them are needed.", "0" },
+    { "END Additional options to consider when method is \"hc\"", "", "banner", "", "", "0" },
+    //----------------------------------END HC-------------------------------------------
+
     //-----------------------------------LGRAAL------------------------------------------
     { "", "", "banner", "", "Additional options to consider when method is \"lgraal\"", "0" },
     { "-lgraaliter", "double", "1000", "LGRAAL Iteration", "Number of LGRAAL Iterations. This option is passed along to the external LGRAAL program.", "0" },
@@ -146,7 +162,7 @@ vector<array<string, 6>> supportedArguments = {
 
     //------------------------------------MODE-------------------------------------------
     { "", "", "banner", "", "Mode", "0" },
-    { "-mode", "string", "normal", "Mode", "Runs SANA in a specified mode. Arguments for this option are: \"cluster\", \"exp\", \"param\", \"alpha\", \"dbg\", \"normal\", \"analysis\", \"similarity\", \"pareto\".", "0" },
+    { "-mode", "string", "normal", "Mode", "Runs SANA in a specified mode. Arguments for this option are: \"cluster\", \"exp\", \"param\", \"alpha\", \"dbg\", \"normal\", \"analysis\", \"similarity\", \"pareto\", \"convert\" (saves the networks in the compact binary .sgb format, which -fg1/-fg2 load directly), \"multi\" (multiple network alignment through a shadow network; needs a -DMULTI_PAIRWISE build).", "0" },
     { "End Mode", "", "banner", "", "", "0" },
     //----------------------------------END MODE-----------------------------------------
 
@@ -197,6 +213,14 @@ vector<array<string, 6>> supportedArguments = {
     { "End More options for \"-mode analysis\"", "", "banner", "", "", "0" },
     //-------------------------------END ANALYSIS----------------------------------------
 
+    //----------------------------------MULTI--------------------------------------------
+    { "", "", "banner", "", "More options for \"-mode multi\"", "0" },
+    { "-multi-networks", "str_vec", "0", "Networks to Multi-Align", "An integer followed by that many network files, which \"-mode multi\" aligns to each other through a shadow network.", "0" },
+    { "-multi-iterations", "double", "10", "Multi-Alignment Iterations", "Number of times every network is re-aligned to the shadow network, for -t minutes each. Each iteration anneals the next slice of the network's temperature schedule.", "0" },
+    { "-multi-threads", "double", "0", "Multi-Alignment Threads", "Number of networks aligned to the shadow network at the same time. 0 means one per core. Every network being aligned holds its own copy of the shadow network.", "0" },
+    { "End More options for \"-mode multi\"", "", "banner", "", "", "0" },
+    //--------------------------------END MULTI------------------------------------------
+
     //---------------------------------SIMILARITY----------------------------------------
     { "", "", "banner", "", "More options for \"-mode similarity (which exports and saves the internal similarity matrix)\"", "0" },
     { "-simFormat", "int_vec", "0", "Similarity File Formats", "An integer (must be the same one used by -esim and -simFiles) followed by that many integer simFormats. Allowed values are 2=G1 doubles down by G2 doubles across matrix where node order corresponds to .gw files; 1=node names; 0=node integers numbered as in LEDA .gw format.", "0" },
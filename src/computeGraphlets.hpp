@@ -13,6 +13,10 @@
 #include <algorithm>
 #include <vector>
 
-std::vector<std::vector<uint> > computeGraphlets(int maxGraphletSize, std::string graphFileName);
+//Graphlet degree vectors (15 orbits for maxGraphletSize 4, 73 for 5) of the
+//graph with nodes 0..numNodes-1 and the given edges, computed in memory.
+//numThreads 0 means one thread per core. Safe to call concurrently.
+std::vector<std::vector<uint> > computeGraphlets(int maxGraphletSize, uint numNodes,
+        const std::vector<std::vector<uint> >& edgeList, uint numThreads = 0);
 
 #endif
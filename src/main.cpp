@@ -4,6 +4,8 @@
 #include "arguments/modeSelector.hpp"
 #include "utils/randomSeed.hpp"
 #include "utils/utils.hpp"
+#include "utils/Matrix.hpp"
+#include "utils/SimMatrix.hpp"
 #include <iostream>
 #include <stdlib.h>
 #include <stdio.h>
@@ -38,6 +40,8 @@ int main(int argc, char* argv[]) {
     }else{
         scheduleOnly = false;
     }
+    sparseMatrix = args.bools["-sparse"];
+    simMatrixCache = not args.bools["-no-sim-cache"];
     cout << "Seed: " << getRandomSeed() << endl;
     Mode* mode = selectMode(args);
     mode->run(args);
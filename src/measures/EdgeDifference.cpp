@@ -29,7 +29,7 @@ double EdgeDifference::getEdgeDifferenceSum(Graph *G1, Graph *G2, const Alignmen
     double c = 0;
     for (uint node1 = 0; node1 < G1NodesCount; ++node1) {
        for (uint node2 = node1; node2 < G1NodesCount; ++node2) { 
-           double y = abs(G1FloatWeights[node1][node2] - G2FloatWeights[A[node1]][A[node2]]) - c;
+           double y = abs(G1FloatWeights.get(node1, node2) - G2FloatWeights.get(A[node1], A[node2])) - c;
            double t = edgeDifferenceSum + y;
            c = (t - edgeDifferenceSum) - y;
            edgeDifferenceSum = t;
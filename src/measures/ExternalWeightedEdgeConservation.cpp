@@ -21,7 +21,7 @@ double ExternalWeightedEdgeConservation::eval(const Alignment& A){
     double score = 0;
     for (const auto& edge: edgeListG1) {
         uint node1 = edge[0], node2 = edge[1];
-        if (matrixG2[A[node1]][A[node2]]) {
+        if (matrixG2.get(A[node1], A[node2])) {
             std::string n1s = nodeNamesG1[node1], n2s = nodeNamesG1[node2];
             std::string an1s = nodeNamesG2[A[node1]], an2s = nodeNamesG2[A[node2]];
             int e1 = getRowIndex(n1s, n2s); //Row for G1 and Col for G2
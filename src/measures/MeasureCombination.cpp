@@ -1,5 +1,6 @@
 #include "MeasureCombination.hpp"
 #include "localMeasures/LocalMeasure.hpp"
+#include "../utils/parallelFor.hpp"
 #include <sstream>
 #include <algorithm>
 #include <iterator>
@@ -196,80 +197,59 @@ void MeasureCombination::initn1n2(uint& n1, uint& n2) const {
     for (uint i = 0; i < numMeasures(); i++) {
         Measure* m = measures[i];
         if (m->isLocal()) {
-            vector<vector<float> >* mSims = ((LocalMeasure*) m)->getSimMatrix();
+            SimMatrix* mSims = ((LocalMeasure*) m)->getSimMatrix();
             n1 = mSims->size();
-            n2 = (*mSims)[0].size();
+            n2 = mSims->numCols();
             return;
         }
     }
     throw runtime_error("There are no local measures");
 }
 
-typedef vector<vector<float> > SimMatrix;
 typedef function<void(SimMatrix &, uint const &, uint const &)> SimMatrixRecipe;
 
 //Returns a reference to the similarity matrix of the weighted sum of local measures.
 //Only initializes the matrix on the first call.
-vector<vector<float> >& MeasureCombination::getAggregatedLocalSims() {
-    //A flag to check if the map has been initialized.
-    static bool is_init = false;
+SimMatrix& MeasureCombination::getAggregatedLocalSims() {
     //The "recipe" that describes how to create the sim matrix,
     //namely to combine all locals into a new localdo.
-    static function<void(vector<vector<float> > &, uint const &, uint const &)> const initFunc =
-      [this] (vector<vector<float> > & sim, uint const & n1, uint const & n2) {
-        Measure* m;
-        double w;
+    //Rows are split across all cores; within a row, each block of columns
+    //takes the weighted sum of every measure while it is still in cache.
+    //Every cell adds the measures in the same order as before.
+    SimMatrixRecipe initFunc = [this] (SimMatrix & sim, uint const & n1, uint const & n2) {
+        vector<const float*> localSims;
+        vector<double> localWeights;
         for (uint i = 0; i < numMeasures(); i++) {
-            m = measures[i];
-            w = weights[i];
-            if (m->isLocal() and w > 0) {
-                vector<vector<float> >* mSims = ((LocalMeasure*) m)->getSimMatrix();
-                for (uint i = 0; i < n1; i++) {
-                    for (uint j = 0; j < n2; j++) {
-                        sim[i][j] += w * (*mSims)[i][j];
+            if (measures[i]->isLocal() and weights[i] > 0) {
+                localSims.push_back(((LocalMeasure*) measures[i])->getSimMatrix()->data());
+                localWeights.push_back(weights[i]);
+            }
+        }
+        const uint BLOCK = 4096;
+        parallelFor(n1, defaultNumThreads(), 16, [&](uint rowBegin, uint rowEnd, uint) {
+            for (uint i = rowBegin; i < rowEnd; i++) {
+                const size_t row = (size_t) i * n2;
+                float* aggregated = sim.data() + row;
+                for (uint jBegin = 0; jBegin < n2; jBegin += BLOCK) {
+                    uint jEnd = min(n2, jBegin + BLOCK);
+                    for (uint k = 0; k < localSims.size(); k++) {
+                        const double w = localWeights[k];
+                        const float* mSims = localSims[k] + row;
+                        for (uint j = jBegin; j < jEnd; j++) {
+                            aggregated[j] += w * mSims[j];
+                        }
                     }
                 }
             }
-        }
-      };
-    if(!is_init) {
-      is_init = true;
+        });
+    };
+    if(!localAggregatedSimInit) {
+      localAggregatedSimInit = true;
       localAggregatedSim = initSim(initFunc);
     }
     return localAggregatedSim;
 }
 
-//Returns a map defined as LocalMeasure (string) -> SimMatrix
-//Returns a reference to the map, initializing it on the first call
-//and returning the existing map on subsequent calls.
-map<string, SimMatrix>& MeasureCombination::getLocalSimMap() {
-    Measure* m;
-    double w;
-    //A flag to check if the map has been initialized.
-    static bool is_init = false;
-    //The "recipe" that describes how to create the sim matrix.
-    static SimMatrixRecipe const initFunc =
-        [this, &m, &w] (SimMatrix & sim, uint const & n1, uint const & n2) {
-            SimMatrix* mSims = ((LocalMeasure*) m)->getSimMatrix();
-            for (uint i = 0; i < n1; i++) {
-                for (uint j = 0; j < n2; j++) {
-                    sim[i][j] = w * (*mSims)[i][j];
-                }
-            }
-        };
-    if(!is_init) {
-      is_init = true;
-      for (uint i = 0; i < numMeasures(); ++i) {
-          m = measures[i];
-          w = weights[i];
-          if (m->isLocal() and w > 0) {
-              localScoreSimMap[m->getName()] = initSim(initFunc);
-          }
-      }
-    }
-    return localScoreSimMap;
-}
-
 //Abstracts the construction of the similarity matrix. Instead of the get..()
 //functions producing possibly different implementations of similarity matrices,
 //a common type of similarity matrix is produced in initSim and populated
@@ -277,7 +257,7 @@ map<string, SimMatrix>& MeasureCombination::getLocalSimMap() {
 SimMatrix MeasureCombination::initSim(SimMatrixRecipe recipe) const {
   static uint n1 = 0, n2 = 0;
   initn1n2(n1, n2);
-  vector<vector<float> > sim(n1, vector<float> (n2, 0));
+  SimMatrix sim(n1, n2);
   recipe(sim, n1, n2);
   return sim;
 }
@@ -331,6 +311,12 @@ void MeasureCombination::writeLocalScores(ostream & outFile, Graph const & G1, G
   NodeIndexMap mapG2 = G2.getIndexToNodeNameMap();
   int const COL_WIDTH = 20,
             PRECISION = 3;
+  //LocalMeasure (string) -> (weight, sim matrix), ordered by name
+  map<string, pair<double, SimMatrix*> > localScoreSimMap;
+  for (uint i = 0; i < numMeasures(); ++i) {
+      if (measures[i]->isLocal() and weights[i] > 0)
+          localScoreSimMap[measures[i]->getName()] = make_pair(weights[i], ((LocalMeasure*) measures[i])->getSimMatrix());
+  }
   outFile << setw(COL_WIDTH) << left << "Pairwise Alignment";
   for(auto const & mapping : localScoreSimMap)
       outFile << setw(COL_WIDTH) << left << mapping.first;
@@ -350,7 +336,7 @@ void MeasureCombination::writeLocalScores(ostream & outFile, Graph const & G1, G
       edgeStream.str("");
       edgeStream.clear();
       for(auto const & mapping : localScoreSimMap)
-          outFile << setw(COL_WIDTH) << left << setprecision(PRECISION) << mapping.second[i][OTHER];
+          outFile << setw(COL_WIDTH) << left << setprecision(PRECISION) << (float) (mapping.second.first * (*mapping.second.second)[i][OTHER]);
       outFile << setw(COL_WIDTH) << left << setprecision(PRECISION) << localAggregatedSim[i][OTHER] << endl;
   }
 }
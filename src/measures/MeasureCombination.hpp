@@ -12,6 +12,7 @@
 #include <iomanip>
 
 #include "Measure.hpp"
+#include "../utils/SimMatrix.hpp"
 
 class MeasureCombination {
 public:
@@ -36,8 +37,7 @@ public:
     //to private variables, similar to C# get {}
     //The const postfix has been therefore been removed
     //because these functions can lead to state changes.
-    vector<vector<float> >& getAggregatedLocalSims();
-    map<string, vector<vector<float> > >& getLocalSimMap();
+    SimMatrix& getAggregatedLocalSims();
 
     int getNumberOfLocalMeasures() const;
     void rebalanceWeight(string& input);
@@ -66,12 +66,11 @@ public:
     unsigned int getParetoThreads() {return paretoThreads;}
 
 private:
-    typedef vector<vector<float> > SimMatrix;
     typedef function<void(SimMatrix &, uint const &, uint const &)> SimMatrixRecipe;
     vector<Measure*> measures;
     vector<double> weights;
     SimMatrix localAggregatedSim;
-    map<string, SimMatrix> localScoreSimMap;
+    bool localAggregatedSimInit = false;
     
     void initn1n2(uint& n1, uint& n2) const;
 
@@ -79,7 +78,7 @@ private:
     //functions producing possibly different implementations of similarity matrices,
     //a common type of similarity matrix is produced in initSim and populated
     //by a Recipe function.
-    vector<vector<float> > initSim(SimMatrixRecipe Recipe) const;
+    SimMatrix initSim(SimMatrixRecipe Recipe) const;
 
     void clearWeights();
     void setWeight(const string& measureName, double weight);
@@ -62,7 +62,7 @@ void MultiS3::initDegrees(const Alignment& A, const Graph& G1, const Graph& G2)
     {
         for (uint j = 0; j < n2; ++j)
         {
-            totalDegrees[i] += G2Matrix[i][j];
+            totalDegrees[i] += G2Matrix.get(i, j);
         }
     }
     degreesInit = true;
@@ -2,39 +2,44 @@
 #include <vector>
 #include <iostream>
 #include "ShortestPathConservation.hpp"
+#include "../utils/parallelFor.hpp"
 
 ShortestPathConservation::ShortestPathConservation(Graph* G1, Graph* G2) : Measure(G1, G2, "spc") {
     
     G1->getDistanceMatrix(distMatrixG1);
     G2->getDistanceMatrix(distMatrixG2);
-    uint maxDistG1 = matrixMax(distMatrixG1);
-    uint maxDistG2 = matrixMax(distMatrixG2);
-    maxDist = max(maxDistG1, maxDistG2);
+    maxDist = 0;
+    for (uint8_t dist : distMatrixG1) if (dist != Graph::UNREACHABLE) maxDist = max(maxDist, (uint) dist);
+    for (uint8_t dist : distMatrixG2) if (dist != Graph::UNREACHABLE) maxDist = max(maxDist, (uint) dist);
+    uint n1 = G1->getNumNodes();
+    numPairs = (double) n1*(n1-1)/2;
 }
 
 ShortestPathConservation::~ShortestPathConservation() {
 }
 
 double ShortestPathConservation::eval(const Alignment& A) {
+    return adjustSumToTargetScore(getDifferenceSum(A));
+}
+
+unsigned long long ShortestPathConservation::getDifferenceSum(const Alignment& A) const {
     uint n1 = G1->getNumNodes();
-    uint total = 0;
-    for (uint i = 0; i < n1; i++) {
-        for (uint j = i+1; j < n1; j++) {
-            short dist1 = distMatrixG1[i][j];
-            short dist2 = distMatrixG2[A[i]][A[j]];
-            if (dist1 == -1 and dist2 == -1) {
-                total += 0;
-            }
-            else if (dist1 == -1 or dist2 == -1) {
-                total += maxDist;
-            }
-            else {
-                total += abs(dist1-dist2);
+    uint n2 = G2->getNumNodes();
+    uint numThreads = defaultNumThreads();
+    vector<unsigned long long> totals(numThreads, 0);
+    //the rows get shorter as i grows, so they are handed out in small chunks
+    parallelFor(n1, numThreads, 16, [&](uint begin, uint end, uint thread) {
+        unsigned long long total = 0;
+        for (uint i = begin; i < end; i++) {
+            const uint8_t* row1 = &distMatrixG1[(size_t)i*n1];
+            const uint8_t* row2 = &distMatrixG2[(size_t)A[i]*n2];
+            for (uint j = i+1; j < n1; j++) {
+                total += pairDifference(row1[j], row2[A[j]]);
             }
         }
-    }
-    uint numPairs = binomialCoefficient(n1, 2);
-
-    if (NORMALIZE) return 1 - (double) total/(numPairs*maxDist);
-    else return (double) total/numPairs;
+        totals[thread] += total;
+    });
+    unsigned long long total = 0;
+    for (unsigned long long t : totals) total += t;
+    return total;
 }
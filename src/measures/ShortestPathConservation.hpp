@@ -2,18 +2,39 @@
 #define SHORTESTPATHCONSERVATION_HPP
 #include "Measure.hpp"
 
+//1 - the mean, over the pairs of G1 nodes, of the difference between their
+//distance in G1 and the distance of their images in G2, scaled by the largest
+//distance in either graph. A pair that is connected in one graph but not in
+//the other counts as the largest distance.
 class ShortestPathConservation: public Measure {
 public:
     ShortestPathConservation(Graph* G1, Graph* G2);
     virtual ~ShortestPathConservation();
     double eval(const Alignment& A);
 
+    //sum of pairDifference over all the pairs, and the score it gives;
+    //SANA keeps the sum up to date incrementally. Without any pair at a
+    //positive distance (e.g., edgeless networks) every alignment scores 1.
+    unsigned long long getDifferenceSum(const Alignment& A) const;
+    double adjustSumToTargetScore(double differenceSum) const {
+        if (numPairs == 0 or maxDist == 0) return 1;
+        return 1 - differenceSum/(numPairs*maxDist);
+    }
+
+    uint pairDifference(uint8_t dist1, uint8_t dist2) const {
+        if (dist1 == Graph::UNREACHABLE or dist2 == Graph::UNREACHABLE)
+            return dist1 == dist2 ? 0 : maxDist;
+        return dist1 > dist2 ? dist1 - dist2 : dist2 - dist1;
+    }
+
+    //row-major, as given by Graph::getDistanceMatrix
+    const vector<uint8_t>& getDistMatrixG1() const { return distMatrixG1; }
+    const vector<uint8_t>& getDistMatrixG2() const { return distMatrixG2; }
+
 private:
-    vector<vector<short> > distMatrixG1, distMatrixG2;
+    vector<uint8_t> distMatrixG1, distMatrixG2;
     uint maxDist;
-
-    static const bool NORMALIZE = false;
+    double numPairs;
 };
 
 #endif
-
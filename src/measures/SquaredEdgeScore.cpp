@@ -25,12 +25,10 @@ double SquaredEdgeScore::getDenom(void){return SES_DENOM;}
 
 double SquaredEdgeScore::eval(const Alignment& A) {
 #ifdef MULTI_PAIRWISE
-    #ifdef SPARSE
+    if (G2->getMatrix().isSparse())
         return -1; // A.numSquaredAlignedEdges has speed complexity of o(n^2)
                    // It will not finish for big networks.
-    #else
-        return (double) A.numSquaredAlignedEdges(*G1, *G2) / SES_DENOM;
-    #endif
+    return (double) A.numSquaredAlignedEdges(*G1, *G2) / SES_DENOM;
 #else
     // ses not make much sense for non-weighted
     return -1;
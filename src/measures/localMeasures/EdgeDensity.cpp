@@ -72,7 +72,7 @@ void EdgeDensity::initSimMatrix() {
     uint size1 = edged1.size();
     uint size2 = edged2.size();
 
-    sims = vector<vector<float> > (size1, vector<float> (size2, 0));
+    sims = SimMatrix(size1, size2);
 
     for(uint i = 0; i < size1;  ++i) {
         for(uint j = 0; j < size2;  ++j) {
@@ -9,7 +9,7 @@ ExternalSimMatrix::ExternalSimMatrix(Graph* G1, Graph* G2, string file, int form
     this->format =format;
     string fileName = autogenMatricesFolder+G1->getName()+"_"+
         G2->getName()+"_esim_"+file;
-    loadBinSimMatrix(fileName);
+    loadBinSimMatrix(fileName, fileStamp(file));
 }
 
 void ExternalSimMatrix::initSimMatrix() {
@@ -17,7 +17,7 @@ void ExternalSimMatrix::initSimMatrix() {
     FILE* fp = readFileAsFilePointer(file, isPipe);
     uint n1 = G1->getNumNodes();
     uint n2 = G2->getNumNodes();
-    sims = vector<vector<float> > (n1, vector<float> (n2, 0));
+    sims = SimMatrix(n1, n2);
 
     if (fp == NULL) {
         throw runtime_error("ExternalSimMatrix: Error opening file");
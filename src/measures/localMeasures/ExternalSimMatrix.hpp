@@ -12,7 +12,7 @@ private:
     void loadFormat0(FILE* infile);
     void loadFormat1(FILE* infile);
     void loadFormat2(FILE* infile);
-    uint getNumEntries() const { return  sims.size() * sims[0].size(); }
+    uint getNumEntries() const { return  sims.numCells(); }
     string file;
     int format;
 };
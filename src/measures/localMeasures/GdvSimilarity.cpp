@@ -0,0 +1,196 @@
+#include <cmath>
+#include <algorithm>
+#include "GdvSimilarity.hpp"
+#include "../../utils/parallelFor.hpp"
+
+using namespace std;
+
+//The tile kernels are plain loops over a block of G2 nodes; on x86-64 Linux
+//GCC also emits an AVX2 clone of each and picks one at load time.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define GDV_KERNEL __attribute__((target_clones("avx2","default")))
+#else
+#define GDV_KERNEL
+#endif
+
+namespace {
+
+const uint BLOCK = 256; //G2 nodes per tile
+const uint ROWS_PER_CHUNK = 16; //G1 nodes that reuse a tile while it is in cache
+
+//node-major: res[i*K + k] = f(gdvs[i][orbits[k]])
+template<class Transform>
+vector<double> nodeMajor(const vector<vector<uint> >& gdvs, const vector<uint>& orbits, Transform f) {
+    uint n = gdvs.size(), K = orbits.size();
+    vector<double> res((size_t)n*K);
+    for (uint i = 0; i < n; i++) {
+        for (uint k = 0; k < K; k++) res[(size_t)i*K + k] = f(i, gdvs[i][orbits[k]]);
+    }
+    return res;
+}
+
+//orbit-major: res[k*n + i] = f(gdvs[i][orbits[k]])
+template<class Transform>
+vector<double> orbitMajor(const vector<vector<uint> >& gdvs, const vector<uint>& orbits, Transform f) {
+    uint n = gdvs.size(), K = orbits.size();
+    vector<double> res((size_t)n*K);
+    for (uint k = 0; k < K; k++) {
+        for (uint i = 0; i < n; i++) res[(size_t)k*n + i] = f(i, gdvs[i][orbits[k]]);
+    }
+    return res;
+}
+
+vector<double> magnitudes(const vector<vector<uint> >& gdvs, const vector<uint>& orbits) {
+    vector<double> res(gdvs.size());
+    for (uint i = 0; i < gdvs.size(); i++) {
+        double sum = 0;
+        for (uint k : orbits) sum += gdvs[i][k] * static_cast<double>(gdvs[i][k]);
+        res[i] = sqrt(sum);
+    }
+    return res;
+}
+
+//For every row i of sims and every block [jBegin, jEnd) of columns, zeroes
+//acc, calls tile(i, jBegin, len, acc) and stores finish(acc[j-jBegin]) in sims[i][j].
+template<class Tile, class Finish>
+void fillByTiles(SimMatrix& sims, Tile tile, Finish finish) {
+    uint n1 = sims.numRows(), n2 = sims.numCols();
+    parallelFor(n1, defaultNumThreads(), ROWS_PER_CHUNK, [&](uint rowBegin, uint rowEnd, uint) {
+        double acc[BLOCK];
+        for (uint jBegin = 0; jBegin < n2; jBegin += BLOCK) {
+            uint len = min(BLOCK, n2 - jBegin);
+            for (uint i = rowBegin; i < rowEnd; i++) {
+                fill(acc, acc + len, 0.0);
+                tile(i, jBegin, len, acc);
+                float* row = sims[i];
+                for (uint j = 0; j < len; j++) row[jBegin + j] = finish(acc[j]);
+            }
+        }
+    });
+}
+
+GDV_KERNEL void graphletTile(const double* logA, const double* log2A, const double* weights, uint K,
+        const double* logB, const double* log2B, size_t n2, uint jBegin, uint len, double* acc) {
+    for (uint k = 0; k < K; k++) {
+        const double a = logA[k], a2 = log2A[k], w = weights[k];
+        const double* b = logB + k*n2 + jBegin;
+        const double* b2 = log2B + k*n2 + jBegin;
+        for (uint j = 0; j < len; j++) {
+            //log2(max(x,y)+2) == max(log2(x+2), log2(y+2))
+            acc[j] += w * fabs(a - b[j]) / (a2 > b2[j] ? a2 : b2[j]);
+        }
+    }
+}
+
+GDV_KERNEL void lgraalTile(const double* A, uint K, const double* B, size_t n2,
+        uint jBegin, uint len, double* acc) {
+    for (uint k = 0; k < K; k++) {
+        const double a = A[k];
+        const double* b = B + k*n2 + jBegin;
+        for (uint j = 0; j < len; j++) {
+            double m = a > b[j] ? a : b[j];
+            double q = (a < b[j] ? a : b[j]) / m;
+            acc[j] += m > 0 ? q : 0.0;
+        }
+    }
+}
+
+GDV_KERNEL void dotTile(const double* A, uint K, const double* B, size_t n2,
+        uint jBegin, uint len, double* acc) {
+    for (uint k = 0; k < K; k++) {
+        const double a = A[k];
+        const double* b = B + k*n2 + jBegin;
+        for (uint j = 0; j < len; j++) acc[j] += a * b[j];
+    }
+}
+
+GDV_KERNEL void normTile(const double* A, uint K, const double* B, size_t n2,
+        uint jBegin, uint len, double* acc) {
+    for (uint k = 0; k < K; k++) {
+        const double a = A[k];
+        const double* b = B + k*n2 + jBegin;
+        for (uint j = 0; j < len; j++) {
+            double ratio = a == b[j] ? 1.0 : (a < b[j] ? a : b[j]) / (a > b[j] ? a : b[j]);
+            acc[j] += (ratio - 1) * (ratio - 1);
+        }
+    }
+}
+
+}
+
+vector<uint> allOrbits(uint numOrbits) {
+    vector<uint> res(numOrbits);
+    for (uint k = 0; k < numOrbits; k++) res[k] = k;
+    return res;
+}
+
+void graphletSims(SimMatrix& sims, const vector<vector<uint> >& gdvs1,
+    const vector<vector<uint> >& gdvs2, const vector<uint>& orbits,
+    const vector<double>& orbitWeights) {
+    uint K = orbits.size();
+    size_t n2 = gdvs2.size();
+    auto logPlus1 = [](uint i, uint x) { return log2(x + 1); };
+    auto logPlus2 = [](uint i, uint x) { return log2(x + 2); };
+    vector<double> logA = nodeMajor(gdvs1, orbits, logPlus1), log2A = nodeMajor(gdvs1, orbits, logPlus2);
+    vector<double> logB = orbitMajor(gdvs2, orbits, logPlus1), log2B = orbitMajor(gdvs2, orbits, logPlus2);
+    vector<double> weights(K);
+    double weightSum = 0;
+    for (uint k = 0; k < K; k++) {
+        weights[k] = orbitWeights[orbits[k]];
+        weightSum += weights[k];
+    }
+    fillByTiles(sims,
+        [&](uint i, uint jBegin, uint len, double* acc) {
+            graphletTile(&logA[(size_t)i*K], &log2A[(size_t)i*K], weights.data(), K,
+                logB.data(), log2B.data(), n2, jBegin, len, acc);
+        },
+        [&](double orbitDistanceSum) { return 1 - orbitDistanceSum/weightSum; });
+}
+
+void graphletLGraalSims(SimMatrix& sims, const vector<vector<uint> >& gdvs1,
+    const vector<vector<uint> >& gdvs2, const vector<uint>& orbits) {
+    uint K = orbits.size();
+    size_t n2 = gdvs2.size();
+    auto identity = [](uint i, uint x) { return (double) x; };
+    vector<double> A = nodeMajor(gdvs1, orbits, identity);
+    vector<double> B = orbitMajor(gdvs2, orbits, identity);
+    fillByTiles(sims,
+        [&](uint i, uint jBegin, uint len, double* acc) {
+            lgraalTile(&A[(size_t)i*K], K, B.data(), n2, jBegin, len, acc);
+        },
+        [&](double total) { return total/K; });
+}
+
+void graphletCosineSims(SimMatrix& sims, const vector<vector<uint> >& gdvs1,
+    const vector<vector<uint> >& gdvs2, const vector<uint>& orbits) {
+    uint K = orbits.size();
+    size_t n2 = gdvs2.size();
+    auto identity = [](uint i, uint x) { return (double) x; };
+    vector<double> A = nodeMajor(gdvs1, orbits, identity);
+    vector<double> B = orbitMajor(gdvs2, orbits, identity);
+    vector<double> magA = magnitudes(gdvs1, orbits), magB = magnitudes(gdvs2, orbits);
+    //finish only sees the dot product, so the tile divides by the magnitudes
+    fillByTiles(sims,
+        [&](uint i, uint jBegin, uint len, double* acc) {
+            dotTile(&A[(size_t)i*K], K, B.data(), n2, jBegin, len, acc);
+            for (uint j = 0; j < len; j++) acc[j] /= (magA[i] * magB[jBegin + j]);
+        },
+        [](double cosine) { return cosine; });
+}
+
+void graphletNormSims(SimMatrix& sims, const vector<vector<uint> >& gdvs1,
+    const vector<vector<uint> >& gdvs2, const vector<uint>& orbits) {
+    uint K = orbits.size();
+    size_t n2 = gdvs2.size();
+    vector<double> magA = magnitudes(gdvs1, orbits), magB = magnitudes(gdvs2, orbits);
+    //unit vectors; all zeros for nodes without any graphlets
+    vector<double> A = nodeMajor(gdvs1, orbits,
+        [&](uint i, uint x) { return magA[i] == 0 ? 0.0 : x / magA[i]; });
+    vector<double> B = orbitMajor(gdvs2, orbits,
+        [&](uint i, uint x) { return magB[i] == 0 ? 0.0 : x / magB[i]; });
+    fillByTiles(sims,
+        [&](uint i, uint jBegin, uint len, double* acc) {
+            normTile(&A[(size_t)i*K], K, B.data(), n2, jBegin, len, acc);
+        },
+        [&](double sum) { return 1 - sqrt(sum/K); });
+}
@@ -0,0 +1,40 @@
+#ifndef GDVSIMILARITY_HPP
+#define GDVSIMILARITY_HPP
+#include <vector>
+#include "../../utils/utils.hpp"
+#include "../../utils/SimMatrix.hpp"
+
+using namespace std;
+
+/*
+Builds the n1 x n2 similarity matrices of the graphlet-based local measures.
+Each node's graphlet degree vector is transformed once (logs, norms, ...) and
+stored orbit-major, so the per-pair kernels sweep a block of G2 nodes per orbit
+in a straight, vectorizable loop. Rows are split across all cores.
+
+orbits selects (and orders) the GDV entries that take part; the per-orbit
+results are accumulated in the same order and precision as the original
+per-pair code, so the matrices are unchanged.
+*/
+
+//Graphlet: 1 - sum_k w_k |log(a_k+1) - log(b_k+1)| / log(max(a_k,b_k)+2) / sum_k w_k
+void graphletSims(SimMatrix& sims, const vector<vector<uint> >& gdvs1,
+    const vector<vector<uint> >& gdvs2, const vector<uint>& orbits,
+    const vector<double>& orbitWeights);
+
+//GraphletLGraal: mean over orbits of min(a_k,b_k)/max(a_k,b_k), 0 if both are 0
+void graphletLGraalSims(SimMatrix& sims, const vector<vector<uint> >& gdvs1,
+    const vector<vector<uint> >& gdvs2, const vector<uint>& orbits);
+
+//GraphletCosine: a.b / (|a| |b|)
+void graphletCosineSims(SimMatrix& sims, const vector<vector<uint> >& gdvs1,
+    const vector<vector<uint> >& gdvs2, const vector<uint>& orbits);
+
+//GraphletNorm: 1 - RMS of (min/max - 1) over the entries of the unit vectors a/|a| and b/|b|
+void graphletNormSims(SimMatrix& sims, const vector<vector<uint> >& gdvs1,
+    const vector<vector<uint> >& gdvs2, const vector<uint>& orbits);
+
+//0, 1, ..., numOrbits-1
+vector<uint> allOrbits(uint numOrbits);
+
+#endif
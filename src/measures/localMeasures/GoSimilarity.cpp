@@ -7,10 +7,15 @@
 #include <cassert>
 #include <unordered_set>
 #include <unordered_map>
+#include <mutex>
 #include "GoSimilarity.hpp"
 
 using namespace std;
 
+//the GO measures are built concurrently: the first one generates the
+//autogenerated GO files, the others wait and read them
+static recursive_mutex goFilesMutex;
+
 const string GoSimilarity::biogridGOFile = "go/gene2go";
 
 GoSimilarity::GoSimilarity(Graph* G1, Graph* G2,
@@ -29,7 +34,11 @@ GoSimilarity::GoSimilarity(Graph* G1, Graph* G2,
     fileName += "_frac_"+extractDecimals(occurrencesFraction, 3);
     fileName += ".bin";
 
-    loadBinSimMatrix(fileName);
+    string inputStamps = fileStamp(biogridGOFile);
+    for (const Graph* G : {G1, G2}) {
+        inputStamps += " " + fileStamp("networks/"+G->getName()+"/go/"+G->getName()+"_gene_association.txt");
+    }
+    loadBinSimMatrix(fileName, inputStamps);
 }
 
 string GoSimilarity::getGoSimpleFileName(const Graph& G) {
@@ -48,6 +57,7 @@ string GoSimilarity::getGoSimpleFileName(const Graph& G) {
 }
 
 void GoSimilarity::ensureGoFileSimpleFormatExists(const Graph& G) {
+    lock_guard<recursive_mutex> lock(goFilesMutex);
     string name = G.getName();
     string goFile = "networks/"+name+"/go/"+name+"_gene_association.txt";
     string GoSimpleFile;
@@ -171,6 +181,7 @@ void GoSimilarity::simpleToInternalFormat(const Graph& G, string GOFileSimpleFor
 }
 
 void GoSimilarity::ensureGOFileInternalFormatExists(const Graph& G) {
+    lock_guard<recursive_mutex> lock(goFilesMutex);
     string GName = G.getName();
     string GOFileInternalFormat = "networks/"+GName+"/autogenerated/"+GName+"_go_internal.txt";
     if (not fileExists(GOFileInternalFormat)) {
@@ -218,7 +229,7 @@ vector<vector<uint> > GoSimilarity::loadGOTerms(
 void GoSimilarity::initSimMatrix() {
     uint n1 = G1->getNumNodes();
     uint n2 = G2->getNumNodes();
-    sims = vector<vector<float> > (n1, vector<float> (n2, 0));
+    sims = SimMatrix(n1, n2);
 
     vector<vector<uint> > G1GOTerms = loadGOTerms(*G1, occurrencesFraction);
     vector<vector<uint> > G2GOTerms = loadGOTerms(*G2, occurrencesFraction);
@@ -229,7 +240,7 @@ void GoSimilarity::initSimMatrix() {
         accumulativeWeights[i] += accumulativeWeights[i-1];
     }
 
-    sims = vector<vector<float> > (n1, vector<float> (n2, 0));
+    sims = SimMatrix(n1, n2);
     for (uint i = 0; i < n1; i++) {
         for (uint j = 0; j < n2; j++) {
             uint count = 0;
@@ -2,11 +2,12 @@
 #include <iostream>
 #include <cmath>
 #include "Graphlet.hpp"
+#include "GdvSimilarity.hpp"
 using namespace std;
 
 Graphlet::Graphlet(Graph* G1, Graph* G2) : LocalMeasure(G1, G2, "graphlet") {
     string fileName = autogenMatricesFolder+G1->getName()+"_"+G2->getName()+"_graphlet.bin";
-    loadBinSimMatrix(fileName);
+    loadBinSimMatrix(fileName, "maxGraphletSize=" + to_string((int) G1->getMaxGraphletSize()));
 }
 
 Graphlet::~Graphlet() {
@@ -35,33 +36,14 @@ vector<double> Graphlet::getOrbitWeights() {
     return res;
 }
 
-double Graphlet::getOrbitWeightSum() {
-    vector<double> orbitWeights = getOrbitWeights();
-    double res = 0;
-    for (uint i = 0; i < NUM_ORBITS; i++) {
-        res += orbitWeights[i];
-    }
-    return res;
-}
-
 void Graphlet::initSimMatrix() {
     uint n1 = G1->getNumNodes();
     uint n2 = G2->getNumNodes();
-    sims = vector<vector<float> > (n1, vector<float> (n2, 0));
+    sims = SimMatrix(n1, n2);
     vector<vector<uint> > gdvs1 = G1->loadGraphletDegreeVectors();
     vector<vector<uint> > gdvs2 = G2->loadGraphletDegreeVectors();
 
-    vector<double> orbitWeights = getOrbitWeights();
-    double weightSum = getOrbitWeightSum();
-    for (uint i = 0; i < n1; i++) {
-        for (uint j = 0; j < n2; j++) {
-            double orbitDistanceSum = 0;
-            for (uint k = 0; k < NUM_ORBITS; k++) {
-                orbitDistanceSum += orbitWeights[k] *
-                    abs(log2(gdvs1[i][k] + 1) - log2(gdvs2[j][k] + 1)) /
-                    log2(max(gdvs1[i][k], gdvs2[j][k]) + 2);
-            }
-            sims[i][j] = 1 - orbitDistanceSum/weightSum;
-        }
-    }
+    //GDVs only have 15 orbits when -maxGraphletSize is 4
+    uint numOrbits = n1 > 0 ? min(NUM_ORBITS, (uint) gdvs1[0].size()) : NUM_ORBITS;
+    graphletSims(sims, gdvs1, gdvs2, allOrbits(numOrbits), getOrbitWeights());
 }
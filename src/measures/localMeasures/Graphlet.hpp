@@ -12,7 +12,6 @@ private:
 
     vector<double> getNumbersOfAffectedOrbits();
     vector<double> getOrbitWeights();
-    double getOrbitWeightSum();
 
     const uint NUM_ORBITS = 73;
 };
@@ -9,10 +9,6 @@ public:
 
 private:
     void initSimMatrix();
-    
-    double gdvSim(uint i, uint j, const vector<vector<uint> >& gdvsG1,
-        const vector<vector<uint> >& gdvsG2);
-
 };
 
 #endif
@@ -170,7 +170,7 @@ vector<double> Importance::getImportances(const Graph& G) {
 void Importance::initSimMatrix() {
     uint n1 = G1->getNumNodes();
     uint n2 = G2->getNumNodes();
-    sims = vector<vector<float> > (n1, vector<float> (n2, 0));
+    sims = SimMatrix(n1, n2);
 
     vector<vector<uint> > adjListsG1(n1), adjListG1Shuf(n1);
     vector<vector<uint> > adjListsG2(n2), adjListG2Shuf(n2);
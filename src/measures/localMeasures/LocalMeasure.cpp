@@ -1,6 +1,7 @@
 #include "LocalMeasure.hpp"
 #include <vector>
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 
@@ -25,30 +26,43 @@ bool LocalMeasure::isLocal() {
     return true;
 }
 
-vector<vector<float> >* LocalMeasure::getSimMatrix() {
+SimMatrix* LocalMeasure::getSimMatrix() {
     return &sims;
 }
 
-void LocalMeasure::loadBinSimMatrix(string simMatrixFileName) {
-#if USE_CACHED_FILES
-// By default, USE_CACHED_FILES is 0 and SANA does not cache files. Change USE_CACHED_FILES at your own risk.
-    if (fileExists(simMatrixFileName)) {
-        uint n1 = G1->getNumNodes();
-        uint n2 = G2->getNumNodes();
-        sims = vector<vector<float> > (n1, vector<float> (n2));
-        readMatrixFromBinaryFile(sims, simMatrixFileName);
-        return;
+//The cache key covers the contents of both graphs, the file name (which
+//encodes the measure and its parameters) and the stamps of any other inputs
+//(files, the graphlet size), so a renamed or edited network never picks up a
+//stale matrix.
+void LocalMeasure::loadBinSimMatrix(string simMatrixFileName, string inputStamps) {
+    uint n1 = G1->getNumNodes();
+    uint n2 = G2->getNumNodes();
+    string baseName = simMatrixFileName.substr(autogenMatricesFolder.size());
+    replace(baseName.begin(), baseName.end(), '/', '_');
+    string cacheFile = autogenMatricesFolder + baseName;
+    uint64_t key = 0;
+    if (simMatrixCache) {
+        uint64_t graphHashes[2] = {G1->contentHash(), G2->contentHash()};
+        key = hashBytes(graphHashes, sizeof(graphHashes));
+        key = hashBytes(baseName.c_str(), baseName.size(), key);
+        key = hashBytes(inputStamps.c_str(), inputStamps.size(), key);
+        if (sims.mapCacheFile(cacheFile, n1, n2, key)) {
+            cout << "Loaded cached sim matrix " << cacheFile << endl;
+            return;
+        }
     }
-#endif
     cout << "Computing " << simMatrixFileName << " ... ";
     Timer T;
     T.start();
     initSimMatrix();
     cout << "Loading binary sim matrix done (" << T.elapsedString() << ")" << endl;
-#if USE_CACHED_FILES
-// By default, USE_CACHED_FILES is 0 and SANA does not cache files. Change USE_CACHED_FILES at your own risk.
-    writeMatrixToBinaryFile(sims, simMatrixFileName);
-#endif
+    if (simMatrixCache) {
+        createFolder("matrices");
+        createFolder(autogenMatricesFolder);
+        if (not sims.writeCacheFile(cacheFile, key)) {
+            cerr << "Warning: could not write sim matrix cache " << cacheFile << endl;
+        }
+    }
 }
 
 void LocalMeasure::writeSimsWithNames(string outfile) {
@@ -66,12 +80,10 @@ void LocalMeasure::writeSimsWithNames(string outfile) {
 
 double LocalMeasure::balanceWeight(){ //outputs the weight this measure should be multiplied by to scale kind of close to 0 through 1
     double totalSim = 0;
-    uint simNumber = 0;
-    for(uint i = 0; i < sims.size(); i++){
-        for(uint j = 0; j < sims[i].size(); j++){
-            totalSim += sims[i][j];
-            simNumber++;
-        }
+    const float* cells = sims.data();
+    size_t simNumber = sims.numCells();
+    for(size_t k = 0; k < simNumber; k++){
+        totalSim += cells[k];
     }
     double averageSim = totalSim/simNumber;
     return .5/averageSim; //average sim is scaled to one half
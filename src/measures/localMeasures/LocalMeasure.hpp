@@ -1,6 +1,7 @@
 #ifndef LOCALMEASURE_HPP
 #define LOCALMEASURE_HPP
 #include "../Measure.hpp"
+#include "../../utils/SimMatrix.hpp"
 
 class LocalMeasure: public Measure {
 public:
@@ -8,15 +9,15 @@ public:
     virtual ~LocalMeasure() =0;
     virtual double eval(const Alignment& A);
     bool isLocal();
-    vector<vector<float> >* getSimMatrix();
+    SimMatrix* getSimMatrix();
     void writeSimsWithNames(string outfile);
     double balanceWeight();
 
 protected:
-    void loadBinSimMatrix(string simMatrixFileName);
+    void loadBinSimMatrix(string simMatrixFileName, string inputStamps = "");
     virtual void initSimMatrix() =0;
     
-    vector<vector<float> > sims;
+    SimMatrix sims;
     static const string autogenMatricesFolder;
 };
 
@@ -34,7 +34,7 @@ void NodeCount::initSimMatrix() {
             densities2[i][j] += densities2[i][j-1];
         }
     }
-    sims = vector<vector<float> > (n1, vector<float> (n2, 0));
+    sims = SimMatrix(n1, n2);
     for (uint h = 0; h < k; h++) {
         if (distWeights[h] > 0) {
             for (uint i = 0; i < n1; i++) {
@@ -11,8 +11,14 @@ extern bool _graphsSwitched;
 using namespace std;
 
 Sequence::Sequence(Graph* G1, Graph* G2) : LocalMeasure(G1, G2, "sequence") {
-    string fileName = autogenMatricesFolder+G1->getName()+"_"+G2->getName()+"_sequence.bin";
-    loadBinSimMatrix(fileName);
+    string g1Name = G1->getName();
+    string g2Name = G2->getName();
+    string fileName = autogenMatricesFolder+g1Name+"_"+g2Name+"_sequence.bin";
+    string inputStamps = fileStamp("sequence/"+g1Name+".fasta") + " " +
+        fileStamp("sequence/"+g2Name+".fasta") + " " +
+        fileStamp("sequence/scores/"+g1Name+"_"+g2Name+"_blast.out") + " " +
+        fileStamp("sequence/scores/"+g2Name+"_"+g1Name+"_blast.out");
+    loadBinSimMatrix(fileName, inputStamps);
 }
 
 void Sequence::generateBitscoresFile(string bitscoresFile) {
@@ -68,7 +74,7 @@ void Sequence::initSimMatrix() {
 
     uint n1 = G1->getNumNodes();
     uint n2 = G2->getNumNodes();
-    sims = vector<vector<float> > (n1, vector<float> (n2, 0));
+    sims = SimMatrix(n1, n2);
 
     unordered_map<string,uint> g1NodeToIndexMap = G1->getNodeNameToIndexMap();
     unordered_map<string,uint> g2NodeToIndexMap = G2->getNodeNameToIndexMap();
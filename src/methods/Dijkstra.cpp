@@ -52,7 +52,7 @@ void Dijkstra::make_seed_queue(){
   auto start = get_time::now();
 
  for(unsigned int i = 0; i < sims.size(); ++i){
-    for(unsigned int j = 0; j < sims[i].size(); ++j){
+    for(unsigned int j = 0; j < sims.numCols(); ++j){
       seed_queue.insert(sims[i][j], std::make_pair(i,j));
     }
   }
@@ -48,7 +48,7 @@ private:
 
   vector<uint> A;
 
-  vector<vector<float> > sims;
+  SimMatrix sims;
 
   bool implementsLocking(){ return false; }
     
@@ -4,10 +4,17 @@
 #include "Method.hpp"
 #include <map>
 
+/*
+Steepest-descent hill climbing under the sum of the measures of M. Every step
+scores the whole change and swap neighborhood with SANA's incremental
+evaluation, split across numThreads threads, and makes the best move (or, with
+firstImprovement, the first improving one) until none improves the score.
+*/
 class HillClimbing: public Method {
 public:
     HillClimbing();
-    HillClimbing(Graph* G1, Graph* G2, MeasureCombination* M, string startAName);
+    HillClimbing(Graph* G1, Graph* G2, MeasureCombination* M, string startAName,
+        uint numThreads = 1, bool firstImprovement = false);
     virtual ~HillClimbing();
 
     Alignment run();
@@ -19,17 +26,12 @@ public:
 private:
 
     MeasureCombination *M;
-    double changeProbability;
     string startAName;
     Alignment startA;
-    
-    double executionTime;
+    uint numThreads;
+    bool firstImprovement;
 
-    //random number generation
-    mt19937 gen;
-    uniform_int_distribution<> G1RandomNode;
-    uniform_int_distribution<> G2RandomUnassignedNode;
-    uniform_real_distribution<> randomReal;
+    double executionTime;
 };
 
 #endif
@@ -15,7 +15,9 @@
 #include <set>
 #include <cmath>
 #include <limits>
+#include <numeric>
 #include <thread>
+#include <atomic>
 #include <mutex>
 #include <cassert>
 #include <signal.h>
@@ -23,6 +25,7 @@
 #include <unistd.h>
 
 #include "SANA.hpp"
+#include "../utils/parallelFor.hpp"
 #include "../measures/SymmetricSubstructureScore.hpp"
 #include "../measures/InducedConservedStructure.hpp"
 #include "../measures/EdgeCorrectness.hpp"
@@ -47,6 +50,9 @@ using namespace std;
 
 #define PBAD_HIGH_TEMP_LIMIT 0.99999
 #define PBAD_LOW_TEMP_LIMIT 1e-10
+#ifndef CORE_HOLES_PER_PEG
+#define CORE_HOLES_PER_PEG 64 // holes the core statistics keep per peg, see PegHoleFrequency
+#endif
 double LOG10_LOW_TEMP = 0, LOG10_HIGH_TEMP = 0, LOG10_NUM_STEPS = 0;
 
 #ifdef CORES
@@ -55,8 +61,6 @@ double LOG10_LOW_TEMP = 0, LOG10_HIGH_TEMP = 0, LOG10_NUM_STEPS = 0;
 static bool myNan(double x) { return !(x==x); }
 #endif
 
-static long long _maxExecutionIterations;
-
 void SANA::initTau(void) {
     /*
     tau = vector<double> {
@@ -85,14 +89,38 @@ void SANA::initTau(void) {
         5.99e-07, 5.42e-07, 8.12e-08, 4.16e-08, 6.56e-09, 9.124e-10, 6.1245e-10, 3.356e-10, 8.124e-11, 4.587e-11};
 }
 
+//the node similarities of WEC, or an empty matrix if MC does not include WEC
+static const SimMatrix& wecSimsOf(MeasureCombination* MC) {
+    static const SimMatrix none;
+    try {
+        if (MC->getWeight("wec") > 0) {
+            Measure* wec = MC->getMeasure("wec");
+            return *((WeightedEdgeConservation*) wec)->getNodeSimMeasure()->getSimMatrix();
+        }
+    } catch(...) {}
+    return none;
+}
+
+//the weighted sum of the local measures, or an empty matrix if there are none
+static const SimMatrix& localSimsOf(MeasureCombination* MC) {
+    static const SimMatrix none;
+    return MC->getSumLocalWeight() > 0 ? MC->getAggregatedLocalSims() : none;
+}
+
 SANA::SANA(Graph* G1, Graph* G2,
         double TInitial, double TDecay, double t, bool usingIterations, bool addHillClimbing, MeasureCombination* MC, string& objectiveScore
 #ifdef MULTI_PAIRWISE
         ,string& startAligName
 #endif
         ): Method(G1, G2, "SANA_"+MC->toString()),
+           G1Matrix(G1->getMatrix()),
+           G2Matrix(G2->getMatrix()),
+           G1AdjLists(G1->getAdjLists()),
+           G2AdjLists(G2->getAdjLists()),
            G1FloatWeights(G1->getFloatWeights()),
-           G2FloatWeights(G2->getFloatWeights())
+           G2FloatWeights(G2->getFloatWeights()),
+           wecSims(wecSimsOf(MC)),
+           sims(localSimsOf(MC))
 {
     //data structures for the networks
     n1              = G1->getNumNodes();
@@ -124,27 +152,20 @@ SANA::SANA(Graph* G1, Graph* G2,
     paretoIterations = MC->getParetoIterations();
     paretoThreads = MC->getParetoThreads();
 
-    G1->getMatrix(G1Matrix);
-    G2->getMatrix(G2Matrix);
-    G1->getAdjLists(G1AdjLists);
 #ifdef MULTI_PAIRWISE
     if (startAligName != "") {
         prune(startAligName);
         this->startAligName = startAligName;
     }
 #endif
-    G2->getAdjLists(G2AdjLists);
 
     //random number generation
-    random_device rd;
-    gen                       = mt19937(getRandomSeed());
-    G1RandomNode              = uniform_int_distribution<>(0, n1-1);
+    gen.seed(getRandomSeed());
     uint G1UnLockedCount      = n1 - G1->getLockedCount() -1;
     G1RandomUnlockedNodeDist  = uniform_int_distribution<>(0, G1UnLockedCount);
     G2RandomUnassignedNode    = uniform_int_distribution<>(0, n2-n1-1);
     G1RandomUnlockedGeneDist  = uniform_int_distribution<>(0, G1->unlockedGeneCount - 1);
     G1RandomUnlockedmiRNADist = uniform_int_distribution<>(0, G1->unlockedmiRNACount - 1);
-    randomReal                = uniform_real_distribution<>(0, 1);
 
     G2RandomUnassignedGeneDist = uniform_int_distribution<>(0, G2->geneCount - G1->geneCount -1);
     G2RandomUnassignedmiRNADist = uniform_int_distribution<>(0, G2->miRNACount - G1->miRNACount -1);
@@ -227,12 +248,21 @@ SANA::SANA(Graph* G1, Graph* G2,
         TCWeight = 0;
     }
 
+    try {
+        spcWeight = MC->getWeight("spc");
+    } catch (...) {
+        spcWeight = 0;
+    }
+    if (spcWeight > 0 and score != Score::sum) {
+        throw runtime_error("spc is only part of the sum objective; use -combinedScoreAs sum");
+    }
+
     localWeight = MC->getSumLocalWeight();
 
 
     restart              = false; //restart scheme
     dynamic_tdecay       = false; //temperature decay dynamically
-    needAligEdges        = icsWeight > 0 || ecWeight > 0 || s3Weight > 0 || wecWeight > 0 || secWeight > 0 || mecWeight > 0; //to evaluate EC incrementally
+    needAligEdges        = icsWeight > 0 || ecWeight > 0 || s3Weight > 0 || secWeight > 0 || mecWeight > 0; //to evaluate EC incrementally; WEC only needs wecSum
     needEd               = edWeight > 0; // to evaluate edge difference score incrementally
     needSquaredAligEdges = sesWeight > 0; // to evaluate SES incrementally
 	needExposedEdges	 = eeWeight > 0; // to eval EE incrementally
@@ -242,28 +272,36 @@ SANA::SANA(Graph* G1, Graph* G2,
     needEwec             = ewecWeight>0; //to evaluate EWEC incrementally
     needSec              = secWeight > 0; //to evaluate SEC incrementally
     needTC               = TCWeight > 0; //to evaluation TC incrementally
+    needSpc              = spcWeight > 0; //to evaluate SPC incrementally
+    spc                  = needSpc ? (ShortestPathConservation*) MC->getMeasure("spc") : NULL;
     needLocal            = localWeight > 0;
 
-    if (needWec) {
-        Measure* wec                     = MC->getMeasure("wec");
-        LocalMeasure* m                  = ((WeightedEdgeConservation*) wec)->getNodeSimMeasure();
-        vector<vector<float> >* wecSimsP = m->getSimMatrix();
-        wecSims                          = (*wecSimsP);
+    //the measures sumScore is made of; local ones are checked through sims
+    set<string> incrementalMeasures = {"ec", "ed", "s3", "ics", "sec", "tc", "wec", "ewec", "nc", "spc"
+#ifdef MULTI_PAIRWISE
+        , "mec", "ses", "ee", "ms3"
+#endif
+    };
+    for (uint i = 0; i < MC->numMeasures(); i++) {
+        Measure* m = MC->getMeasure(i);
+        double weight = MC->getWeight(m->getName());
+        if (weight > 0 and not m->isLocal() and incrementalMeasures.count(m->getName())) {
+            objectiveMeasures.push_back({m, weight});
+        }
     }
+
 #ifdef CORES
 #if UNWEIGHTED_CORES
     numPegSamples = vector<ulong>(n1, 0);
-    pegHoleFreq = Matrix<ulong>(n1, n2);
+    pegHoleFreq = PegHoleFrequency<ulong>(n1, CORE_HOLES_PER_PEG);
 #endif
-    weightedPegHoleFreq_pBad = Matrix<double>(n1, n2);
+    weightedPegHoleFreq_pBad = PegHoleFrequency<double>(n1, CORE_HOLES_PER_PEG);
     totalWeightedPegWeight_pBad = vector<double>(n1, 0);
-    weightedPegHoleFreq_1mpBad = Matrix<double>(n1, n2);
+    weightedPegHoleFreq_1mpBad = PegHoleFrequency<double>(n1, CORE_HOLES_PER_PEG);
     totalWeightedPegWeight_1mpBad = vector<double>(n1, 0);
 #endif
     //to evaluate local measures incrementally
     if (needLocal) {
-        sims              = MC->getAggregatedLocalSims();
-        localSimMatrixMap = MC->getLocalSimMap();
         localWeight       = 1; //the values in the sim matrix 'sims' have already been scaled by the weight
     } else {
         localWeight = 0;
@@ -299,6 +337,8 @@ Alignment SANA::getStartingAlignment(){
 
     if(this->startAligName != "")
         randomAlig = Alignment::loadEdgeList(G1, G2, startAligName);
+    else if (not startMapping.empty())
+        randomAlig = Alignment(startMapping);
     else if (G1->hasNodeTypes())
         randomAlig = Alignment::randomAlignmentWithNodeType(G1,G2);
     else if (lockFileName != "")
@@ -328,41 +368,21 @@ Alignment SANA::getStartingAlignment(){
 ** that we want to output, and it guarantees that every node appears in at
 ** least one aligned node-pair according to this score.  We output this Smin.
 */
-double SANA::TrimCoreScores(Matrix<ulong>& Freq, vector<ulong>& numPegSamples)
+//holes missing from a peg's table score 0
+template <typename T, typename Total>
+double SANA::TrimCoreScores(const PegHoleFrequency<T>& Freq, const vector<Total>& totalPegWeight)
 {
-    uint n1 = Freq.size(), n2 = Freq[0].size();
-    vector<double> high1(n1,0.0);
-    vector<double> high2(n2,0.0);
-
-    for(uint i=0; i<n1; i++){
-	double denom =  1.0 / (double)numPegSamples[i];
-	for(uint j=0;j<n2; j++)
-	{
-	    double score = Freq[i][j] * denom;
-	    if(score > high1[i]) high1[i] = score;
-	    if(score > high2[j]) high2[j] = score;
-	}
-    }
-    double Smin = high1[0];
-    for(uint i=0;i<n1;i++) if(high1[i] < Smin) Smin = high1[i];
-    for(uint j=0;j<n2;j++) if(high2[j] < Smin) Smin = high2[j];
-    return Smin;
-}
-
-double SANA::TrimCoreScores(Matrix<double>& Freq, vector<double>& totalPegWeight)
-{
-    uint n1 = Freq.size(), n2 = Freq[0].size();
     vector<double> high1(n1,0.0);
     vector<double> high2(n2,0.0);
 
     for(uint i=0; i<n1; i++){
 	double denom =  1.0 / (double)totalPegWeight[i];
-	for(uint j=0;j<n2; j++)
+	Freq.forEach(i, [&](uint j, T total)
 	{
-	    double score = Freq[i][j] * denom;
+	    double score = total * denom;
 	    if(score > high1[i]) high1[i] = score;
 	    if(score > high2[j]) high2[j] = score;
-	}
+	});
     }
     double Smin = high1[0];
     for(uint i=0;i<n1;i++) if(high1[i] < Smin) Smin = high1[i];
@@ -371,19 +391,29 @@ double SANA::TrimCoreScores(Matrix<double>& Freq, vector<double>& totalPegWeight
 }
 
 Alignment SANA::run() {
+    if ((not resumeFileName.empty() or not checkpointFileName.empty()) and (restart or numReplicas > 1)) {
+        throw runtime_error("-checkpoint and -resume do not support the restart scheme or -threads");
+    }
     if (restart)
         return runRestartPhases();
     else {
         long long int iter = 0;
         Alignment align;
+        auto startA = [this]() { return resumeFileName.empty() ? getStartingAlignment() : Alignment(resumeMapping); };
         if(!usingIterations) {
           cout << "usingIterations = 0" << endl;
 	  double leeway = 2;
-          align = simpleRun(getStartingAlignment(), minutes * 60 * leeway, (long long int) (getIterPerSecond()*minutes*60), iter);
+          if (numReplicas > 1)
+            align = replicaRun(startA(), minutes * 60 * leeway, (long long int) (getIterPerSecond()*minutes*60), iter);
+          else
+            align = simpleRun(startA(), minutes * 60 * leeway, (long long int) (getIterPerSecond()*minutes*60), iter);
         }
         else {
           cout << "usingIterations = 1" << endl;
-          align = simpleRun(getStartingAlignment(), ((long long int)(maxIterations))*10000000, iter);
+          if (numReplicas > 1)
+            align = replicaRun(startA(), numeric_limits<double>::max(), ((long long int)(maxIterations))*10000000, iter);
+          else
+            align = simpleRun(startA(), ((long long int)(maxIterations))*10000000, iter);
         }
 
         if(addHillClimbing){
@@ -412,13 +442,25 @@ Alignment SANA::run() {
 	unordered_map<uint,string> G2Index2Name = G2->getIndexToNodeNameMap();
 	printf("######## core frequencies#########\n");
 	printf("p1 p2 unwgtd w1_pB\n");
-	for(uint i=0; i<n1; i++) for(uint j=0; j<n2; j++)
+	for(uint i=0; i<n1; i++)
+	{
+	// only the holes kept for peg i can score above 0
+	vector<uint> holes;
+	auto keep = [&](uint j, double) { holes.push_back(j); };
+#if UNWEIGHTED_CORES
+	pegHoleFreq.forEach(i, keep);
+#endif
+	weightedPegHoleFreq_pBad.forEach(i, keep);
+	weightedPegHoleFreq_1mpBad.forEach(i, keep);
+	sort(holes.begin(), holes.end());
+	holes.erase(unique(holes.begin(), holes.end()), holes.end());
+	for(uint j : holes)
 	{
 #if UNWEIGHTED_CORES
-	    double unweightdedScore = pegHoleFreq[i][j]/(double)numPegSamples[i];
+	    double unweightdedScore = pegHoleFreq.get(i, j)/(double)numPegSamples[i];
 #endif
-	    double weightedScore_pBad = weightedPegHoleFreq_pBad[i][j]/totalWeightedPegWeight_pBad[i];
-	    double weightedScore_1mpBad = weightedPegHoleFreq_1mpBad[i][j]/totalWeightedPegWeight_1mpBad[i];
+	    double weightedScore_pBad = weightedPegHoleFreq_pBad.get(i, j)/totalWeightedPegWeight_pBad[i];
+	    double weightedScore_1mpBad = weightedPegHoleFreq_1mpBad.get(i, j)/totalWeightedPegWeight_1mpBad[i];
 	    if(
 #if UNWEIGHTED_CORES
 		unweightdedScore  >= max(MIN_CORE_SCORE,SminUnW) ||
@@ -437,6 +479,7 @@ Alignment SANA::run() {
 #endif
 			weightedScore_pBad, weightedScore_1mpBad);
 	}
+	}
 #endif // PRINT_CORES
         return align;
     }
@@ -499,71 +542,15 @@ unordered_set<vector<uint>*>* SANA::paretoRun(const string& fileName) {
     return storedAlignments;
 }
 
-// Used for method #2 of locking
-inline uint SANA::G1RandomUnlockedNode_Fast() {
-    return unLockedNodesG1[G1RandomUnlockedNodeDist(gen)];
-}
-
 inline uint SANA::G1RandomUnlockedNode(){
-    #ifdef REINDEX
-        return G1RandomUnlockedNodeDist(gen);
-    #else
-        return G1RandomUnlockedNode_Fast();
-    #endif
+    return unLockedNodesG1[gen.below(unLockedNodesG1.size())];
 }
 
-// Gives a random unlocked nodes with the same type as source1
+// Gives a random unlocked node with the same type as source1
 // Only called from performswap
 inline uint SANA::G1RandomUnlockedNode(uint source1){
-    if(!nodesHaveType){
-        return SANA::G1RandomUnlockedNode();
-    }
-    else{
-        // Checking node type and returning one with same type
-        #ifdef REINDEX
-            bool isGene = source1 < (uint) G1->unlockedGeneCount;
-            if(isGene)
-                return G1RandomUnlockedGeneDist(gen);
-            else
-                return G1->unlockedGeneCount + G1RandomUnlockedmiRNADist(gen);
-        #else
-            bool isGene = G1->nodeTypes[source1] == Graph::NODE_TYPE_GENE;
-            if(isGene){
-                int index = G1RandomUnlockedGeneDist(gen);
-                return G1->geneIndexList[index];
-            }
-            else{
-                int index =  G1RandomUnlockedmiRNADist(gen);
-                return G1->miRNAIndexList[index];
-            }
-        #endif
-    }
-}
-
-// Return index of the unassigned node in the unassginedNodesG2 (or unassignedgenesG2, ...)
-inline uint SANA::G2RandomUnlockedNode(uint target1){
-    if(!nodesHaveType){
-        return G2RandomUnlockedNode_Fast();
-    } else {
-        bool isGene = G2->nodeTypes[target1] == Graph::NODE_TYPE_GENE;
-        if(isGene){
-            int index = G2RandomUnassignedGeneDist(gen);
-            return index;
-        }
-        else {
-            int index = G2RandomUnassignedmiRNADist(gen);
-            return index;
-        }
-        // uint node;
-        // do {
-        //     node = G2RandomUnlockedNode_Fast(); // gives back unlocked G2 node
-        // } while(G2->nodeTypes[target1] != G2->nodeTypes[(*unassignedNodesG2)[node]]);
-        // return node;
-    }
-}
-
-inline uint SANA::G2RandomUnlockedNode_Fast(){
-    return G2RandomUnassignedNode(gen);
+    const vector<uint>& pool = G1UnlockedPools[G1PoolOf[source1]];
+    return pool[gen.below(pool.size())];
 }
 
 void SANA::describeParameters(ostream& sout) {
@@ -611,6 +598,30 @@ void SANA::enableRestartScheme(double minutesNewAlignments, uint iterationsPerSt
     }
 }
 
+void SANA::enableReplicas(uint numReplicas) {
+    if (needMS3 and numReplicas > 1) {
+        //the MS3 degree counts are static in MultiS3, so replicas would share them
+        cout << "ms3 is in the objective: running 1 replica instead of " << numReplicas << endl;
+        numReplicas = 1;
+    }
+    this->numReplicas = max(1u, numReplicas);
+}
+
+void SANA::setScoreCheck(uint step, bool sync) {
+    scoreCheckStep = step;
+    scoreCheckSync = sync;
+}
+
+//The temperature is piecewise constant: it is recomputed every TEMPERATURE_STEP
+//iterations, and whenever iter does not follow the last iteration it was set
+//for (a new run, or a jump), instead of on every move.
+inline void SANA::updateTemperature(long long int iter) {
+    if (iter % TEMPERATURE_STEP == 0 or iter != temperatureIter + 1) {
+        Temperature = temperatureFunction(iter, TInitial, TDecay);
+    }
+    temperatureIter = iter;
+}
+
 double SANA::temperatureFunction(long long int iter, double TInitial, double TDecay) {
     double fraction;
     if(usingIterations)
@@ -666,6 +677,7 @@ void SANA::initDataStructures(const Alignment& startA) {
         }
     }
     assert(index == unlockedG1);
+    initMoveSampler();
 
     if (needAligEdges or needSec) {
         aligEdges = startA.numAlignedEdges(*G1, *G2);
@@ -697,7 +709,6 @@ void SANA::initDataStructures(const Alignment& startA) {
         for (uint i = 0; i < n1; i++) {
             localScoreSum += sims[i][(*A)[i]];
         }
-        localScoreSumMap = new map<string, double>;
     }
 
     if (needWec) {
@@ -716,6 +727,10 @@ void SANA::initDataStructures(const Alignment& startA) {
         ncSum       = (nc->eval(*A))*trueA.back();
     }
 
+    if (needSpc) {
+        spcSum = spc->getDifferenceSum(*A);
+    }
+
     if(needTC){
         Measure* tc  = MC->getMeasure("tc");
         maxTriangles = ((TriangleCorrectness*)tc)->getMaxTriangles();
@@ -723,17 +738,70 @@ void SANA::initDataStructures(const Alignment& startA) {
     }
 
     iterationsPerformed = 0;
+    lastCheckpointTime = 0;
+    progressSteps = 0;
+    lastCheckedIter = lastCorrectionIter = -1;
     sampledProbabilitySize = 0;
     buffer_sum = 0;
     buffer_index = 0;
-    currentScore = eval(startA);
+    currentScore = evalObjective(*A); //the score the incremental sums track
+    chooseIterationKernel();
     timer.start();
 }
 
+void SANA::initMoveSampler() {
+    G1PoolOf = vector<uint8_t>(n1, 0);
+    G2PoolOf = vector<uint8_t>(n2, 0);
+    if (not nodesHaveType) {
+        G1UnlockedPools[0]   = unLockedNodesG1;
+        G2UnassignedPools[0] = G2UnassignedPools[1] = unassignedNodesG2;
+        return;
+    }
+    //pool 0 holds the genes, pool 1 the miRNAs
+    uint unlockedGenes = G1->unlockedGeneCount, unlockedmiRNAs = G1->unlockedmiRNACount;
+#ifdef REINDEX
+    //reindexing puts the unlocked genes first and the unlocked miRNAs right after them
+    G1UnlockedPools[0] = vector<uint>(unlockedGenes);
+    G1UnlockedPools[1] = vector<uint>(unlockedmiRNAs);
+    iota(G1UnlockedPools[0].begin(), G1UnlockedPools[0].end(), 0);
+    iota(G1UnlockedPools[1].begin(), G1UnlockedPools[1].end(), unlockedGenes);
+    for (uint i = unlockedGenes; i < n1; i++)
+        G1PoolOf[i] = 1;
+#else
+    G1UnlockedPools[0] = vector<uint>(G1->geneIndexList.begin(), G1->geneIndexList.begin() + unlockedGenes);
+    G1UnlockedPools[1] = vector<uint>(G1->miRNAIndexList.begin(), G1->miRNAIndexList.begin() + unlockedmiRNAs);
+    for (uint i = 0; i < n1; i++)
+        G1PoolOf[i] = G1->nodeTypes[i] == Graph::NODE_TYPE_GENE ? 0 : 1;
+#endif
+    for (uint i = 0; i < n2; i++)
+        G2PoolOf[i] = G2->nodeTypes[i] == Graph::NODE_TYPE_GENE ? 0 : 1;
+    G2UnassignedPools[0] = unassignedgenesG2;
+    G2UnassignedPools[1] = unassignedmiRNAsG2;
+}
+
 double SANA::eval(const Alignment& Al) {
     return MC->eval(Al);
 }
 
+//The weighted sum of the measures in the incremental score, evaluated from
+//scratch. Measures SANA does not optimize are left out, and the local ones
+//are read from sims, as the annealing does. Safe to call from another thread
+//while the annealing goes on, as it only reads mapping and shared state,
+//except with ms3, whose eval rewrites the static MultiS3 denominator.
+double SANA::evalObjective(const vector<uint>& mapping) {
+    Alignment Al(mapping);
+    double total = 0;
+    for (const pair<Measure*, double>& m : objectiveMeasures) {
+        total += m.second * m.first->eval(Al);
+    }
+    if (needLocal) {
+        double localSum = 0;
+        for (uint i = 0; i < n1; i++) localSum += sims[i][mapping[i]];
+        total += localWeight * (localSum / n1);
+    }
+    return total;
+}
+
 void SANA::setInterruptSignal() {
     interrupt = false;
     struct sigaction sigInt;
@@ -760,74 +828,86 @@ void SANA::setOutputFilenames(string outputFileName, string localScoresFileName)
 
 Alignment SANA::simpleRun(const Alignment& startA, double maxExecutionSeconds, long long int& iter) {
     initDataStructures(startA);
+    if (not resumeFileName.empty()) restoreCheckpoint(iter);
     setInterruptSignal();
 
     for (; ; ++iter) {
-        Temperature = temperatureFunction(iter, TInitial, TDecay);
+        updateTemperature(iter);
         if (interrupt) {
             break;
         }
         if (saveAlignment) {
             printReport();
         }
-        if (iter%iterationsPerStep == 0) {
+        if (iter%iterationsPerStep == 0 and iter != resumedIter) {
             trackProgress(iter);
+            if (not checkpointFileName.empty() and timer.elapsed() - lastCheckpointTime >= checkpointSeconds) {
+                saveCheckpoint(iter);
+            }
             if (iter != 0 and timer.elapsed() > maxExecutionSeconds) {
                 break;
             }
         }
         SANAIteration();
     }
-    trackProgress(iter);
+    trackProgress(iter, true);
     return *A;
 }
 
 Alignment SANA::simpleRun(const Alignment& startA, double maxExecutionSeconds, long long int maxExecutionIterations,
 		long long int& iter) {
-    _maxExecutionIterations = maxExecutionIterations;
+    runIterations = maxExecutionIterations;
     initDataStructures(startA);
+    if (not resumeFileName.empty()) restoreCheckpoint(iter);
     setInterruptSignal();
 	for (; ; ++iter) {
-		Temperature = temperatureFunction(iter, TInitial, TDecay);
+		updateTemperature(iter);
 		if (interrupt) {
 			break; // return *A;
 		}
         if (saveAlignment) {
             printReport();
         }
-		if (iter%iterationsPerStep == 0) {
+		if (iter%iterationsPerStep == 0 and iter != resumedIter) {
 			trackProgress(iter);
 			if( iter != 0 and timer.elapsed() > maxExecutionSeconds and currentScore - previousScore < 0.005 ){
 				break;
 			}
 			previousScore = currentScore;
+			if (not checkpointFileName.empty() and timer.elapsed() - lastCheckpointTime >= checkpointSeconds) {
+			    saveCheckpoint(iter);
+			}
 		}
 		if (iter != 0 and iter > maxExecutionIterations) {
 			break;
 		}
 		SANAIteration();
 	}
-	trackProgress(iter);
+	trackProgress(iter, true);
 	return *A; //dummy return to shut compiler warning
 }
 
 Alignment SANA::simpleRun(const Alignment& startA, long long int maxExecutionIterations, long long int& iter) {
 
         initDataStructures(startA);
-	_maxExecutionIterations = maxExecutionIterations;
+        if (not resumeFileName.empty()) restoreCheckpoint(iter);
+	runIterations = maxExecutionIterations;
 
         setInterruptSignal();
 
         for (; ; ++iter) {
-                Temperature = temperatureFunction(iter, TInitial, TDecay);
+                updateTemperature(iter);
                 if (interrupt) {
                         break; // return *A;
                 }
                 if (saveAlignment) {
                     printReport();
                 }
-                if (iter%iterationsPerStep == 0) {
+                if (iter%iterationsPerStep == 0 and iter != resumedIter) {
                         trackProgress(iter);
+                        if (not checkpointFileName.empty() and timer.elapsed() - lastCheckpointTime >= checkpointSeconds) {
+                            saveCheckpoint(iter);
+                        }
 
                 }
                 if (iter != 0 and iter > maxExecutionIterations) {
@@ -835,7 +915,7 @@ Alignment SANA::simpleRun(const Alignment& startA, long long int maxExecutionIte
                 }
                 SANAIteration();
         }
-        trackProgress(iter);
+        trackProgress(iter, true);
         return *A; //dummy return to shut compiler warning
 }
 
@@ -849,10 +929,11 @@ unordered_set<vector<uint>*>* SANA::simpleParetoRun(const Alignment& startA, dou
     paretoFront = ParetoFront(paretoCapacity, numOfMeasures, measureNames);
     assert(numOfMeasures > 1 && "Pareto mode must optimize on more than one measure");
     score = Score::pareto;
+    chooseIterationKernel();
     initializeParetoFront();
 
     for (; ; ++iter) {
-	Temperature = temperatureFunction(iter, TInitial, TDecay);
+	updateTemperature(iter);
 	if (interrupt) {
 	    return storedAlignments;
 	}
@@ -873,7 +954,7 @@ unordered_set<vector<uint>*>* SANA::simpleParetoRun(const Alignment& startA, dou
 	}
 	SANAIteration();
     }
-    trackProgress(iter);
+    trackProgress(iter, true);
     return storedAlignments;
 }
 
@@ -887,10 +968,11 @@ unordered_set<vector<uint>*>* SANA::simpleParetoRun(const Alignment& startA, lon
     paretoFront = ParetoFront(paretoCapacity, numOfMeasures, measureNames);
     assert(numOfMeasures > 1 && "Pareto mode must optimize on more than one measure");
     score = Score::pareto;
+    chooseIterationKernel();
     initializeParetoFront();
 
     for (; ; ++iter) {
-    	Temperature = temperatureFunction(iter, TInitial, TDecay);
+    	updateTemperature(iter);
         if (interrupt) {
             return storedAlignments;
         }
@@ -911,7 +993,7 @@ unordered_set<vector<uint>*>* SANA::simpleParetoRun(const Alignment& startA, lon
         }
         SANAIteration();
     }
-    trackProgress(iter);
+    trackProgress(iter, true);
     return storedAlignments;
 }
 
@@ -1044,7 +1126,6 @@ void SANA::prepareMeasureDataByAlignment() {
     TCSum            = (needTC) ?  storedTCSum[A] : -1;
     edSum            = (needEd) ?  storedEdSum[A] : -1;
     localScoreSum    = (needLocal) ? storedLocalScoreSum[A] : -1;
-    localScoreSumMap = (needLocal) ? new map<string, double>(*storedLocalScoreSumMap[A]) : nullptr;
     wecSum           = (needWec) ?  storedWecSum[A] : -1;
     ewecSum          = (needEwec) ?  storedEwecSum[A] : -1;
     ncSum            = (needNC) ? storedNcSum[A] : -1;
@@ -1070,8 +1151,6 @@ void SANA::releaseAlignment() {
     delete unassignedNodesG2;
     delete unassignedmiRNAsG2;
     delete unassignedgenesG2;
-    if (needLocal)
-        delete localScoreSumMap;
 }
 
 void SANA::insertCurrentAndPrepareNewMeasureDataByAlignment(vector<double> &addScores) {
@@ -1112,7 +1191,6 @@ void SANA::insertCurrentAlignmentAndData() {
     if(needEd)                   storedEdSum[A]            = edSum;
     if(needTC)                   storedTCSum[A]            = TCSum;
     if(needLocal)                storedLocalScoreSum[A]    = localScoreSum;
-    if(needLocal)                storedLocalScoreSumMap[A] = localScoreSumMap;
     if(needWec)                  storedWecSum[A]           = wecSum;
     if(needEwec)                 storedEwecSum[A]          = ewecSum;
     if(needNC)                   storedNcSum[A]            = ncSum;
@@ -1147,7 +1225,6 @@ void SANA::removeAlignmentData(vector<uint>* toRemove) {
     if(needTC)                   storedTCSum.erase(toRemove);
     if(needEd)                   storedEdSum.erase(toRemove);
     if(needLocal)                storedLocalScoreSum.erase(toRemove);
-    if(needLocal)                storedLocalScoreSumMap.erase(toRemove);
     if(needWec)                  storedWecSum.erase(toRemove);
     if(needEwec)                 storedEwecSum.erase(toRemove);
     if(needNC)                   storedNcSum.erase(toRemove);
@@ -1200,75 +1277,99 @@ void SANA::deallocateParetoData() {
         for(auto i = storedUnassignedgenesG2.begin(); i != storedUnassignedgenesG2.end(); i++)
             delete i->second;
     }
-    for(auto i = storedLocalScoreSumMap.begin(); i != storedLocalScoreSumMap.end(); i++)
-        delete i->second;
 }
 
 void SANA::SANAIteration() {
+    (this->*iterationKernel)();
+}
+
+void SANA::genericIteration() {
     ++iterationsPerformed;
-    if(G1->hasNodeTypes()) {
-        // Choose the type here based on counts (and locking...)
-        // For example if no locking, then prob (gene) >> prob (miRNA)
-        // And if locking, then arrange prob(gene) and prob(miRNA) appropriately
-        int type = /* something clever */ 0;
-        (randomReal(gen) < changeProbability[type]) ? performChange(type) : performSwap(type);
-    } else {
-        (randomReal(gen) < changeProbability[0]) ? performChange(0) : performSwap(0);
-    }
+    // With node types, the type could be chosen here based on counts (and locking...)
+    // For example if no locking, then prob (gene) >> prob (miRNA)
+    // And if locking, then arrange prob(gene) and prob(miRNA) appropriately
+    // For now both types use the ratio of the genes.
+    (gen.real() < changeProbability[0]) ? performChange(0) : performSwap(0);
+}
+
+void SANA::changeSums(uint source, uint oldTarget, uint newTarget, MoveSums& sums) {
+    if (needMS3)
+    {
+        sums.oldTarget1Deg = MultiS3::totalDegrees[oldTarget];
+        sums.oldTarget2Deg = MultiS3::totalDegrees[newTarget];
+        sums.oldMs3Denom   = MultiS3::denom;
+    }
+    sums.aligEdges         = (needAligEdges or needSec) ?  aligEdges + aligEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.edSum             = (needEd) ?  edSum + edgeDifferenceIncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.squaredAligEdges  = (needSquaredAligEdges) ?  squaredAligEdges + squaredAligEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.exposedEdgesNumer = (needExposedEdges) ? exposedEdgesNumer + exposedEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.MS3Numer          = (needMS3) ? MS3Numer + MS3IncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.inducedEdges      = (needInducedEdges) ?  inducedEdges + inducedEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.TCSum             = (needTC) ?  TCSum + TCIncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.localScoreSum     = (needLocal) ? localScoreSum + localScoreSumIncChangeOp(sims, source, oldTarget, newTarget) : -1;
+    sums.wecSum            = (needWec) ?  wecSum + WECIncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.ewecSum           = (needEwec) ?  ewecSum + EWECIncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.ncSum             = (needNC) ? ncSum + ncIncChangeOp(source, oldTarget, newTarget) : -1;
+    sums.spcSum            = (needSpc) ? spcSum + SPCIncChangeOp(source, oldTarget, newTarget) : -1;
+}
+
+//a swap keeps the set of aligned G2 nodes, so the induced edges do not change
+void SANA::swapSums(uint source1, uint source2, uint target1, uint target2, MoveSums& sums) {
+    if (needMS3)
+    {
+        sums.oldTarget1Deg = MultiS3::totalDegrees[target1];
+        sums.oldTarget2Deg = MultiS3::totalDegrees[target2];
+        sums.oldMs3Denom   = MultiS3::denom;
+    }
+    sums.aligEdges         = (needAligEdges or needSec) ?  aligEdges + aligEdgesIncSwapOp(source1, source2, target1, target2) : -1;
+    sums.inducedEdges      = inducedEdges;
+    sums.TCSum             = (needTC) ?  TCSum + TCIncSwapOp(source1, source2, target1, target2) : -1;
+    sums.squaredAligEdges  = (needSquaredAligEdges) ? squaredAligEdges + squaredAligEdgesIncSwapOp(source1, source2, target1, target2) : -1;
+    sums.exposedEdgesNumer = (needExposedEdges) ?  exposedEdgesNumer + exposedEdgesIncSwapOp(source1, source2, target1, target2) : -1;
+    sums.MS3Numer          = (needMS3) ?  MS3Numer + MS3IncSwapOp(source1, source2, target1, target2) : -1;
+    sums.wecSum            = (needWec) ?  wecSum + WECIncSwapOp(source1, source2, target1, target2) : -1;
+    sums.ewecSum           = (needEwec) ?  ewecSum + EWECIncSwapOp(source1, source2, target1, target2) : -1;
+    sums.ncSum             = (needNC) ? ncSum + ncIncSwapOp(source1, source2, target1, target2) : -1;
+    sums.localScoreSum     = (needLocal) ? localScoreSum + localScoreSumIncSwapOp(sims, source1, source2, target1, target2) : -1;
+    sums.edSum             = (needEd) ?  edSum + edgeDifferenceIncSwapOp(source1, source2, target1, target2) : -1;
+    sums.spcSum            = (needSpc) ? spcSum + SPCIncSwapOp(source1, source2, target1, target2) : -1;
+}
+
+void SANA::storeSums(const MoveSums& sums) {
+    aligEdges         = sums.aligEdges;
+    edSum             = sums.edSum;
+    inducedEdges      = sums.inducedEdges;
+    TCSum             = sums.TCSum;
+    localScoreSum     = sums.localScoreSum;
+    wecSum            = sums.wecSum;
+    ewecSum           = sums.ewecSum;
+    ncSum             = sums.ncSum;
+    spcSum            = sums.spcSum;
+    exposedEdgesNumer = sums.exposedEdgesNumer;
+    squaredAligEdges  = sums.squaredAligEdges;
+    MS3Numer          = sums.MS3Numer;
+}
+
+void SANA::restoreMS3(uint target1, uint target2, const MoveSums& sums) {
+    MultiS3::totalDegrees[target1] = sums.oldTarget1Deg;
+    MultiS3::totalDegrees[target2] = sums.oldTarget2Deg;
+    MultiS3::denom                 = sums.oldMs3Denom;
 }
 
 void SANA::performChange(int type) {
     uint source       = G1RandomUnlockedNode();
     uint oldTarget    = (*A)[source];
 
-    uint newTargetIndex = G2RandomUnlockedNode(oldTarget);
-
-    uint newTarget = -1;
-    bool isGene = false;
-    if(!nodesHaveType)
-        newTarget    = (*unassignedNodesG2)[newTargetIndex];
-    else{
-        isGene = G2->nodeTypes[oldTarget] == Graph::NODE_TYPE_GENE;
-        if(isGene){
-            if(unassignedgenesG2->size() == 0)
-                return; // cannot perform change, all genes are assigned
-            newTarget = (*unassignedgenesG2)[newTargetIndex];
-        }
-        else{
-            if(unassignedmiRNAsG2->size() == 0)
-                return; // cannot perform change, all miRNA are assigned
-            newTarget = (*unassignedmiRNAsG2)[newTargetIndex];
-        }
-    }
-    unsigned oldOldTargetDeg, oldNewTargetDeg, oldMs3Denom;
-    if (needMS3)
-    {
-        oldOldTargetDeg = MultiS3::totalDegrees[oldTarget];
-        oldNewTargetDeg = MultiS3::totalDegrees[newTarget];
-        oldMs3Denom = MultiS3::denom;
-    }
-
-    int newAligEdges           = (needAligEdges or needSec) ?  aligEdges + aligEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
-    double newEdSum            = (needEd) ?  edSum + edgeDifferenceIncChangeOp(source, oldTarget, newTarget) : -1;
-    double newSquaredAligEdges = (needSquaredAligEdges) ?  squaredAligEdges + squaredAligEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
-	double newExposedEdgesNumer= (needExposedEdges) ? exposedEdgesNumer + exposedEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
-    double newMS3Numer         = (needMS3) ? MS3Numer + MS3IncChangeOp(source, oldTarget, newTarget) : -1;
-    int newInducedEdges        = (needInducedEdges) ?  inducedEdges + inducedEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
-    double newTCSum            = (needTC) ?  TCSum + TCIncChangeOp(source, oldTarget, newTarget) : -1;
-    double newLocalScoreSum    = (needLocal) ? localScoreSum + localScoreSumIncChangeOp(sims, source, oldTarget, newTarget) : -1;
-    double newWecSum           = (needWec) ?  wecSum + WECIncChangeOp(source, oldTarget, newTarget) : -1;
-    double newEwecSum          = (needEwec) ?  ewecSum + EWECIncChangeOp(source, oldTarget, newTarget) : -1;
-    double newNcSum            = (needNC) ? ncSum + ncIncChangeOp(source, oldTarget, newTarget) : -1;
-
-    map<string, double> newLocalScoreSumMap;
-    if (needLocal) {
-        newLocalScoreSumMap = map<string, double>(*localScoreSumMap);
-        for(auto &item : newLocalScoreSumMap)
-            item.second += localScoreSumIncChangeOp(localSimMatrixMap[item.first], source, oldTarget, newTarget);
-    }
+    vector<uint>& unassignedPool = *G2UnassignedPools[G2PoolOf[oldTarget]];
+    if (unassignedPool.empty())
+        return; // cannot perform change, all nodes of this type are assigned
+    uint newTargetIndex = gen.below(unassignedPool.size());
+    uint newTarget      = unassignedPool[newTargetIndex];
+    MoveSums sums;
+    changeSums(source, oldTarget, newTarget, sums);
 
     double newCurrentScore = 0;
-    bool makeChange = scoreComparison(newAligEdges, newInducedEdges, newTCSum, newLocalScoreSum, newWecSum, newNcSum, newCurrentScore, newEwecSum, newSquaredAligEdges, newExposedEdgesNumer, newEdSum, newMS3Numer);
+    bool makeChange = scoreComparison(sums.aligEdges, sums.inducedEdges, sums.TCSum, sums.localScoreSum, sums.wecSum, sums.ncSum, newCurrentScore, sums.ewecSum, sums.squaredAligEdges, sums.exposedEdgesNumer, sums.edSum, sums.MS3Numer, sums.spcSum);
 
 #ifdef CORES
 	// Statistics on the emerging core alignment.
@@ -1279,65 +1380,36 @@ void SANA::performChange(int type) {
         if(pBad <= 0 || myNan(pBad)) pBad = PBAD_LOW_TEMP_LIMIT;
 #if UNWEIGHTED_CORES
 	numPegSamples[source]++;
-	pegHoleFreq[source][betterHole]++;
+	pegHoleFreq.add(source, betterHole, 1);
 #endif
 	totalWeightedPegWeight_pBad[source] += pBad;
-	weightedPegHoleFreq_pBad[source][betterHole] += pBad;
+	weightedPegHoleFreq_pBad.add(source, betterHole, pBad);
 	totalWeightedPegWeight_1mpBad[source] += 1-pBad;
-	weightedPegHoleFreq_1mpBad[source][betterHole] += 1-pBad;
+	weightedPegHoleFreq_1mpBad.add(source, betterHole, 1-pBad);
 #endif
 
     if (makeChange)
     {
         (*A)[source]                         = newTarget;
-        
-        if(!nodesHaveType)
-            (*unassignedNodesG2)[newTargetIndex] = oldTarget;
-        else {
-            if(isGene){
-                (*unassignedgenesG2)[newTargetIndex] = oldTarget;
-            }
-            else {
-                (*unassignedmiRNAsG2)[newTargetIndex] = oldTarget;
-            }
-        }
-
+        unassignedPool[newTargetIndex]       = oldTarget;
         (*assignedNodesG2)[oldTarget]        = false;
         (*assignedNodesG2)[newTarget]        = true;
-
-        aligEdges                            = newAligEdges;
-        edSum                                = newEdSum;
-        inducedEdges                         = newInducedEdges;
-        TCSum                                = newTCSum;
-        localScoreSum                        = newLocalScoreSum;
-        wecSum                               = newWecSum;
-        ewecSum                              = newEwecSum;
-        ncSum                                = newNcSum;
-        if (needLocal)
-            (*localScoreSumMap) = newLocalScoreSumMap;
 #if 0
-        if(randomReal(gen)<=1) {
+        if(gen.real()<=1) {
         double foo = eval(*A);
         if(fabs(foo - newCurrentScore)>20){
-            cout << "\nChange: nCS " << newCurrentScore << " (nSAE) " << newSquaredAligEdges << " eval " << foo << " nCS - eval " << newCurrentScore-foo;
-            //cout << "source " << source << " oldTarget " << oldTarget << " newTarget " << newTarget << " adj? " << G2Matrix[oldTarget][newTarget] << endl;
-            newCurrentScore = newSquaredAligEdges = foo;
+            cout << "\nChange: nCS " << newCurrentScore << " (nSAE) " << sums.squaredAligEdges << " eval " << foo << " nCS - eval " << newCurrentScore-foo;
+            //cout << "source " << source << " oldTarget " << oldTarget << " newTarget " << newTarget << " adj? " << G2Matrix.get(oldTarget, newTarget) << endl;
+            newCurrentScore = sums.squaredAligEdges = foo;
         } else cout << "c";
         }
 #endif
-        currentScore     = newCurrentScore;
-		exposedEdgesNumer= newExposedEdgesNumer;
-        squaredAligEdges = newSquaredAligEdges;
-        MS3Numer         = newMS3Numer;
+        storeSums(sums);
+        currentScore                         = newCurrentScore;
     }
-    else
+    else if (needMS3)
     {
-        if (needMS3)
-        {
-            MultiS3::totalDegrees[oldTarget] = oldOldTargetDeg;
-            MultiS3::totalDegrees[newTarget] = oldNewTargetDeg;
-            MultiS3::denom = oldMs3Denom;
-        }
+        restoreMS3(oldTarget, newTarget, sums);
     }
 
     if(score == Score::pareto and ((iterationsPerformed % paretoIterations) == 0)) {
@@ -1352,35 +1424,12 @@ void SANA::performSwap(int type) {
     uint source1 = G1RandomUnlockedNode();
     uint source2 = G1RandomUnlockedNode(source1);
     uint target1 = (*A)[source1], target2 = (*A)[source2];
-    
-    unsigned oldTarget1Deg, oldTarget2Deg, oldMs3Denom;
-    if (needMS3)
-    {
-        oldTarget1Deg = MultiS3::totalDegrees[target1];
-        oldTarget2Deg = MultiS3::totalDegrees[target2];
-        oldMs3Denom = MultiS3::denom;
-    }
-
-    int newAligEdges           = (needAligEdges or needSec) ?  aligEdges + aligEdgesIncSwapOp(source1, source2, target1, target2) : -1;
-    int newTCSum               = (needTC) ?  TCSum + TCIncSwapOp(source1, source2, target1, target2) : -1;
-    double newSquaredAligEdges = (needSquaredAligEdges) ? squaredAligEdges + squaredAligEdgesIncSwapOp(source1, source2, target1, target2) : -1;
-	double newExposedEdgesNumer= (needExposedEdges) ?  exposedEdgesNumer + exposedEdgesIncSwapOp(source1, source2, target1, target2) : -1;
-    double newMS3Numer         = (needMS3) ?  MS3Numer + MS3IncSwapOp(source1, source2, target1, target2) : -1;
-    double newWecSum           = (needWec) ?  wecSum + WECIncSwapOp(source1, source2, target1, target2) : -1;
-    double newEwecSum          = (needEwec) ?  ewecSum + EWECIncSwapOp(source1, source2, target1, target2) : -1;
-    double newNcSum            = (needNC) ? ncSum + ncIncSwapOp(source1, source2, target1, target2) : -1;
-    double newLocalScoreSum    = (needLocal) ? localScoreSum + localScoreSumIncSwapOp(sims, source1, source2, target1, target2) : -1;
-    double newEdSum            = (needEd) ?  edSum + edgeDifferenceIncSwapOp(source1, source2, target1, target2) : -1;
-
-    map<string, double> newLocalScoreSumMap;
-    if (needLocal) {
-        newLocalScoreSumMap = map<string, double>(*localScoreSumMap);
-        for (auto &item : newLocalScoreSumMap)
-            item.second += localScoreSumIncSwapOp(localSimMatrixMap[item.first], source1, source2, target1, target2);
-    }
+    MoveSums sums;
+    swapSums(source1, source2, target1, target2, sums);
 
+    //MS3 is scored with the current numerator
     double newCurrentScore = 0;
-    bool makeChange = scoreComparison(newAligEdges, inducedEdges, newTCSum, newLocalScoreSum, newWecSum, newNcSum, newCurrentScore, newEwecSum, newSquaredAligEdges, newExposedEdgesNumer, newEdSum, MS3Numer);
+    bool makeChange = scoreComparison(sums.aligEdges, sums.inducedEdges, sums.TCSum, sums.localScoreSum, sums.wecSum, sums.ncSum, newCurrentScore, sums.ewecSum, sums.squaredAligEdges, sums.exposedEdgesNumer, sums.edSum, MS3Numer, sums.spcSum);
 
 #ifdef CORES
         // Statistics on the emerging core alignment.
@@ -1392,55 +1441,39 @@ void SANA::performSwap(int type) {
         uint betterDest2 = wasBadMove ? target2 : target1;
 #if UNWEIGHTED_CORES
         numPegSamples[source1]++; numPegSamples[source2]++;
-        pegHoleFreq[source1][betterDest1]++; pegHoleFreq[source2][betterDest2]++;
+        pegHoleFreq.add(source1, betterDest1, 1); pegHoleFreq.add(source2, betterDest2, 1);
 #endif
         totalWeightedPegWeight_pBad[source1] += pBad;
-        weightedPegHoleFreq_pBad[source1][betterDest1] += pBad;
+        weightedPegHoleFreq_pBad.add(source1, betterDest1, pBad);
         totalWeightedPegWeight_pBad[source2] += pBad;
-        weightedPegHoleFreq_pBad[source2][betterDest2] += pBad;
+        weightedPegHoleFreq_pBad.add(source2, betterDest2, pBad);
 
         totalWeightedPegWeight_1mpBad[source1] += 1-pBad;
-        weightedPegHoleFreq_1mpBad[source1][betterDest1] += 1-pBad;
+        weightedPegHoleFreq_1mpBad.add(source1, betterDest1, 1-pBad);
         totalWeightedPegWeight_1mpBad[source2] += 1-pBad;
-        weightedPegHoleFreq_1mpBad[source2][betterDest2] += 1-pBad;
+        weightedPegHoleFreq_1mpBad.add(source2, betterDest2, 1-pBad);
 #endif
 
     if (makeChange)
     {
         (*A)[source1]       = target2;
         (*A)[source2]       = target1;
-        aligEdges           = newAligEdges;
-        edSum               = newEdSum;
-        localScoreSum       = newLocalScoreSum;
-        TCSum               = newTCSum;
-        wecSum              = newWecSum;
-        ewecSum             = newEwecSum;
-        ncSum               = newNcSum;
+        storeSums(sums);
         currentScore        = newCurrentScore;
-        squaredAligEdges    = newSquaredAligEdges;
-		exposedEdgesNumer   = newExposedEdgesNumer;
-        MS3Numer            = newMS3Numer;
-        if (needLocal)
-            (*localScoreSumMap) = newLocalScoreSumMap;
 #if 0
-        if (randomReal(gen) <= 1) {
+        if (gen.real() <= 1) {
             double foo = eval(*A);
             if (fabs(foo - newCurrentScore) > 20) {
-                cout << "\nSwap: nCS " << newCurrentScore << " eval " << foo << " nCS - eval " << newCurrentScore - foo << " adj? " << (G1Matrix[source1][source2] & G2Matrix[target1][target2]);
-                newCurrentScore = newSquaredAligEdges = foo;
+                cout << "\nSwap: nCS " << newCurrentScore << " eval " << foo << " nCS - eval " << newCurrentScore - foo << " adj? " << (G1Matrix.get(source1, source2) & G2Matrix.get(target1, target2));
+                newCurrentScore = squaredAligEdges = foo;
             }
             else cout << "s";
         }
 #endif
     }
-    else
+    else if (needMS3)
     {
-        if (needMS3)
-        {
-            MultiS3::totalDegrees[target1] = oldTarget1Deg;
-            MultiS3::totalDegrees[target2] = oldTarget2Deg;
-            MultiS3::denom = oldMs3Denom;
-        }
+        restoreMS3(target1, target2, sums);
     }
     
     if(score == Score::pareto and ((iterationsPerformed % paretoIterations) == 0)) {
@@ -1451,7 +1484,7 @@ void SANA::performSwap(int type) {
     }
 }
 
-bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double newTCSum, double newLocalScoreSum, double newWecSum, double newNcSum, double& newCurrentScore, double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer, double newEdgeDifferenceSum, double newMS3Numer) {
+bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double newTCSum, double newLocalScoreSum, double newWecSum, double newNcSum, double& newCurrentScore, double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer, double newEdgeDifferenceSum, double newMS3Numer, double newSpcSum) {
     bool makeChange = false;
     wasBadMove = false;
     double badProbability = 0;
@@ -1460,26 +1493,10 @@ bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double n
     {
     case Score::sum:
     {
-        newCurrentScore += ecWeight * (newAligEdges / g1Edges);
-        newCurrentScore += edWeight * EdgeDifference::adjustSumToTargetScore(newEdgeDifferenceSum, pairsCount);
-        newCurrentScore += s3Weight * (newAligEdges / (g1Edges + newInducedEdges - newAligEdges));
-        newCurrentScore += icsWeight * (newAligEdges / newInducedEdges);
-        newCurrentScore += secWeight * (newAligEdges / g1Edges + newAligEdges / g2Edges)*0.5;
-        newCurrentScore += TCWeight * (newTCSum);
-        newCurrentScore += localWeight * (newLocalScoreSum / n1);
-        newCurrentScore += wecWeight * (newWecSum / (2 * g1Edges));
-        newCurrentScore += ewecWeight * (newEwecSum);
-        newCurrentScore += ncWeight * (newNcSum / trueA.back());
-#ifdef MULTI_PAIRWISE
-        newCurrentScore += mecWeight * (newAligEdges / (g1WeightedEdges + g2WeightedEdges));
-        newCurrentScore += sesWeight * newSquaredAligEdges / SquaredEdgeScore::getDenom();
-		newCurrentScore += eeWeight * (1 - (newExposedEdgesNumer / (double)EdgeExposure::getDenom()));
-        newCurrentScore += ms3Weight * ((newMS3Numer / MultiS3::denom) / NUM_GRAPHS);
-#endif
+        newCurrentScore += sumScore(newAligEdges, newInducedEdges, newTCSum, newLocalScoreSum, newWecSum, newNcSum, newEwecSum, newSquaredAligEdges, newExposedEdgesNumer, newEdgeDifferenceSum, newMS3Numer, newSpcSum);
         energyInc = newCurrentScore - currentScore;
         wasBadMove = energyInc < 0;
-        badProbability = exp(energyInc / Temperature);
-        makeChange = (energyInc >= 0 or randomReal(gen) <= badProbability);
+        makeChange = energyInc >= 0 or acceptBadMove(energyInc, badProbability);
         break;
     }
     case Score::product:
@@ -1495,8 +1512,7 @@ bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double n
         newCurrentScore *= ncWeight * (newNcSum / trueA.back());
         energyInc = newCurrentScore - currentScore;
         wasBadMove = energyInc < 0;
-        badProbability = exp(energyInc / Temperature);
-        makeChange = (energyInc >= 0 or randomReal(gen) <= exp(energyInc / Temperature));
+        makeChange = energyInc >= 0 or acceptBadMove(energyInc, badProbability);
         break;
     }
     case Score::max:
@@ -1520,8 +1536,8 @@ bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double n
 
         energyInc = newCurrentScore - currentScore;
         wasBadMove = energyInc < 0;
-        badProbability = exp(energyInc / Temperature);
-        makeChange = deltaEnergy >= 0 or randomReal(gen) <= exp(energyInc / Temperature);
+        if (wasBadMove or not (deltaEnergy >= 0)) badProbability = exp(energyInc / Temperature);
+        makeChange = deltaEnergy >= 0 or gen.real() <= badProbability;
         break;
     }
     case Score::min:
@@ -1544,8 +1560,8 @@ bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double n
 
         energyInc = newCurrentScore - currentScore; //is this even used?
         wasBadMove = deltaEnergy < 0;
-        badProbability = exp(energyInc / Temperature);
-        makeChange = deltaEnergy >= 0 or randomReal(gen) <= exp(newCurrentScore / Temperature);
+        if (wasBadMove) badProbability = exp(energyInc / Temperature);
+        makeChange = deltaEnergy >= 0 or gen.real() <= exp(newCurrentScore / Temperature);
         break;
     }
     case Score::inverse:
@@ -1560,8 +1576,7 @@ bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double n
 
         energyInc = newCurrentScore - currentScore;
         wasBadMove = energyInc < 0;
-        badProbability = exp(energyInc / Temperature);
-        makeChange = (energyInc >= 0 or randomReal(gen) <= exp(energyInc / Temperature));
+        makeChange = energyInc >= 0 or acceptBadMove(energyInc, badProbability);
         break;
     }
     case Score::maxFactor:
@@ -1589,8 +1604,7 @@ bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double n
 
         energyInc = newCurrentScore - currentScore;
         wasBadMove = maxScore < -1 * minScore;
-        badProbability = exp(energyInc / Temperature);
-        makeChange = maxScore >= -1 * minScore or randomReal(gen) <= exp(energyInc / Temperature);
+        makeChange = maxScore >= -1 * minScore or acceptBadMove(energyInc, badProbability);
         break;
     }
     case Score::pareto:
@@ -1625,8 +1639,8 @@ bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double n
             newCurrentScore += ncWeight * (newNcSum / trueA.back());
             energyInc = newCurrentScore - currentScore;
             wasBadMove = energyInc < 0;
-            badProbability = exp(energyInc / Temperature);
-            makeChange = (addScores[currentMeasure] > currentScores[currentMeasure] or energyInc >= 0 or randomReal(gen) <= exp(energyInc / Temperature));
+            if (wasBadMove) badProbability = exp(energyInc / Temperature);
+            makeChange = (addScores[currentMeasure] > currentScores[currentMeasure] or energyInc >= 0 or gen.real() <= badProbability);
             if(makeChange) currentScores = addScores;
         }
         break;
@@ -1637,35 +1651,199 @@ bool SANA::scoreComparison(double newAligEdges, double newInducedEdges, double n
 	//the above will never be true in the case of iterationsPerformed never being changed so that it doesn't greatly
 	// slow down the program if for some reason iterationsPerformed doesn't need to be changed.
     if (wasBadMove) { // I think Dillon was wrong above, just do it always - WH
-        if (sampledProbabilitySize == CIRCULAR_BUFFER_SIZE) {
-            buffer_index = (buffer_index == CIRCULAR_BUFFER_SIZE ? 0 : buffer_index);
-            buffer_sum -= sampledProbability[buffer_index];
-            sampledProbability[buffer_index] = badProbability;
-        }
-        else
-        {
-            sampledProbability[buffer_index] = badProbability;
-            sampledProbabilitySize++;
-        }
-        buffer_sum += badProbability;
-        buffer_index++;
+        sampleBadProbability(badProbability);
     }
     return makeChange;
 }
 
+//Metropolis test for a move with energyInc < 0. Improving moves never get
+//here, so they cost no exp; a bad move needs exactly one, as its acceptance
+//probability also goes into the pBad buffer. Callers test for an improving
+//move with >=, so a NaN energyInc also lands here, and is rejected as before.
+inline bool SANA::acceptBadMove(double energyInc, double& badProbability) {
+    badProbability = exp(energyInc / Temperature);
+    return gen.real() <= badProbability;
+}
+
+//adds the acceptance probability of a bad move to the circular buffer behind pBad
+inline void SANA::sampleBadProbability(double badProbability) {
+    if (sampledProbabilitySize == CIRCULAR_BUFFER_SIZE) {
+        buffer_index = (buffer_index == CIRCULAR_BUFFER_SIZE ? 0 : buffer_index);
+        buffer_sum -= sampledProbability[buffer_index];
+        sampledProbability[buffer_index] = badProbability;
+    }
+    else
+    {
+        sampledProbability[buffer_index] = badProbability;
+        sampledProbabilitySize++;
+    }
+    buffer_sum += badProbability;
+    buffer_index++;
+}
+
+void SANA::chooseIterationKernel() {
+    iterationKernel = &SANA::genericIteration;
+#ifndef CORES
+    bool otherTerms = needEd or needSquaredAligEdges or needExposedEdges or needTC or needEwec or needNC
+        or needSec or needSpc or mecWeight > 0;
+#ifndef MULTI_PAIRWISE
+    otherTerms = otherTerms or needMS3; //MS3 only counts towards the score in multi-pairwise builds
+#endif
+    if (score != Score::sum or otherTerms) return;
+    uint terms = (ecWeight > 0 ? EC_TERM : 0) | (s3Weight > 0 ? S3_TERM : 0) | (icsWeight > 0 ? ICS_TERM : 0)
+        | (needLocal ? LOCAL_TERM : 0) | (needWec ? WEC_TERM : 0) | (needMS3 ? MS3_TERM : 0);
+    switch (terms) {
+        case S3_TERM:                iterationKernel = &SANA::kernelIteration<S3_TERM>; break;
+        case EC_TERM:                iterationKernel = &SANA::kernelIteration<EC_TERM>; break;
+        case ICS_TERM:               iterationKernel = &SANA::kernelIteration<ICS_TERM>; break;
+        case EC_TERM | LOCAL_TERM:   iterationKernel = &SANA::kernelIteration<EC_TERM | LOCAL_TERM>; break;
+        case S3_TERM | LOCAL_TERM:   iterationKernel = &SANA::kernelIteration<S3_TERM | LOCAL_TERM>; break;
+        case WEC_TERM:               iterationKernel = &SANA::kernelIteration<WEC_TERM>; break;
+#ifdef MULTI_PAIRWISE
+        case MS3_TERM:               iterationKernel = &SANA::kernelIteration<MS3_TERM>; break;
+#endif
+        default: break;
+    }
+#endif
+}
+
+template<uint Terms>
+void SANA::kernelIteration() {
+    ++iterationsPerformed;
+    (gen.real() < changeProbability[0]) ? kernelChange<Terms>() : kernelSwap<Terms>();
+}
+
+template<uint Terms>
+void SANA::kernelChange() {
+    const bool alig = Terms & (EC_TERM | S3_TERM | ICS_TERM), induced = Terms & (S3_TERM | ICS_TERM);
+    uint source    = G1RandomUnlockedNode();
+    uint oldTarget = (*A)[source];
+
+    vector<uint>& unassignedPool = *G2UnassignedPools[G2PoolOf[oldTarget]];
+    if (unassignedPool.empty())
+        return; // cannot perform change, all nodes of this type are assigned
+    uint newTargetIndex = gen.below(unassignedPool.size());
+    uint newTarget      = unassignedPool[newTargetIndex];
+    unsigned oldOldTargetDeg = 0, oldNewTargetDeg = 0, oldMs3Denom = 0;
+    if (Terms & MS3_TERM) {
+        oldOldTargetDeg = MultiS3::totalDegrees[oldTarget];
+        oldNewTargetDeg = MultiS3::totalDegrees[newTarget];
+        oldMs3Denom     = MultiS3::denom;
+    }
+
+    int newAligEdges        = alig ? aligEdges + aligEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
+    int newInducedEdges     = induced ? inducedEdges + inducedEdgesIncChangeOp(source, oldTarget, newTarget) : -1;
+    double newLocalScoreSum = (Terms & LOCAL_TERM) ? localScoreSum + localScoreSumIncChangeOp(sims, source, oldTarget, newTarget) : -1;
+    double newWecSum        = (Terms & WEC_TERM) ? wecSum + WECIncChangeOp(source, oldTarget, newTarget) : -1;
+    double newMS3Numer      = (Terms & MS3_TERM) ? MS3Numer + MS3IncChangeOp(source, oldTarget, newTarget) : -1;
+
+    double newCurrentScore;
+    if (kernelAccept<Terms>(newAligEdges, newInducedEdges, newLocalScoreSum, newWecSum, newMS3Numer, newCurrentScore)) {
+        (*A)[source]                   = newTarget;
+        unassignedPool[newTargetIndex] = oldTarget;
+        (*assignedNodesG2)[oldTarget]  = false;
+        (*assignedNodesG2)[newTarget]  = true;
+        if (alig) aligEdges = newAligEdges;
+        if (induced) inducedEdges = newInducedEdges;
+        if (Terms & LOCAL_TERM) localScoreSum = newLocalScoreSum;
+        if (Terms & WEC_TERM) wecSum = newWecSum;
+        if (Terms & MS3_TERM) MS3Numer = newMS3Numer;
+        currentScore = newCurrentScore;
+    } else if (Terms & MS3_TERM) {
+        MultiS3::totalDegrees[oldTarget] = oldOldTargetDeg;
+        MultiS3::totalDegrees[newTarget] = oldNewTargetDeg;
+        MultiS3::denom = oldMs3Denom;
+    }
+}
+
+template<uint Terms>
+void SANA::kernelSwap() {
+    const bool alig = Terms & (EC_TERM | S3_TERM | ICS_TERM);
+    uint source1 = G1RandomUnlockedNode();
+    uint source2 = G1RandomUnlockedNode(source1);
+    uint target1 = (*A)[source1], target2 = (*A)[source2];
+    unsigned oldTarget1Deg = 0, oldTarget2Deg = 0, oldMs3Denom = 0;
+    if (Terms & MS3_TERM) {
+        oldTarget1Deg = MultiS3::totalDegrees[target1];
+        oldTarget2Deg = MultiS3::totalDegrees[target2];
+        oldMs3Denom   = MultiS3::denom;
+    }
+
+    int newAligEdges        = alig ? aligEdges + aligEdgesIncSwapOp(source1, source2, target1, target2) : -1;
+    double newLocalScoreSum = (Terms & LOCAL_TERM) ? localScoreSum + localScoreSumIncSwapOp(sims, source1, source2, target1, target2) : -1;
+    double newWecSum        = (Terms & WEC_TERM) ? wecSum + WECIncSwapOp(source1, source2, target1, target2) : -1;
+    double newMS3Numer      = (Terms & MS3_TERM) ? MS3Numer + MS3IncSwapOp(source1, source2, target1, target2) : -1;
+
+    //a swap keeps the set of aligned G2 nodes, so the induced edges do not
+    //change; like performSwap, it is scored with the current MS3 numerator
+    double newCurrentScore;
+    if (kernelAccept<Terms>(newAligEdges, inducedEdges, newLocalScoreSum, newWecSum, MS3Numer, newCurrentScore)) {
+        (*A)[source1] = target2;
+        (*A)[source2] = target1;
+        if (alig) aligEdges = newAligEdges;
+        if (Terms & LOCAL_TERM) localScoreSum = newLocalScoreSum;
+        if (Terms & WEC_TERM) wecSum = newWecSum;
+        if (Terms & MS3_TERM) MS3Numer = newMS3Numer;
+        currentScore = newCurrentScore;
+    } else if (Terms & MS3_TERM) {
+        MultiS3::totalDegrees[target1] = oldTarget1Deg;
+        MultiS3::totalDegrees[target2] = oldTarget2Deg;
+        MultiS3::denom = oldMs3Denom;
+    }
+}
+
+//Score::sum restricted to Terms, adding them in the same order as
+//scoreComparison so that both paths accept exactly the same moves
+template<uint Terms>
+inline bool SANA::kernelAccept(double newAligEdges, double newInducedEdges, double newLocalScoreSum,
+        double newWecSum, double newMS3Numer, double& newCurrentScore) {
+    newCurrentScore = 0;
+    if (Terms & EC_TERM)    newCurrentScore += ecWeight * (newAligEdges / g1Edges);
+    if (Terms & S3_TERM)    newCurrentScore += s3Weight * (newAligEdges / (g1Edges + newInducedEdges - newAligEdges));
+    if (Terms & ICS_TERM)   newCurrentScore += icsWeight * (newAligEdges / newInducedEdges);
+    if (Terms & LOCAL_TERM) newCurrentScore += localWeight * (newLocalScoreSum / n1);
+    if (Terms & WEC_TERM)   newCurrentScore += wecWeight * (newWecSum / (2 * g1Edges));
+#ifdef MULTI_PAIRWISE
+    if (Terms & MS3_TERM)   newCurrentScore += ms3Weight * ((newMS3Numer / MultiS3::denom) / NUM_GRAPHS);
+#endif
+    energyInc = newCurrentScore - currentScore;
+    wasBadMove = energyInc < 0;
+    if (not wasBadMove) return true;
+    double badProbability;
+    bool makeChange = acceptBadMove(energyInc, badProbability);
+    sampleBadProbability(badProbability);
+    return makeChange;
+}
+
+double SANA::sumScore(double newAligEdges, double newInducedEdges, double newTCSum, double newLocalScoreSum, double newWecSum, double newNcSum, double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer, double newEdgeDifferenceSum, double newMS3Numer, double newSpcSum) const {
+    double newCurrentScore = 0;
+    newCurrentScore += ecWeight * (newAligEdges / g1Edges);
+    newCurrentScore += edWeight * EdgeDifference::adjustSumToTargetScore(newEdgeDifferenceSum, pairsCount);
+    newCurrentScore += s3Weight * (newAligEdges / (g1Edges + newInducedEdges - newAligEdges));
+    newCurrentScore += icsWeight * (newAligEdges / newInducedEdges);
+    newCurrentScore += secWeight * (newAligEdges / g1Edges + newAligEdges / g2Edges)*0.5;
+    newCurrentScore += TCWeight * (newTCSum);
+    newCurrentScore += localWeight * (newLocalScoreSum / n1);
+    newCurrentScore += wecWeight * (newWecSum / (2 * g1Edges));
+    newCurrentScore += ewecWeight * (newEwecSum);
+    newCurrentScore += ncWeight * (newNcSum / trueA.back());
+    if (needSpc) newCurrentScore += spcWeight * spc->adjustSumToTargetScore(newSpcSum);
+#ifdef MULTI_PAIRWISE
+    newCurrentScore += mecWeight * (newAligEdges / (g1WeightedEdges + g2WeightedEdges));
+    newCurrentScore += sesWeight * newSquaredAligEdges / SquaredEdgeScore::getDenom();
+    newCurrentScore += eeWeight * (1 - (newExposedEdgesNumer / (double)EdgeExposure::getDenom()));
+    newCurrentScore += ms3Weight * ((newMS3Numer / MultiS3::denom) / NUM_GRAPHS);
+#endif
+    return newCurrentScore;
+}
+
 int SANA::aligEdgesIncChangeOp(uint source, uint oldTarget, uint newTarget) {
     int res = 0;
 
     bool selfLoopAtSource, selfLoopAtOldTarget, selfLoopAtNewTarget;
-#ifdef SPARSE
-    selfLoopAtSource = G1->hasSelfLoop(source);
-    selfLoopAtOldTarget = G2->hasSelfLoop(oldTarget);
-    selfLoopAtNewTarget = G2->hasSelfLoop(newTarget);
-#else
-    selfLoopAtSource = G1Matrix[source][source];
-    selfLoopAtOldTarget = G2Matrix[oldTarget][oldTarget];
-    selfLoopAtNewTarget = G2Matrix[newTarget][newTarget];
-#endif
+    selfLoopAtSource = G1Matrix.get(source, source);
+    selfLoopAtOldTarget = G2Matrix.get(oldTarget, oldTarget);
+    selfLoopAtNewTarget = G2Matrix.get(newTarget, newTarget);
 
     const vector<uint>& v = G1AdjLists[source];
     if(selfLoopAtSource) {
@@ -1673,8 +1851,8 @@ int SANA::aligEdgesIncChangeOp(uint source, uint oldTarget, uint newTarget) {
         if (selfLoopAtNewTarget) res++;
     }
     for (uint neighbor : v) if(neighbor != source) {
-        res -= G2Matrix[oldTarget][(*A)[neighbor]];
-        res += G2Matrix[newTarget][(*A)[neighbor]];
+        res -= G2Matrix.get(oldTarget, (*A)[neighbor]);
+        res += G2Matrix.get(newTarget, (*A)[neighbor]);
     }
     return res;
 }
@@ -1683,17 +1861,10 @@ int SANA::aligEdgesIncSwapOp(uint source1, uint source2, uint target1, uint targ
     int res = 0;
 
     bool selfLoopAtSource1, selfLoopAtSource2, selfLoopAtTarget1, selfLoopAtTarget2;
-#ifdef SPARSE
-    selfLoopAtSource1 = G1->hasSelfLoop(source1);
-    selfLoopAtSource2 = G1->hasSelfLoop(source2);
-    selfLoopAtTarget1 = G2->hasSelfLoop(target1);
-    selfLoopAtTarget2 = G2->hasSelfLoop(target2);
-#else
-    selfLoopAtSource1 = G1Matrix[source1][source1];
-    selfLoopAtSource2 = G1Matrix[source2][source2];
-    selfLoopAtTarget1 = G2Matrix[target1][target1];
-    selfLoopAtTarget2 = G2Matrix[target2][target2];
-#endif
+    selfLoopAtSource1 = G1Matrix.get(source1, source1);
+    selfLoopAtSource2 = G1Matrix.get(source2, source2);
+    selfLoopAtTarget1 = G2Matrix.get(target1, target1);
+    selfLoopAtTarget2 = G2Matrix.get(target2, target2);
 
     const vector<uint>& v1 = G1AdjLists[source1];
     if(selfLoopAtSource1) {
@@ -1701,8 +1872,8 @@ int SANA::aligEdgesIncSwapOp(uint source1, uint source2, uint target1, uint targ
         if (selfLoopAtTarget2) res++;
     }
     for(uint neighbor : v1) if(neighbor != source1) {
-        res -= G2Matrix[target1][(*A)[neighbor]];
-        res += G2Matrix[target2][(*A)[neighbor]];
+        res -= G2Matrix.get(target1, (*A)[neighbor]);
+        res += G2Matrix.get(target2, (*A)[neighbor]);
     }
 
     const vector<uint>& v2 = G1AdjLists[source2];
@@ -1711,13 +1882,13 @@ int SANA::aligEdgesIncSwapOp(uint source1, uint source2, uint target1, uint targ
         if (selfLoopAtTarget1) res++;
     }
     for(uint neighbor : v2) if(neighbor != source2) {
-        res -= G2Matrix[target2][(*A)[neighbor]];
-        res += G2Matrix[target1][(*A)[neighbor]];
+        res -= G2Matrix.get(target2, (*A)[neighbor]);
+        res += G2Matrix.get(target1, (*A)[neighbor]);
     }
 #ifdef MULTI_PAIRWISE
-    res += (-1 << 1) & (G1Matrix[source1][source2] + G2Matrix[target1][target2]);
+    res += (-1 << 1) & (G1Matrix.get(source1, source2) + G2Matrix.get(target1, target2));
 #else
-    res += 2 * (G1Matrix[source1][source2] & G2Matrix[target1][target2]);
+    res += 2 * (G1Matrix.get(source1, source2) & G2Matrix.get(target1, target2));
 #endif
     return res;
 }
@@ -1743,7 +1914,7 @@ double SANA::edgeDifferenceIncSwapOp(uint source1, uint source2, uint target1, u
     double edgeDifferenceIncDiff = 0;
     double c = 0;
     for (uint node2 = 0; node2 < n1; ++node2) {
-        double y = -abs(G1FloatWeights[source1][node2] - G2FloatWeights[target1][(*A)[node2]])
+        double y = -abs(G1FloatWeights.get(source1, node2) - G2FloatWeights.get(target1, (*A)[node2]))
                   - c;
         double t = edgeDifferenceIncDiff + y;
         c = (t - edgeDifferenceIncDiff) - y;
@@ -1757,7 +1928,7 @@ double SANA::edgeDifferenceIncSwapOp(uint source1, uint source2, uint target1, u
         } else {
             node2Target = (*A)[node2];
         }
-        y = +abs(G1FloatWeights[source1][node2] - G2FloatWeights[target2][node2Target])
+        y = +abs(G1FloatWeights.get(source1, node2) - G2FloatWeights.get(target2, node2Target))
            - c;
         t = edgeDifferenceIncDiff + y;
         c = (t - edgeDifferenceIncDiff) - y;
@@ -1768,7 +1939,7 @@ double SANA::edgeDifferenceIncSwapOp(uint source1, uint source2, uint target1, u
     // Add source2-target1
     for (uint node2 = 0; node2 < n1; ++node2) {
         if (node2 == source1) continue;
-        double y = -abs(G1FloatWeights[source2][node2] - G2FloatWeights[target2][(*A)[node2]])
+        double y = -abs(G1FloatWeights.get(source2, node2) - G2FloatWeights.get(target2, (*A)[node2]))
                   - c;
         double t = edgeDifferenceIncDiff + y;
         c = (t - edgeDifferenceIncDiff) - y;
@@ -1780,7 +1951,7 @@ double SANA::edgeDifferenceIncSwapOp(uint source1, uint source2, uint target1, u
         } else {
             node2Target = (*A)[node2];
         }
-        y = +abs(G1FloatWeights[source2][node2] - G2FloatWeights[target1][node2Target])
+        y = +abs(G1FloatWeights.get(source2, node2) - G2FloatWeights.get(target1, node2Target))
            - c;
         t = edgeDifferenceIncDiff + y;
         c = (t - edgeDifferenceIncDiff) - y;
@@ -1795,14 +1966,14 @@ double SANA::edgeDifferenceIncChangeOp(uint source, uint oldTarget, uint newTarg
    double edgeDifferenceIncDiff = 0;
    double c = 0;
    for (uint node2 = 0; node2 < n1; ++node2) {
-       double y = -abs(G1FloatWeights[source][node2] - G2FloatWeights[oldTarget][(*A)[node2]])
+       double y = -abs(G1FloatWeights.get(source, node2) - G2FloatWeights.get(oldTarget, (*A)[node2]))
                   - c;
        double t = edgeDifferenceIncDiff + y;
        c = (t - edgeDifferenceIncDiff) - y;
        edgeDifferenceIncDiff = t;
 
        uint node2Target = node2 == source ? newTarget : (*A)[node2];
-       y = +abs(G1FloatWeights[source][node2] - G2FloatWeights[newTarget][node2Target])
+       y = +abs(G1FloatWeights.get(source, node2) - G2FloatWeights.get(newTarget, node2Target))
                   - c;
        t = edgeDifferenceIncDiff + y;
        c = (t - edgeDifferenceIncDiff) - y;
@@ -1816,7 +1987,7 @@ double SANA::edgeDifferenceIncChangeOp(uint source, uint oldTarget, uint newTarg
 
 
 
-static int _edgeVal;
+static thread_local int _edgeVal;
 // UGLY GORY HACK BELOW!! Sometimes the edgeVal is crazily wrong, like way above 1,000, when it
 // cannot possibly be greater than the number of networks we're aligning when MULTI_PAIRWISE is on.
 // It happens only rarely, so here I ask if the edgeVal is less than 1,000; if it's less than 1,000
@@ -1825,7 +1996,7 @@ static int _edgeVal;
 // between the value of this ladder and the ladder with one edge added or removed.  Mathematically
 // it should be edgeVal^2 - (edgeVal+1)^2 which is (2e + 1), but for some reason I had to make
 // it 2*(e+1).  That seemed to work better.  So yeah... big ugly hack.
-#define SQRDIFF(i,j) ((_edgeVal=G2Matrix[i][(*A)[j]]), 2*((_edgeVal<1000?_edgeVal:0) + 1))
+#define SQRDIFF(i,j) ((_edgeVal=G2Matrix.get(i, (*A)[j])), 2*((_edgeVal<1000?_edgeVal:0) + 1))
 int SANA::squaredAligEdgesIncChangeOp(uint source, uint oldTarget, uint newTarget) {
     int res = 0, diff;
     uint neighbor;
@@ -1869,7 +2040,7 @@ int SANA::squaredAligEdgesIncSwapOp(uint source1, uint source2, uint target1, ui
     }
     // How to do for squared?
     // address case swapping between adjacent nodes with adjacent images:
-    if(G1Matrix[source1][source2] and G2Matrix[target1][target2])
+    if(G1Matrix.get(source1, source2) and G2Matrix.get(target1, target2))
     {
         res += 2 * SQRDIFF(target1,source2);
     }
@@ -1882,11 +2053,11 @@ int SANA::exposedEdgesIncChangeOp(uint source, uint oldTarget, uint newTarget) {
     const uint n = G1AdjLists[source].size();
     for (uint i = 0; i < n; ++i) {
         neighbor = G1AdjLists[source][i];
-		if (G2Matrix[oldTarget][(*A)[neighbor]] == 0)
+		if (G2Matrix.get(oldTarget, (*A)[neighbor]) == 0)
 		{
 			--ret;
 		}
-		if (!G2Matrix[newTarget][(*A)[neighbor]])
+		if (!G2Matrix.get(newTarget, (*A)[neighbor]))
 		{
 			++ret;
 		}
@@ -1901,11 +2072,11 @@ int SANA::exposedEdgesIncChangeOp(Job &job, uint source, uint oldTarget, uint ne
     const uint n = G1AdjLists[source].size();
     for (uint i = 0; i < n; ++i) {
         neighbor = G1AdjLists[source][i];
-		if (G2Matrix[oldTarget][(*A)[neighbor]] == 0)
+		if (G2Matrix.get(oldTarget, (*A)[neighbor]) == 0)
 		{
 			--ret;
 		}
-		if (!G2Matrix[newTarget][(*A)[neighbor]])
+		if (!G2Matrix.get(newTarget, (*A)[neighbor]))
 		{
 			++ret;
 		}
@@ -1920,11 +2091,11 @@ int SANA::exposedEdgesIncSwapOp(uint source1, uint source2, uint target1, uint t
     uint i = 0;
     for (; i < n; ++i) {
         neighbor = G1AdjLists[source1][i];
-        if (G2Matrix[target1][(*A)[neighbor]] == 0)
+        if (G2Matrix.get(target1, (*A)[neighbor]) == 0)
 		{
 			--ret;
 		}
-		if (!G2Matrix[target2][(*A)[neighbor]])
+		if (!G2Matrix.get(target2, (*A)[neighbor]))
 		{
 			++ret;
 		}
@@ -1932,11 +2103,11 @@ int SANA::exposedEdgesIncSwapOp(uint source1, uint source2, uint target1, uint t
     const uint m = G1AdjLists[source2].size();
     for (i = 0; i < m; ++i) {
         neighbor = G1AdjLists[source2][i];
-        if (G2Matrix[target2][(*A)[neighbor]] == 0)
+        if (G2Matrix.get(target2, (*A)[neighbor]) == 0)
 		{
 			--ret;
 		}
-		if (!G2Matrix[target1][(*A)[neighbor]])
+		if (!G2Matrix.get(target1, (*A)[neighbor]))
 		{
 			++ret;
 		}
@@ -1952,11 +2123,11 @@ int SANA::exposedEdgesIncSwapOp(Job &job, uint source1, uint source2, uint targe
     uint i = 0;
     for (; i < n; ++i) {
 		neighbor = G1AdjLists[source1][i];
-        if (G2Matrix[target1][(*A)[neighbor]] == 1)
+        if (G2Matrix.get(target1, (*A)[neighbor]) == 1)
 		{
 			--ret;
 		}
-		if (!G2Matrix[target2][(*A)[neighbor]])
+		if (!G2Matrix.get(target2, (*A)[neighbor]))
 		{
 			++ret;
 		}
@@ -1964,11 +2135,11 @@ int SANA::exposedEdgesIncSwapOp(Job &job, uint source1, uint source2, uint targe
     const uint m = G1AdjLists[source2].size();
     for (i = 0; i < m; ++i) {
 		neighbor = G1AdjLists[source2][i];
-        if (G2Matrix[target2][(*A)[neighbor]] == 1)
+        if (G2Matrix.get(target2, (*A)[neighbor]) == 1)
 		{
 			--ret;
 		}
-		if (!G2Matrix[target1][(*A)[neighbor]])
+		if (!G2Matrix.get(target1, (*A)[neighbor]))
 		{
 			++ret;
 		}
@@ -1982,15 +2153,9 @@ int SANA::MS3IncChangeOp(uint source, uint oldTarget, uint newTarget) {
     unsigned oldNewTargetDeg = MultiS3::totalDegrees[newTarget];
 
     bool selfLoopAtSource, selfLoopAtOldTarget, selfLoopAtNewTarget;
-#ifdef SPARSE
-    selfLoopAtSource = G1->hasSelfLoop(source);
-    selfLoopAtOldTarget = G2->hasSelfLoop(oldTarget);
-    selfLoopAtNewTarget = G2->hasSelfLoop(newTarget);
-#else
-    selfLoopAtSource = G1Matrix[source][source];
-    selfLoopAtOldTarget = G2Matrix[oldTarget][oldTarget];
-    selfLoopAtNewTarget = G2Matrix[newTarget][newTarget];
-#endif
+    selfLoopAtSource = G1Matrix.get(source, source);
+    selfLoopAtOldTarget = G2Matrix.get(oldTarget, oldTarget);
+    selfLoopAtNewTarget = G2Matrix.get(newTarget, newTarget);
 
     const vector<uint>& neighbors = G1AdjLists[source];
     
@@ -2012,8 +2177,8 @@ int SANA::MS3IncChangeOp(uint source, uint oldTarget, uint newTarget) {
         {
             --MultiS3::totalDegrees[oldTarget];
             ++MultiS3::totalDegrees[newTarget];
-            ret -= G2Matrix[oldTarget][(*A)[neighbor]];
-            ret += G2Matrix[newTarget][(*A)[neighbor]];
+            ret -= G2Matrix.get(oldTarget, (*A)[neighbor]);
+            ret += G2Matrix.get(newTarget, (*A)[neighbor]);
         }
     }
     
@@ -2036,17 +2201,10 @@ int SANA::MS3IncSwapOp(uint source1, uint source2, uint target1, uint target2) {
     unsigned oldTarget2Deg = MultiS3::totalDegrees[target2];
     
     bool selfLoopAtSource1, selfLoopAtSource2, selfLoopAtTarget1, selfLoopAtTarget2;
-#ifdef SPARSE
-    selfLoopAtSource1 = G1->hasSelfLoop(source1);
-    selfLoopAtSource2 = G1->hasSelfLoop(source2);
-    selfLoopAtTarget1 = G2->hasSelfLoop(target1);
-    selfLoopAtTarget2 = G2->hasSelfLoop(target2);
-#else
-    selfLoopAtSource1 = G1Matrix[source1][source1];
-    selfLoopAtSource2 = G1Matrix[source2][source2];
-    selfLoopAtTarget1 = G2Matrix[target1][target1];
-    selfLoopAtTarget2 = G2Matrix[target2][target2];
-#endif
+    selfLoopAtSource1 = G1Matrix.get(source1, source1);
+    selfLoopAtSource2 = G1Matrix.get(source2, source2);
+    selfLoopAtTarget1 = G2Matrix.get(target1, target1);
+    selfLoopAtTarget2 = G2Matrix.get(target2, target2);
 
     const vector<uint>& neighbors1 = G1AdjLists[source1];
     const vector<uint>& neighbors2 = G1AdjLists[source2];
@@ -2081,8 +2239,8 @@ int SANA::MS3IncSwapOp(uint source1, uint source2, uint target1, uint target2) {
         {
             --MultiS3::totalDegrees[target1];
             ++MultiS3::totalDegrees[target2];
-            ret -= G2Matrix[target1][(*A)[neighbor]];
-            ret += G2Matrix[target2][(*A)[neighbor]];
+            ret -= G2Matrix.get(target1, (*A)[neighbor]);
+            ret += G2Matrix.get(target2, (*A)[neighbor]);
         }
     }
     
@@ -2092,8 +2250,8 @@ int SANA::MS3IncSwapOp(uint source1, uint source2, uint target1, uint target2) {
         {
             --MultiS3::totalDegrees[target2];
             ++MultiS3::totalDegrees[target1];
-            ret -= G2Matrix[target2][(*A)[neighbor]];
-            ret += G2Matrix[target1][(*A)[neighbor]];
+            ret -= G2Matrix.get(target2, (*A)[neighbor]);
+            ret += G2Matrix.get(target1, (*A)[neighbor]);
         }
     }
     
@@ -2125,15 +2283,15 @@ int SANA::inducedEdgesIncChangeOp(uint source, uint oldTarget, uint newTarget) {
         res += (*assignedNodesG2)[neighbor];
     }
     //address case changing between adjacent nodes:
-    res -= G2Matrix[oldTarget][newTarget];
+    res -= G2Matrix.get(oldTarget, newTarget);
     return res;
 }
 
-double SANA::localScoreSumIncChangeOp(vector<vector<float> > const & sim, uint const & source, uint const & oldTarget, uint const & newTarget) {
+double SANA::localScoreSumIncChangeOp(SimMatrix const & sim, uint const & source, uint const & oldTarget, uint const & newTarget) {
     return sim[source][newTarget] - sim[source][oldTarget];
 }
 
-double SANA::localScoreSumIncSwapOp(vector<vector<float> > const & sim, uint const & source1, uint const & source2, uint const & target1, uint const & target2) {
+double SANA::localScoreSumIncSwapOp(SimMatrix const & sim, uint const & source1, uint const & source2, uint const & target1, uint const & target2) {
     return sim[source1][target2] - sim[source1][target1] + sim[source2][target1] - sim[source2][target2];
 }
 
@@ -2143,11 +2301,11 @@ double SANA::WECIncChangeOp(uint source, uint oldTarget, uint newTarget) {
     uint neighbor;
     for (uint j = 0; j < n; ++j) {
         neighbor = G1AdjLists[source][j];
-        if (G2Matrix[oldTarget][(*A)[neighbor]]) {
+        if (G2Matrix.get(oldTarget, (*A)[neighbor])) {
             res -= wecSims[source][oldTarget];
             res -= wecSims[neighbor][(*A)[neighbor]];
         }
-        if (G2Matrix[newTarget][(*A)[neighbor]]) {
+        if (G2Matrix.get(newTarget, (*A)[neighbor])) {
             res += wecSims[source][newTarget];
             res += wecSims[neighbor][(*A)[neighbor]];
         }
@@ -2161,11 +2319,11 @@ double SANA::WECIncSwapOp(uint source1, uint source2, uint target1, uint target2
     uint neighbor;
     for (uint j = 0; j < n; ++j) {
         neighbor = G1AdjLists[source1][j];
-        if (G2Matrix[target1][(*A)[neighbor]]) {
+        if (G2Matrix.get(target1, (*A)[neighbor])) {
             res -= wecSims[source1][target1];
             res -= wecSims[neighbor][(*A)[neighbor]];
         }
-        if (G2Matrix[target2][(*A)[neighbor]]) {
+        if (G2Matrix.get(target2, (*A)[neighbor])) {
             res += wecSims[source1][target2];
             res += wecSims[neighbor][(*A)[neighbor]];
         }
@@ -2173,20 +2331,20 @@ double SANA::WECIncSwapOp(uint source1, uint source2, uint target1, uint target2
     const uint m = G1AdjLists[source2].size();
     for (uint j = 0; j < m; ++j) {
         neighbor = G1AdjLists[source2][j];
-        if (G2Matrix[target2][(*A)[neighbor]]) {
+        if (G2Matrix.get(target2, (*A)[neighbor])) {
             res -= wecSims[source2][target2];
             res -= wecSims[neighbor][(*A)[neighbor]];
         }
-        if (G2Matrix[target1][(*A)[neighbor]]) {
+        if (G2Matrix.get(target1, (*A)[neighbor])) {
             res += wecSims[source2][target1];
             res += wecSims[neighbor][(*A)[neighbor]];
         }
     }
     //address case swapping between adjacent nodes with adjacent images:
 #ifdef MULTI_PAIRWISE
-    if (G1Matrix[source1][source2] > 0 and G2Matrix[target1][target2] > 0) {
+    if (G1Matrix.get(source1, source2) > 0 and G2Matrix.get(target1, target2) > 0) {
 #else
-    if (G1Matrix[source1][source2] and G2Matrix[target1][target2]) {
+    if (G1Matrix.get(source1, source2) and G2Matrix.get(target1, target2)) {
 #endif
         res += 2*wecSims[source1][target1];
         res += 2*wecSims[source2][target2];
@@ -2203,7 +2361,7 @@ double SANA::EWECIncChangeOp(uint source, uint oldTarget, uint newTarget){
 double SANA::EWECIncSwapOp(uint source1, uint source2, uint target1, uint target2){
     double score = 0;
     score = (EWECSimCombo(source1, target2)) + (EWECSimCombo(source2, target1)) - (EWECSimCombo(source1, target1)) - (EWECSimCombo(source2, target2));
-    if(G1Matrix[source1][source2] and G2Matrix[target1][target2]){
+    if(G1Matrix.get(source1, source2) and G2Matrix.get(target1, target2)){
         score += ewec->getScore(ewec->getColIndex(target1, target2), ewec->getRowIndex(source1, source2))/(g1Edges); //correcting for missed edges when swapping 2 adjacent pairs
     }
     return score;
@@ -2215,7 +2373,7 @@ double SANA::EWECSimCombo(uint source, uint target){
     uint neighbor;
     for (uint i = 0; i < n; ++i) {
         neighbor = G1AdjLists[source][i];
-        if (G2Matrix[target][(*A)[neighbor]]) {
+        if (G2Matrix.get(target, (*A)[neighbor])) {
             int e1 = ewec->getRowIndex(source, neighbor);
             int e2 = ewec->getColIndex(target, (*A)[neighbor]);
             score+=ewec->getScore(e2,e1);
@@ -2232,14 +2390,14 @@ double SANA::TCIncChangeOp(uint source, uint oldTarget, uint newTarget){
         for(uint j = i+1; j < n; ++j){
             neighbor1 = G1AdjLists[source][i];
             neighbor2 = G1AdjLists[source][j];
-            if(G1Matrix[neighbor1][neighbor2]){
+            if(G1Matrix.get(neighbor1, neighbor2)){
                 //G1 has a triangle
-                if(G2Matrix[oldTarget][(*A)[neighbor1]] and G2Matrix[oldTarget][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]]){
+                if(G2Matrix.get(oldTarget, (*A)[neighbor1]) and G2Matrix.get(oldTarget, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2])){
                     //G2 HAD a triangle
                     deltaTriangles -= 1;
                 }
 
-                if(G2Matrix[newTarget][(*A)[neighbor1]] and G2Matrix[newTarget][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]]){
+                if(G2Matrix.get(newTarget, (*A)[neighbor1]) and G2Matrix.get(newTarget, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2])){
                     //G2 GAINS a triangle
                     deltaTriangles += 1;
                 }
@@ -2257,16 +2415,16 @@ double SANA::TCIncSwapOp(uint source1, uint source2, uint target1, uint target2)
         for(uint j = i+1; j < n; ++j){
             neighbor1 = G1AdjLists[source1][i];
             neighbor2 = G1AdjLists[source1][j];
-            if(G1Matrix[neighbor1][neighbor2]){
+            if(G1Matrix.get(neighbor1, neighbor2)){
                 //G1 has a triangle
-                if(G2Matrix[target1][(*A)[neighbor1]] and G2Matrix[target1][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]]){
+                if(G2Matrix.get(target1, (*A)[neighbor1]) and G2Matrix.get(target1, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2])){
                     //G2 HAD a triangle
                     deltaTriangles -= 1;
                 }
 
-                if((G2Matrix[target2][(*A)[neighbor1]] and G2Matrix[target2][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]])
-                || (neighbor1 == source2 and G2Matrix[target2][target1] and G2Matrix[target2][(*A)[neighbor2]] and G2Matrix[target1][(*A)[neighbor2]])
-                || (neighbor2 == source2 and G2Matrix[target2][(*A)[neighbor1]] and G2Matrix[target2][target1] and G2Matrix[(*A)[neighbor1]][target1])) {
+                if((G2Matrix.get(target2, (*A)[neighbor1]) and G2Matrix.get(target2, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2]))
+                || (neighbor1 == source2 and G2Matrix.get(target2, target1) and G2Matrix.get(target2, (*A)[neighbor2]) and G2Matrix.get(target1, (*A)[neighbor2]))
+                || (neighbor2 == source2 and G2Matrix.get(target2, (*A)[neighbor1]) and G2Matrix.get(target2, target1) and G2Matrix.get((*A)[neighbor1], target1))) {
                     //G2 GAINS a triangle
                     deltaTriangles += 1;
                 }
@@ -2278,16 +2436,16 @@ double SANA::TCIncSwapOp(uint source1, uint source2, uint target1, uint target2)
         for(uint j = i+1; j < m; ++j){
             neighbor1 = G1AdjLists[source2][i];
             neighbor2 = G1AdjLists[source2][j];
-            if(G1Matrix[neighbor1][neighbor2]){
+            if(G1Matrix.get(neighbor1, neighbor2)){
                 //G1 has a triangle
-                if(G2Matrix[target2][(*A)[neighbor1]] and G2Matrix[target2][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]]){
+                if(G2Matrix.get(target2, (*A)[neighbor1]) and G2Matrix.get(target2, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2])){
                     //G2 HAD a triangle
                     deltaTriangles -= 1;
                 }
 
-                if((G2Matrix[target1][(*A)[neighbor1]] and G2Matrix[target1][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]])
-                   || (neighbor1 == source1 and G2Matrix[target1][target2] and G2Matrix[target1][(*A)[neighbor2]] and G2Matrix[target2][(*A)[neighbor2]])
-                   || (neighbor2 == source1 and G2Matrix[target1][(*A)[neighbor1]] and G2Matrix[target1][target2] and G2Matrix[(*A)[neighbor1]][target2])){
+                if((G2Matrix.get(target1, (*A)[neighbor1]) and G2Matrix.get(target1, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2]))
+                   || (neighbor1 == source1 and G2Matrix.get(target1, target2) and G2Matrix.get(target1, (*A)[neighbor2]) and G2Matrix.get(target2, (*A)[neighbor2]))
+                   || (neighbor2 == source1 and G2Matrix.get(target1, (*A)[neighbor1]) and G2Matrix.get(target1, target2) and G2Matrix.get((*A)[neighbor1], target2))){
                     //G2 GAINS a triangle
                     deltaTriangles += 1;
                 }
@@ -2298,6 +2456,42 @@ double SANA::TCIncSwapOp(uint source1, uint source2, uint target1, uint target2)
     return ((double)deltaTriangles/maxTriangles);
 }
 
+double SANA::SPCIncChangeOp(uint source, uint oldTarget, uint newTarget) {
+    const vector<uint8_t>& dist1 = spc->getDistMatrixG1();
+    const vector<uint8_t>& dist2 = spc->getDistMatrixG2();
+    const uint8_t* sourceRow = &dist1[(size_t)source*n1];
+    const uint8_t* oldRow = &dist2[(size_t)oldTarget*n2];
+    const uint8_t* newRow = &dist2[(size_t)newTarget*n2];
+    long long res = 0;
+    for (uint j = 0; j < n1; ++j) {
+        if (j == source) continue;
+        uint target = (*A)[j];
+        res += spc->pairDifference(sourceRow[j], newRow[target]);
+        res -= spc->pairDifference(sourceRow[j], oldRow[target]);
+    }
+    return res;
+}
+
+double SANA::SPCIncSwapOp(uint source1, uint source2, uint target1, uint target2) {
+    const vector<uint8_t>& dist1 = spc->getDistMatrixG1();
+    const vector<uint8_t>& dist2 = spc->getDistMatrixG2();
+    const uint8_t* source1Row = &dist1[(size_t)source1*n1];
+    const uint8_t* source2Row = &dist1[(size_t)source2*n1];
+    const uint8_t* target1Row = &dist2[(size_t)target1*n2];
+    const uint8_t* target2Row = &dist2[(size_t)target2*n2];
+    long long res = 0;
+    //the pair source1-source2 keeps the same distance in G2
+    for (uint j = 0; j < n1; ++j) {
+        if (j == source1 or j == source2) continue;
+        uint target = (*A)[j];
+        res += spc->pairDifference(source1Row[j], target2Row[target]);
+        res -= spc->pairDifference(source1Row[j], target1Row[target]);
+        res += spc->pairDifference(source2Row[j], target1Row[target]);
+        res -= spc->pairDifference(source2Row[j], target2Row[target]);
+    }
+    return res;
+}
+
 int SANA::ncIncChangeOp(uint source, uint oldTarget, uint newTarget) {
     int change = 0;
     if (trueA[source] == oldTarget) change -= 1;
@@ -2318,36 +2512,33 @@ void SANA::trackProgress(long long int i, bool end) {
     if (!enableTrackProgress) return;
     bool printDetails = false;
     bool printScores = false;
-    bool checkScores = true;
-    double fractional_time = i/(double)_maxExecutionIterations;
+    double fractional_time = i/(double)runIterations;
     double elapsedTime = timer.elapsed();
     uint iterationsElapsed = iterationsPerformed-oldIterationsPerformed;
     if(elapsedTime == 0) oldTimeElapsed = 0;
     double ips = (iterationsElapsed/(elapsedTime-oldTimeElapsed));
     oldTimeElapsed = elapsedTime;
     oldIterationsPerformed = iterationsPerformed;
+    if (scoreCheckStep > 0) checkScore(i, end);
+    double pBad = trueAcceptingProbability();
     cout << i/iterationsPerStep << " (" << 100*fractional_time << "%," << elapsedTime << "s): score = " << currentScore;
-    cout <<  " ips = " << ips << ", P(" << Temperature << ") = " << acceptingProbability(avgEnergyInc, Temperature) << ", pBad = " << trueAcceptingProbability() << endl;
-    
-    if (not (printDetails or printScores or checkScores)) return;
-    Alignment Al(*A);
-    //original one is commented out for testing sec
-    //if (printDetails) cout << " (" << Al.numAlignedEdges(*G1, *G2) << ", " << G2->numNodeInducedSubgraphEdges(*A) << ")";
-    if (printDetails)
-        cout << "Al.numAlignedEdges = " << Al.numAlignedEdges(*G1, *G2) << ", g1Edges = " <<g1Edges<< " ,g2Edges = "<<g2Edges<< endl;
-    if (printScores) {
-        SymmetricSubstructureScore S3(G1, G2);
-        EdgeCorrectness EC(G1, G2);
-        InducedConservedStructure ICS(G1, G2);
-        SymmetricEdgeCoverage SEC(G1,G2);
-        cout << "S3: " << S3.eval(Al) << "  EC: " << EC.eval(Al) << "  ICS: " << ICS.eval(Al) << "  SEC: " << SEC.eval(Al) <<endl;
-    }
-    if (checkScores) {
-        double realScore = eval(Al);
-        if (fabs(realScore-currentScore) > 0.00001) {
-            cerr << "internal error: incrementally computed score (" << currentScore;
-            cerr << ") is not correct (" << realScore << ")" << endl;
-            currentScore = realScore;
+    cout <<  " ips = " << ips << ", P(" << Temperature << ") = " << acceptingProbability(avgEnergyInc, Temperature) << ", pBad = " << pBad;
+    //the same values as key=value fields, for scripts; scoreCheckLag is the number of
+    //iterations since the snapshot of the last completed score check (-1 if none)
+    cout << " [ips=" << ips << " pBad=" << pBad << " scoreCheckLag=" << (lastCheckedIter < 0 ? -1 : i - lastCheckedIter) << "]" << endl;
+
+    if (printDetails or printScores) {
+        Alignment Al(*A);
+        //original one is commented out for testing sec
+        //if (printDetails) cout << " (" << Al.numAlignedEdges(*G1, *G2) << ", " << G2->numNodeInducedSubgraphEdges(*A) << ")";
+        if (printDetails)
+            cout << "Al.numAlignedEdges = " << Al.numAlignedEdges(*G1, *G2) << ", g1Edges = " <<g1Edges<< " ,g2Edges = "<<g2Edges<< endl;
+        if (printScores) {
+            SymmetricSubstructureScore S3(G1, G2);
+            EdgeCorrectness EC(G1, G2);
+            InducedConservedStructure ICS(G1, G2);
+            SymmetricEdgeCoverage SEC(G1,G2);
+            cout << "S3: " << S3.eval(Al) << "  EC: " << EC.eval(Al) << "  ICS: " << ICS.eval(Al) << "  SEC: " << SEC.eval(Al) <<endl;
         }
     }
     if (dynamic_tdecay) { // Code for estimating dynamic TDecay
@@ -2382,6 +2573,45 @@ void SANA::trackProgress(long long int i, bool end) {
     }
 }
 
+//Compares currentScore with evalObjective every scoreCheckStep-th progress
+//report and at the end of a run. An asynchronous check evaluates a snapshot
+//while the annealing goes on and its result is applied at a later report;
+//the end of a run waits for it and checks synchronously, and so does every
+//check with ms3 in the objective (see evalObjective).
+void SANA::checkScore(long long int i, bool end) {
+    bool due = progressSteps++ % scoreCheckStep == 0;
+    if (end or scoreCheckSync or needMS3) {
+        if (scoreVerifier) {
+            SnapshotVerifier::Result discarded;
+            scoreVerifier->wait();
+            scoreVerifier->takeResult(discarded);
+        }
+        if (due or end) applyScoreCheck({i, currentScore, evalObjective(*A)}, i);
+        return;
+    }
+    if (not scoreVerifier) {
+        scoreVerifier.reset(new SnapshotVerifier([this](const vector<uint>& mapping) {
+            return evalObjective(mapping);
+        }));
+    }
+    SnapshotVerifier::Result res;
+    if (scoreVerifier->takeResult(res)) applyScoreCheck(res, i);
+    if (due) scoreVerifier->submit(*A, currentScore, i);
+}
+
+//a drift found in a snapshot is still in currentScore, unless the snapshot
+//was taken before an earlier correction; i is the current iteration
+void SANA::applyScoreCheck(const SnapshotVerifier::Result& res, long long int i) {
+    if (res.stamp < lastCorrectionIter) return;
+    lastCheckedIter = res.stamp;
+    if (fabs(res.actual-res.expected) > 0.00001) {
+        cerr << "internal error: incrementally computed score (" << res.expected;
+        cerr << ") is not correct (" << res.actual << ")" << endl;
+        currentScore += res.actual-res.expected;
+        lastCorrectionIter = i;
+    }
+}
+
 Alignment SANA::runRestartPhases() {
     cout << "new alignments phase" << endl;
     Timer TImer;
@@ -2434,70 +2664,320 @@ uint SANA::getHighestIndex() const {
     return highestIndex;
 }
 
+//this SANA followed by count-1 new ones with the same schedule and a
+//different random stream each. The constructor only binds the networks and
+//similarity matrices, so a replica costs little more than its alignment.
+vector<SANA*> SANA::createReplicas(uint count) {
+    vector<SANA*> replicas = {this};
+    string objectiveScore = "sum"; //overwritten below
+#ifdef MULTI_PAIRWISE
+    string noStartAligName = ""; //G2 has already been pruned
+#endif
+    for (uint r = 1; r < count; r++) {
+        SANA* replica = new SANA(G1, G2, TInitial, TDecay, usingIterations ? maxIterations : minutes,
+            usingIterations, false, MC, objectiveScore
+#ifdef MULTI_PAIRWISE
+            , noStartAligName
+#endif
+            );
+        replica->score                    = score;
+        replica->TFinal                   = TFinal;
+        replica->constantTemp             = constantTemp;
+        replica->initializedIterPerSecond = initializedIterPerSecond;
+        replica->iterPerSecond            = iterPerSecond;
+        replica->iterationsPerStep        = iterationsPerStep;
+        replica->enableTrackProgress      = false;
+        replica->dynamic_tdecay           = dynamic_tdecay;
+        replica->tau                      = tau;
+        replica->SANAtime                 = SANAtime;
+        replica->scoreCheckStep           = scoreCheckStep;
+        replica->scoreCheckSync           = scoreCheckSync;
+        replica->setOutputFilenames(outputFileName, localScoresFileName);
+        replica->gen.seed(getRandomSeed() + r);
+        replicas.push_back(replica);
+    }
+    return replicas;
+}
+
+Alignment SANA::replicaRun(const Alignment& startA, double maxExecutionSeconds, long long int maxExecutionIterations,
+        long long int& iter) {
+    runIterations = maxExecutionIterations;
+    vector<SANA*> replicas = createReplicas(numReplicas);
+    for (SANA* replica : replicas) {
+        replica->runIterations       = maxExecutionIterations;
+        replica->enableTrackProgress = enableTrackProgress;
+        replica->initDataStructures(startA);
+        replica->updateTemperature(iter);
+    }
+    setInterruptSignal();
+    cout << "Running " << numReplicas << " replicas in parallel" << endl;
+
+    auto byScore = [](const SANA* a, const SANA* b) { return a->currentScore < b->currentScore; };
+    //all replicas stop at the same iteration before every exchange, so the
+    //result only depends on the seed. The leading replica reports the
+    //progress, and a dynamic TDecay follows its P(bad)
+    for (; ; ) {
+        SANA* best = *max_element(replicas.begin(), replicas.end(), byScore);
+        if (interrupt) {
+            break;
+        }
+        if (saveAlignment) {
+            best->printReport();
+        }
+        best->trackProgress(iter);
+        TDecay = best->TDecay;
+        if (iter != 0 and timer.elapsed() > maxExecutionSeconds and best->currentScore - previousScore < 0.005) {
+            break;
+        }
+        previousScore = best->currentScore;
+        if (iter > maxExecutionIterations) {
+            break;
+        }
+
+        long long int endIter = min(iter + iterationsPerStep, maxExecutionIterations + 1);
+        for (SANA* replica : replicas) {
+            replica->TDecay = TDecay;
+        }
+        parallelFor(numReplicas, numReplicas, 1, [&](uint begin, uint end, uint) {
+            for (uint r = begin; r < end; r++) replicas[r]->annealSteps(iter, endIter);
+        });
+        iter = endIter;
+
+        best = *max_element(replicas.begin(), replicas.end(), byScore);
+        SANA* worst = *min_element(replicas.begin(), replicas.end(), byScore);
+        if (worst != best) {
+            worst->copyStateFrom(*best);
+        }
+    }
+
+    SANA* best = *max_element(replicas.begin(), replicas.end(), byScore);
+    if (best != this) {
+        copyStateFrom(*best);
+    }
+    for (uint r = 1; r < numReplicas; r++) {
+        delete replicas[r];
+    }
+    trackProgress(iter, true);
+    return *A;
+}
+
+void SANA::annealSteps(long long int iter, long long int endIter) {
+    for (; iter < endIter; ++iter) {
+        updateTemperature(iter);
+        SANAIteration();
+    }
+}
+
+//the alignment and every incrementally evaluated sum; both replicas must have been initialized
+void SANA::copyStateFrom(const SANA& other) {
+    if (scoreVerifier) { //a pending check is of the alignment being replaced
+        SnapshotVerifier::Result discarded;
+        scoreVerifier->wait();
+        scoreVerifier->takeResult(discarded);
+    }
+    *A                  = *other.A;
+    *assignedNodesG2    = *other.assignedNodesG2;
+    *unassignedNodesG2  = *other.unassignedNodesG2;
+    *unassignedgenesG2  = *other.unassignedgenesG2;
+    *unassignedmiRNAsG2 = *other.unassignedmiRNAsG2;
+    aligEdges           = other.aligEdges;
+    edSum               = other.edSum;
+    squaredAligEdges    = other.squaredAligEdges;
+    exposedEdgesNumer   = other.exposedEdgesNumer;
+    MS3Numer            = other.MS3Numer;
+    inducedEdges        = other.inducedEdges;
+    TCSum               = other.TCSum;
+    localScoreSum       = other.localScoreSum;
+    wecSum              = other.wecSum;
+    ewecSum             = other.ewecSum;
+    ncSum               = other.ncSum;
+    spcSum              = other.spcSum;
+    currentScore        = other.currentScore;
+}
+
+//Score of moving source to (*G2UnassignedPools[..])[newTargetIndex] under the
+//sum objective. With apply the move is made, as performChange does on acceptance.
+double SANA::changeScore(uint source, uint newTargetIndex, bool apply) {
+    uint oldTarget = (*A)[source];
+    vector<uint>& unassignedPool = *G2UnassignedPools[G2PoolOf[oldTarget]];
+    uint newTarget = unassignedPool[newTargetIndex];
+    MoveSums sums;
+    changeSums(source, oldTarget, newTarget, sums);
+    double newCurrentScore = sumScore(sums.aligEdges, sums.inducedEdges, sums.TCSum, sums.localScoreSum, sums.wecSum, sums.ncSum, sums.ewecSum, sums.squaredAligEdges, sums.exposedEdgesNumer, sums.edSum, sums.MS3Numer, sums.spcSum);
+
+    if (apply)
+    {
+        (*A)[source]                   = newTarget;
+        unassignedPool[newTargetIndex] = oldTarget;
+        (*assignedNodesG2)[oldTarget]  = false;
+        (*assignedNodesG2)[newTarget]  = true;
+        storeSums(sums);
+        currentScore                   = newCurrentScore;
+    }
+    else if (needMS3)
+    {
+        restoreMS3(oldTarget, newTarget, sums);
+    }
+    return newCurrentScore;
+}
+
+//Score of swapping the images of source1 and source2 under the sum objective.
+//With apply the swap is made, as performSwap does on acceptance.
+double SANA::swapScore(uint source1, uint source2, bool apply) {
+    uint target1 = (*A)[source1], target2 = (*A)[source2];
+    MoveSums sums;
+    swapSums(source1, source2, target1, target2, sums);
+    //as in performSwap, MS3 is scored with the current numerator
+    double newCurrentScore = sumScore(sums.aligEdges, sums.inducedEdges, sums.TCSum, sums.localScoreSum, sums.wecSum, sums.ncSum, sums.ewecSum, sums.squaredAligEdges, sums.exposedEdgesNumer, sums.edSum, MS3Numer, sums.spcSum);
+
+    if (apply)
+    {
+        (*A)[source1] = target2;
+        (*A)[source2] = target1;
+        storeSums(sums);
+        currentScore  = newCurrentScore;
+    }
+    else if (needMS3)
+    {
+        restoreMS3(target1, target2, sums);
+    }
+    return newCurrentScore;
+}
+
+void SANA::initHillClimbing(const Alignment& startA) {
+    //the sums of the measures that are not used keep the -1 the Inc ops leave in them
+    aligEdges = inducedEdges = -1;
+    edSum = squaredAligEdges = exposedEdgesNumer = MS3Numer = -1;
+    TCSum = localScoreSum = wecSum = ewecSum = ncSum = spcSum = -1;
+    initDataStructures(startA);
+    currentScore = sumScore(aligEdges, inducedEdges, TCSum, localScoreSum, wecSum, ncSum, ewecSum, squaredAligEdges, exposedEdgesNumer, edSum, MS3Numer, spcSum);
+}
+
+bool SANA::hillClimbingStep(uint numThreads, bool firstImprovement) {
+    //a move is (source index into unLockedNodesG1, change or swap, index of the
+    //new target or of the other source); ties go to the smallest such key, so
+    //the path does not depend on the number of threads
+    struct Move {
+        double score;
+        uint a, kind, other;
+        bool before(const Move& m) const {
+            return a != m.a ? a < m.a : (kind != m.kind ? kind < m.kind : other < m.other);
+        }
+    };
+    const double MIN_IMPROVEMENT = 1e-12;
+    const uint CHANGE = 0, SWAP = 1, NONE = 2;
+    if (needMS3) numThreads = 1; //the MS3 ops update the shared degree counts
+    uint numUnlocked = unLockedNodesG1.size();
+    vector<Move> best(numThreads, {currentScore, numUnlocked, NONE, 0});
+    atomic<uint> firstFound(numUnlocked);
+    auto better = [firstImprovement](const Move& m1, const Move& m2) {
+        if (firstImprovement) return m1.before(m2);
+        return m1.score > m2.score or (m1.score == m2.score and m1.before(m2));
+    };
+
+    parallelFor(numUnlocked, numThreads, 16, [&](uint begin, uint end, uint thread) {
+        Move& mine = best[thread];
+        for (uint a = begin; a < end; a++) {
+            if (firstImprovement and a > firstFound.load()) return;
+            uint source = unLockedNodesG1[a];
+            vector<uint>& unassignedPool = *G2UnassignedPools[G2PoolOf[(*A)[source]]];
+            bool found = false;
+            auto consider = [&](double newScore, uint kind, uint other) {
+                if (newScore - currentScore <= MIN_IMPROVEMENT) return;
+                found = true;
+                Move m = {newScore, a, kind, other};
+                if (mine.kind == NONE or better(m, mine))
+                    mine = m;
+            };
+            for (uint k = 0; k < unassignedPool.size() and not (firstImprovement and found); k++) {
+                consider(changeScore(source, k, false), CHANGE, k);
+            }
+            for (uint b = a+1; b < numUnlocked and not (firstImprovement and found); b++) {
+                uint source2 = unLockedNodesG1[b];
+                if (G1PoolOf[source2] == G1PoolOf[source])
+                    consider(swapScore(source, source2, false), SWAP, b);
+            }
+            if (firstImprovement and found) {
+                uint seen = firstFound.load();
+                while (a < seen and not firstFound.compare_exchange_weak(seen, a));
+                return;
+            }
+        }
+    });
+
+    Move chosen = best[0];
+    for (const Move& m : best) {
+        if (m.kind != NONE and (chosen.kind == NONE or better(m, chosen)))
+            chosen = m;
+    }
+    if (chosen.kind == NONE) return false;
+    uint source = unLockedNodesG1[chosen.a];
+    if (chosen.kind == CHANGE) changeScore(source, chosen.other, true);
+    else swapScore(source, unLockedNodesG1[chosen.other], true);
+    return true;
+}
+
 
+//the i such that pBad(10^i) < LIMIT <= pBad(10^(i+1)), or i+1 if is_high
 double SANA::temperatureBracket(double LIMIT, bool is_high){
-	int i = 0;
-	while (true){
-		double pBadi = pForTInitial(pow(10,i));
-		double pBadi1 = pForTInitial(pow(10,i+1));
-		cout << "Testing 10 ^ " << i << " pBad = " << pBadi << endl;
-		if (pBadi < LIMIT && pBadi1 >= LIMIT){
-			break;
-		}else if (pBadi > LIMIT){
-			i--;
+	double pBad0 = pForTInitial(1);
+	cout << "Testing 10 ^ 0 pBad = " << pBad0 << endl;
+	int i;
+	if (pBad0 > LIMIT){
+		i = walkLog10Temperature(-1, -1, [LIMIT](double pBad) { return pBad < LIMIT; }, "");
+	}else{
+		i = walkLog10Temperature(1, 1, [LIMIT](double pBad) { return pBad >= LIMIT; }, "") - 1;
+	}
+	return is_high ? i+1 : i;
+}
+
+//Samples as many temperatures of the walk at once as there are cores, so on a
+//single core this is the plain one-at-a-time walk.
+double SANA::walkLog10Temperature(double start, double step, const function<bool(double)>& found,
+        const string& label){
+	uint batchSize = defaultNumThreads();
+	for (double first = start; ; first += batchSize*step){
+		vector<double> temperatures(batchSize);
+		for (uint k = 0; k < batchSize; k++){
+			temperatures[k] = pow(10, first + k*step);
 		}
-		else if(pBadi < LIMIT){
-			i++;
+		vector<double> pBads = pForTInitials(temperatures);
+		for (uint k = 0; k < batchSize; k++){
+			cout << "Testing " << label << (label == "" ? "" : " Temperature ") << "10^" << first + k*step
+				 << " pBad = " << pBads[k] << endl;
+			if (found(pBads[k])){
+				return first + k*step;
+			}
 		}
 	}
-	return is_high ? i+1 : i;
 }
 
 void SANA::findingUpperLowerTemperatureBound(double & LOG10_LOW_TEMP, double & LOG10_HIGH_TEMP){
 
-	double pBadLow = pForTInitial(pow(10,LOG10_LOW_TEMP));
-	double pBadHigh = pForTInitial(pow(10,LOG10_HIGH_TEMP));
+	vector<double> pBads = pForTInitials({pow(10,LOG10_LOW_TEMP), pow(10,LOG10_HIGH_TEMP)});
+	double pBadLow = pBads[0];
+	double pBadHigh = pBads[1];
 
 	cout << "Finding the Upper and Lower Bounds of the Temperature ... " << endl;
 
 	if (pBadLow > PBAD_LOW_TEMP_LIMIT && pBadHigh > PBAD_HIGH_TEMP_LIMIT){
 		//both need to go down
-		while(true){
-			pBadHigh = pForTInitial(pow(10,LOG10_HIGH_TEMP));
-			cout << "Testing High Temperature 10^" << LOG10_HIGH_TEMP << " pBad = " << pBadHigh << endl;
-			if (pBadHigh < PBAD_HIGH_TEMP_LIMIT)
-				break;
-			LOG10_HIGH_TEMP--;
-		}
+		LOG10_HIGH_TEMP = walkLog10Temperature(LOG10_HIGH_TEMP, -1,
+			[](double pBad) { return pBad < PBAD_HIGH_TEMP_LIMIT; }, "High");
 
 		LOG10_LOW_TEMP = LOG10_HIGH_TEMP-1; //We know that LOW TEMP HAS TO BE ATLEAST AS KNOW AS THE HIGH TEMP..Saves us extra computation!
 
-		while(true){
-			pBadLow = pForTInitial(pow(10,LOG10_LOW_TEMP));
-			cout << "Testing Low Temperature 10^" << LOG10_LOW_TEMP << " pBad = " << pBadLow << endl;
-			LOG10_LOW_TEMP--;
-			if(pBadLow < PBAD_LOW_TEMP_LIMIT)
-				break;
-		}
+		LOG10_LOW_TEMP = walkLog10Temperature(LOG10_LOW_TEMP, -1,
+			[](double pBad) { return pBad < PBAD_LOW_TEMP_LIMIT; }, "Low") - 1;
 
 	}
 	else if (pBadLow < PBAD_LOW_TEMP_LIMIT && pBadHigh < PBAD_HIGH_TEMP_LIMIT){
 		//both need to go up
-		while(true){
-			pBadLow = pForTInitial(pow(10,LOG10_LOW_TEMP));
-			cout << "Testing Low Temperature 10^" << LOG10_LOW_TEMP << " pBad = " << pBadLow << endl;
-			if(pBadLow > PBAD_LOW_TEMP_LIMIT)
-				break;
-			LOG10_LOW_TEMP++;
-		}
+		LOG10_LOW_TEMP = walkLog10Temperature(LOG10_LOW_TEMP, 1,
+			[](double pBad) { return pBad > PBAD_LOW_TEMP_LIMIT; }, "Low");
 		LOG10_HIGH_TEMP = LOG10_LOW_TEMP+1; //We know that LOW TEMP HAS TO BE ATLEAST AS KNOW AS THE HIGH TEMP..Saves us extra computation!
-		while(true){
-			pBadHigh = pForTInitial(pow(10,LOG10_HIGH_TEMP));
-			cout << "Testing High Temperature 10^" << LOG10_HIGH_TEMP << " pBad = " << pBadHigh << endl;
-			LOG10_HIGH_TEMP++;
-			if (pBadHigh > PBAD_HIGH_TEMP_LIMIT)
-				break;
-		}
+		LOG10_HIGH_TEMP = walkLog10Temperature(LOG10_HIGH_TEMP, 1,
+			[](double pBad) { return pBad > PBAD_HIGH_TEMP_LIMIT; }, "High") + 1;
 	}
 	else{ //We have to go both ways to see how much high the HIGH_TEMP needs to go, and how much low the LOW_TEMP needs to go
 		LOG10_HIGH_TEMP = temperatureBracket(PBAD_HIGH_TEMP_LIMIT, true);
@@ -2533,53 +3013,81 @@ void SANA::searchTemperaturesByLinearRegression() {
     int T_i;
     double log_temp;
 
+    vector<double> sweep;
 	for(T_i = 0; T_i <= LOG10_NUM_STEPS; T_i++){
 	log_temp = LOG10_LOW_TEMP + T_i*(LOG10_HIGH_TEMP-LOG10_LOW_TEMP)/LOG10_NUM_STEPS;
-        pbadMap[log_temp] = pForTInitial(pow(10, log_temp));
-        cout << T_i << " temperature: " << pow(10, log_temp) << " pBad: " << pbadMap[log_temp] << " score: " << eval(*A) << endl;
+        sweep.push_back(pow(10, log_temp));
+    }
+    vector<double> sweepPBads = pForTInitials(sweep);
+	for(T_i = 0; T_i <= LOG10_NUM_STEPS; T_i++){
+	log_temp = LOG10_LOW_TEMP + T_i*(LOG10_HIGH_TEMP-LOG10_LOW_TEMP)/LOG10_NUM_STEPS;
+        pbadMap[log_temp] = sweepPBads[T_i];
+        cout << T_i << " temperature: " << sweep[T_i] << " pBad: " << pbadMap[log_temp] << endl;
     }
     for (T_i=0; T_i <= LOG10_NUM_STEPS; T_i++){
 	log_temp = LOG10_LOW_TEMP + T_i*(LOG10_HIGH_TEMP-LOG10_LOW_TEMP)/LOG10_NUM_STEPS;
         if(pbadMap[log_temp] > FinalPBad)
             break;
     }
-    double binarySearchLeftEnd = LOG10_LOW_TEMP + (T_i-1)*(LOG10_HIGH_TEMP-LOG10_LOW_TEMP)/LOG10_NUM_STEPS;
-    double binarySearchRightEnd = log_temp;
-    double mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
-    cout << "Increasing sample density near tFinal. " << "left bound: " << pow(10, binarySearchLeftEnd) << ", right bound: " << pow(10, binarySearchRightEnd) << endl;
-    for(int j = 0; j < 4; ++j){
-        double temperature = pow(10, mid);
-        double probability = pForTInitial(temperature);
-        pbadMap[mid] = probability;
-        cout << "Temperature: " << temperature << " pbad: " << probability << " score: " << eval(*A) << endl;
-        if(probability > FinalPBad){
-            binarySearchRightEnd = mid;
-            mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
-        } else if(probability < FinalPBad/10){
-            binarySearchLeftEnd = mid;
-            mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
-        }
-    }
+    //the pBads near tFinal and near tInitial should fall in [low, high]
+    struct Bracket {
+        string name;
+        double left, right, low, high;
+        double resolution; //stop once the bracket is 1/16 of its width, like 4 bisection steps
+    };
+    vector<Bracket> brackets;
+    brackets.push_back({"tFinal", LOG10_LOW_TEMP + (T_i-1)*(LOG10_HIGH_TEMP-LOG10_LOW_TEMP)/LOG10_NUM_STEPS, log_temp,
+        FinalPBad/10, FinalPBad, 16});
     for (T_i = LOG10_NUM_STEPS; T_i >= 0; T_i--){
 	log_temp = LOG10_LOW_TEMP + T_i*(LOG10_HIGH_TEMP-LOG10_LOW_TEMP)/LOG10_NUM_STEPS;
         if(pbadMap[log_temp] < InitialPBad)
             break;
     }
-    binarySearchLeftEnd = log_temp;
-    binarySearchRightEnd = LOG10_LOW_TEMP + (T_i+1)*(LOG10_HIGH_TEMP-LOG10_LOW_TEMP)/LOG10_NUM_STEPS;
-    mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
-    cout << "Increasing sample density near tInitial. " << "left bound: " << pow(10, binarySearchLeftEnd) << ", right bound: " << pow(10, binarySearchRightEnd) << endl;
-    for(int j = 0; j < 4; ++j){
-        double temperature = pow(10, mid);
-        double probability = pForTInitial(temperature);
-        pbadMap[mid] = probability;
-        cout << "Temperature: " << temperature << " pbad: " << probability << " score: " << eval(*A) << endl;
-        if(probability > 0.995){
-            binarySearchRightEnd = mid;
-            mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
-        } else if(probability < InitialPBad){
-            binarySearchLeftEnd = mid;
-            mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
+    brackets.push_back({"tInitial", log_temp, LOG10_LOW_TEMP + (T_i+1)*(LOG10_HIGH_TEMP-LOG10_LOW_TEMP)/LOG10_NUM_STEPS,
+        InitialPBad, 0.995, 16});
+    for (const Bracket& b : brackets) {
+        cout << "Increasing sample density near " << b.name << ". " << "left bound: " << pow(10, b.left) << ", right bound: " << pow(10, b.right) << endl;
+    }
+    //Both brackets are refined together. Each round samples evenly spaced points
+    //in every open bracket, as many as keep all the cores busy (one per bracket
+    //on a single core, which is plain bisection), and narrows it to the two
+    //neighboring samples around the crossing.
+    while (true) {
+        vector<Bracket*> open;
+        for (Bracket& b : brackets) {
+            if (b.resolution > 1) open.push_back(&b);
+        }
+        if (open.empty()) break;
+        uint perBracket = max(1u, (uint) (defaultNumThreads() / open.size()));
+        vector<double> logTemps, temperatures;
+        for (Bracket* b : open) {
+            for (uint k = 1; k <= perBracket; k++) {
+                logTemps.push_back(b->left + k*(b->right - b->left)/(perBracket+1));
+                temperatures.push_back(pow(10, logTemps.back()));
+            }
+        }
+        vector<double> pBads = pForTInitials(temperatures);
+        for (uint s = 0; s < pBads.size(); s++) {
+            pbadMap[logTemps[s]] = pBads[s];
+            cout << "Temperature: " << temperatures[s] << " pbad: " << pBads[s] << endl;
+        }
+        for (uint o = 0; o < open.size(); o++) {
+            Bracket* b = open[o];
+            double left = b->left, right = b->right;
+            b->resolution /= perBracket+1;
+            for (uint s = o*perBracket; s < (o+1)*perBracket; s++) {
+                if (pBads[s] > b->high) {
+                    right = logTemps[s];
+                    break;
+                }
+                if (pBads[s] >= b->low) { //close enough
+                    b->resolution = 0;
+                    break;
+                }
+                left = logTemps[s];
+            }
+            b->left = left;
+            b->right = right;
         }
     }
     LinearRegression linearRegression;
@@ -2829,52 +3337,66 @@ double SANA::pForTInitial(double TInitial) {
  //    cout << "Trying TInitial " << Temperature;
  //    //uint nBad = 0;
  //    //for(uint i=0; i<EIncs.size();i++)
-    // //nBad += (randomReal(gen) <= exp(EIncs[i]/Temperature));
+    // //nBad += (gen.real() <= exp(EIncs[i]/Temperature));
  //    pBad = exp(avgEnergyInc/Temperature); // (double)nBad/(EIncs.size());
  //    cout << " p(Bad) = " << pBad << endl;
     // return pBad;
 
-    //Establish the amount of iterations per second before getPforTInitial otherwise it will be calculated with iterationsPerStep = 100000
+    return pForTInitials({TInitial})[0];
+}
+
+//The temperatures are sampled a wave of one per core at a time, each by a
+//replica from a fresh starting alignment, so the samples are independent of
+//each other and of this SANA's alignment. The replicas are initialized
+//serially, because the measures are not evaluated concurrently, and only the
+//annealing runs in parallel. With ms3 in the objective the samplers run one at
+//a time, because the MS3 ops update the static MultiS3 degree counts.
+vector<double> SANA::pForTInitials(const vector<double>& temperatures) {
+    //Establish the amount of iterations per second before sampling otherwise it will be calculated with iterationsPerStep = 100000
     getIterPerSecond();
 
     uint ITERATIONS = 10000.+100.*n1+10.*n2+n1*n2*0.1; //heuristic value
     ITERATIONS = 100000;
-    double oldIterationsPerStep = this->iterationsPerStep;
-    double oldTInitial = this->TInitial;
-    bool oldRestart = restart;
-
-    this->iterationsPerStep = ITERATIONS;
-    this->TInitial = TInitial;
-    constantTemp = true;
-    enableTrackProgress = true;
-    restart = false;
-
-    long long int iter = 0;
-    // simpleRun(Alignment::random(n1, n2), 0.0, iter);
-    double result = getPforTInitial(getStartingAlignment(), 1.0, iter);
-    this->iterationsPerStep = oldIterationsPerStep;
-    this->TInitial = oldTInitial;
-    constantTemp = false;
-    enableTrackProgress = true;
-    restart = oldRestart;
+    uint count = temperatures.size();
+    uint waveSize = needMS3 ? 1 : min(count, defaultNumThreads());
+    vector<SANA*> samplers = createReplicas(waveSize+1);
+    samplers.erase(samplers.begin()); //not this one
+    for (SANA* sampler : samplers) {
+        sampler->iterationsPerStep = ITERATIONS;
+        sampler->constantTemp = true;
+        sampler->restart = false;
+    }
 
-    return result;
+    vector<double> pBads(count);
+    setInterruptSignal();
+    for (uint first = 0; first < count; first += waveSize) {
+        uint wave = min(waveSize, count - first);
+        for (uint r = 0; r < wave; r++) {
+            samplers[r]->TInitial = temperatures[first + r];
+            samplers[r]->initDataStructures(getStartingAlignment());
+        }
+        parallelFor(wave, wave, 1, [&](uint begin, uint end, uint) {
+            for (uint r = begin; r < end; r++) {
+                long long int iter = 0;
+                samplers[r]->timer.start();
+                pBads[first + r] = samplers[r]->samplePBad(1.0, iter);
+            }
+        });
+    }
+    for (SANA* sampler : samplers) {
+        delete sampler;
+    }
+    return pBads;
 }
 
-double SANA::getPforTInitial(const Alignment& startA, double maxExecutionSeconds,
-        long long int& iter) {
+//anneals from the current state until pBad has been sampled for maxExecutionSeconds
+double SANA::samplePBad(double maxExecutionSeconds, long long int& iter) {
     double result = 0.0;
-    initDataStructures(startA);
-
-    setInterruptSignal();
     for (; ; ++iter) {
-        Temperature = temperatureFunction(iter, TInitial, TDecay);
+        updateTemperature(iter);
         if (interrupt) {
             return result;
         }
-        if (saveAlignment) {
-            printReport();
-        }
         if (iter%iterationsPerStep == 0) {
             result = trueAcceptingProbability();
             if ((iter != 0 and timer.elapsed() > maxExecutionSeconds and sampledProbabilitySize > 0) or iter > 5E7) {
@@ -2936,7 +3458,7 @@ Alignment SANA::hillClimbingAlignment(Alignment startAlignment, long long int id
         }
         ++iter;
     }
-    trackProgress(iter);
+    trackProgress(iter, true);
     return *A;
 }
 
@@ -2956,7 +3478,7 @@ void SANA::hillClimbingIterations(long long int iterTarget) {
         }
         SANAIteration();
     }
-    trackProgress(iter);
+    trackProgress(iter, true);
 }
 
 double SANA::expectedNumAccEInc(double temp, const vector<double>& energyIncSample) {
@@ -3084,6 +3606,163 @@ double SANA::searchTDecay(double TInitial, uint iterations) {
     return lambda;
 }
 
+//identifies the contents of both networks and the objective
+uint64_t SANA::objectiveKey() {
+    uint64_t graphHashes[2] = {G1->contentHash(), G2->contentHash()};
+    string objective = MC->toString();
+    vector<double> weights;
+    for (uint i = 0; i < MC->numMeasures(); i++) weights.push_back(MC->getWeight(MC->getMeasure(i)->getName()));
+    uint64_t key = hashBytes(graphHashes, sizeof(graphHashes));
+    key = hashBytes(objective.c_str(), objective.size(), key);
+    key = hashBytes(weights.data(), weights.size()*sizeof(double), key);
+    return hashBytes(&score, sizeof(score), key);
+}
+
+//The file is named after the networks and the objective and holds a key over
+//the contents of both networks, the objective and the settings, so an edited
+//network or a different schedule option never picks up a stale schedule.
+string SANA::scheduleCacheFile(const string& settings, uint64_t& key) {
+    key = hashBytes(settings.c_str(), settings.size(), objectiveKey());
+    return "networks/" + G1->getName() + "/autogenerated/" + G1->getName() + "_" + G2->getName()
+        + "_" + MC->toString() + ".schedule";
+}
+
+bool SANA::loadSchedule(const string& settings) {
+    uint64_t key;
+    string fileName = scheduleCacheFile(settings, key);
+    ifstream ifs(fileName);
+    uint64_t fileKey;
+    double tInitial, tFinal, tDecay;
+    if (not (ifs >> hex >> fileKey >> dec >> tInitial >> tFinal >> tDecay) or fileKey != key) {
+        return false;
+    }
+    TInitial = tInitial;
+    TFinal = tFinal;
+    TDecay = tDecay;
+    cout << "Loaded cached temperature schedule " << fileName << ": TInitial = " << TInitial
+         << ", TFinal = " << TFinal << ", TDecay = " << TDecay << endl;
+    return true;
+}
+
+void SANA::saveSchedule(const string& settings) {
+    uint64_t key;
+    string fileName = scheduleCacheFile(settings, key);
+    try {
+        createFolder("networks");
+        createFolder("networks/" + G1->getName());
+        createFolder("networks/" + G1->getName() + "/autogenerated");
+    } catch (const runtime_error& e) { //e.g. networks/<name> is a file
+        cerr << "Warning: could not write temperature schedule cache " << fileName << ": " << e.what() << endl;
+        return;
+    }
+    string tmpName = fileName + ".tmp" + to_string(getpid());
+    ofstream ofs(tmpName);
+    ofs << hex << key << dec << setprecision(17) << " " << TInitial << " " << TFinal << " " << TDecay << endl;
+    ofs.close();
+    if (not ofs or rename(tmpName.c_str(), fileName.c_str()) != 0) {
+        remove(tmpName.c_str());
+        cerr << "Warning: could not write temperature schedule cache " << fileName << endl;
+    }
+}
+
+static const string CHECKPOINT_MAGIC = "SANA checkpoint 2";
+
+void SANA::enableCheckpoints(const string& fileName, double everySeconds) {
+    checkpointFileName = fileName;
+    checkpointSeconds = everySeconds;
+}
+
+//Everything in a checkpoint after its header. Cereal archives go both ways,
+//so this both saves and restores it; A, assignedNodesG2 and whatever else
+//initDataStructures derives from the alignment are rebuilt instead.
+template<class Archive>
+void SANA::checkpointState(Archive& archive, long long int& iter, double& elapsed) {
+    archive(iter, elapsed, Temperature, TDecay, currentScore, previousScore, avgEnergyInc, iterationsPerformed, gen);
+    archive(progressSteps, lastCheckedIter);
+    archive(*unassignedNodesG2, *unassignedgenesG2, *unassignedmiRNAsG2);
+    archive(aligEdges, edSum, squaredAligEdges, exposedEdgesNumer, MS3Numer, inducedEdges,
+            TCSum, localScoreSum, wecSum, ewecSum, ncSum, spcSum);
+    archive(sampledProbabilitySize, buffer_index, buffer_sum,
+            cereal::binary_data(sampledProbability, sizeof(sampledProbability)));
+}
+
+//written last at a progress report, so a resumed run skips the report at
+//its iteration; written to a temporary file that replaces the previous
+//checkpoint, so a job killed while writing still leaves a complete one
+void SANA::saveCheckpoint(long long int iter) {
+    double elapsed = timer.elapsed();
+    string tmpName = checkpointFileName + ".tmp" + to_string(getpid());
+    ofstream ofs(tmpName, ofstream::binary);
+    {
+        cereal::BinaryOutputArchive archive(ofs);
+        uint64_t key = objectiveKey();
+        archive(cereal::binary_data(CHECKPOINT_MAGIC.data(), CHECKPOINT_MAGIC.size()));
+        archive(key, n1, n2, TInitial, TFinal, usingIterations, minutes, maxIterations, iterPerSecond, *A);
+        checkpointState(archive, iter, elapsed);
+    }
+    ofs.close();
+    if (not ofs or rename(tmpName.c_str(), checkpointFileName.c_str()) != 0) {
+        remove(tmpName.c_str());
+        cerr << "Warning: could not write checkpoint " << checkpointFileName << endl;
+    }
+    lastCheckpointTime = elapsed;
+}
+
+//the run settings and alignment of the checkpoint; these are needed before
+//the run starts, the rest is restored by restoreCheckpoint
+void SANA::readCheckpointHeader(cereal::BinaryInputArchive& archive, const string& fileName) {
+    string magic(CHECKPOINT_MAGIC.size(), ' ');
+    archive(cereal::binary_data(&magic[0], magic.size()));
+    if (magic != CHECKPOINT_MAGIC) {
+        throw runtime_error(fileName + " is not a SANA checkpoint");
+    }
+    uint64_t key;
+    uint fileN1, fileN2;
+    archive(key, fileN1, fileN2);
+    if (key != objectiveKey() or fileN1 != n1 or fileN2 != n2) {
+        throw runtime_error("checkpoint " + fileName + " was written for other networks or another objective");
+    }
+    archive(TInitial, TFinal, usingIterations, minutes, maxIterations, iterPerSecond, resumeMapping);
+    initializedIterPerSecond = true;
+}
+
+void SANA::resumeFrom(const string& fileName) {
+    ifstream ifs(fileName, ifstream::binary);
+    if (not ifs) {
+        throw runtime_error("cannot read checkpoint " + fileName);
+    }
+    try {
+        cereal::BinaryInputArchive archive(ifs);
+        readCheckpointHeader(archive, fileName);
+    } catch (const cereal::Exception& e) {
+        throw runtime_error("checkpoint " + fileName + " is truncated or corrupted");
+    }
+    resumeFileName = fileName;
+    cout << "Resuming from checkpoint " << fileName << ": TInitial = " << TInitial
+         << (usingIterations ? ", iterations = " + to_string(maxIterations) : ", minutes = " + to_string(minutes)) << endl;
+}
+
+//called right after initDataStructures(resumeMapping)
+void SANA::restoreCheckpoint(long long int& iter) {
+    ifstream ifs(resumeFileName, ifstream::binary);
+    double elapsed;
+    try {
+        cereal::BinaryInputArchive archive(ifs);
+        readCheckpointHeader(archive, resumeFileName);
+        checkpointState(archive, iter, elapsed);
+    } catch (const cereal::Exception& e) {
+        throw runtime_error("checkpoint " + resumeFileName + " is truncated or corrupted");
+    }
+    cout << "Resumed at iteration " << iter << " after " << elapsed << "s" << endl;
+    resumeFileName = "";
+    resumeMapping.clear();
+    temperatureIter = iter-1; //keeps the Temperature of the checkpoint until the next step
+    resumedIter = iter;
+    oldIterationsPerformed = iterationsPerformed;
+    oldTimeElapsed = lastCheckpointTime = elapsed;
+    timer.startFrom(elapsed);
+}
+
 double SANA::getTInitial(void) { return TInitial; }
 double SANA::getTFinal(void) { return TFinal; }
 double SANA::getTDecay(void) { return TDecay; }
@@ -3164,7 +3843,8 @@ void SANA::prune(string& startAligName) {
         errorMsg << "Alignment size (" << alignment.size() << ") less than number of nodes (" << n <<")";
         throw runtime_error(errorMsg.str().c_str());
     }
-    set<pair<uint,uint>> removedEdges;
+    //shadow pairs whose weight dropped to 0, as (min, max)
+    vector<pair<uint,uint>> removedEdges;
     for (uint i = 0; i < n; ++i) {
         uint g1_node1 = reIndexedMap[i];
         uint shadow_node = alignment[g1_node1];
@@ -3175,28 +3855,27 @@ void SANA::prune(string& startAligName) {
             uint g1_node2 = reIndexedMap[G1AdjLists[i][j]];
             uint shadow_end = alignment[g1_node2];
 
-            assert(G1Matrix[g1_node1][g1_node2] == 0 || G2Matrix[shadow_node][shadow_end] > 0);
-            assert(G1Matrix[g1_node2][g1_node1] == 0 || G2Matrix[shadow_end][shadow_node] > 0);
+            assert(G1Matrix.get(g1_node1, g1_node2) == 0 || G2Matrix.get(shadow_node, shadow_end) > 0);
+            assert(G1Matrix.get(g1_node2, g1_node1) == 0 || G2Matrix.get(shadow_end, shadow_node) > 0);
 
-            G2Matrix[shadow_node][shadow_end] -= G1Matrix[g1_node1][g1_node2];
-            G2Matrix[shadow_end][shadow_node] -= G1Matrix[g1_node1][g1_node2];
-            if (G2Matrix[shadow_node][shadow_end] == 0) {
-                removedEdges.insert(pair<uint,uint>(shadow_node,shadow_end));
+            G2Matrix[shadow_node][shadow_end] -= G1Matrix.get(g1_node1, g1_node2);
+            G2Matrix[shadow_end][shadow_node] -= G1Matrix.get(g1_node1, g1_node2);
+            if (G2Matrix.get(shadow_node, shadow_end) == 0) {
+                removedEdges.push_back(minmax(shadow_node, shadow_end));
             }
         }
     }
+    sort(removedEdges.begin(), removedEdges.end());
     vector<vector<uint> > t_edgeList;
-    vector<vector<uint> > G2EdgeList;
-    G2->getEdgeList(G2EdgeList);
-    for (auto c : G2EdgeList) {
-        if (removedEdges.find(pair<uint,uint>(c[0],c[1])) != removedEdges.end() or
-                removedEdges.find(pair<uint,uint>(c[1],c[0])) != removedEdges.end()) {
+    const vector<vector<uint> >& G2EdgeList = G2->getEdgeList();
+    t_edgeList.reserve(G2EdgeList.size() - removedEdges.size());
+    for (const auto& c : G2EdgeList) {
+        if (binary_search(removedEdges.begin(), removedEdges.end(), pair<uint,uint>(minmax(c[0], c[1])))) {
             continue;
         }
         t_edgeList.push_back(c);
     }
-    G2->setMatrix(G2Matrix);
-    G2->getAdjLists(G2AdjLists);
+    //G2Matrix is G2's own matrix, so only the edge list is left to update
     G2->setEdgeList(t_edgeList);
 }
 #endif
@@ -3242,13 +3921,6 @@ void SANA::performChange(Job &job, int type) {
     double newNcSum            = (needNC) ? info.ncSum + ncIncChangeOp(job, source, oldTarget, newTarget) : -1;
     double newEdSum            = (needEd) ? info.edSum + edgeDifferenceIncChangeOp(job, source, oldTarget, newTarget) : -1;
 
-    map<string, double> newLocalScoreSumMap;
-    if (needLocal) {
-        newLocalScoreSumMap = map<string, double>(*info.localScoreSumMap);
-        for(auto &item : newLocalScoreSumMap)
-            item.second += localScoreSumIncChangeOp(localSimMatrixMap[item.first], source, oldTarget, newTarget);
-    }
-
     double newCurrentScore = 0;
     bool makeChange = scoreComparison(job, newAligEdges, newInducedEdges, newTCSum, newLocalScoreSum, newWecSum, newNcSum, newCurrentScore, newEwecSum, newSquaredAligEdges, newExposedEdgesNumer, newEdSum);
 
@@ -3260,12 +3932,12 @@ void SANA::performChange(Job &job, int type) {
         if(pBad <= 0 || myNan(pBad)) pBad = PBAD_LOW_TEMP_LIMIT;
 #if UNWEIGHTED_CORES
 	numPegSamples[source]++;
-	pegHoleFreq[source][betterHole]++;
+	pegHoleFreq.add(source, betterHole, 1);
 #endif
 	totalWeightedPegWeight_pBad[source] += pBad;
-	weightedPegHoleFreq_pBad[source][betterHole] += pBad;
+	weightedPegHoleFreq_pBad.add(source, betterHole, pBad);
 	totalWeightedPegWeight_1mpBad[source] += 1-pBad;
-	weightedPegHoleFreq_1mpBad[source][betterHole] += 1-pBad;
+	weightedPegHoleFreq_1mpBad.add(source, betterHole, 1-pBad);
 #endif
 
     if (makeChange) {
@@ -3296,15 +3968,11 @@ void SANA::performChange(Job &job, int type) {
        info.currentScore = newCurrentScore;
        info.squaredAligEdges = newSquaredAligEdges;
 	   info.exposedEdgesNumer = newExposedEdgesNumer;
-
-       if (needLocal) {
-           (*info.localScoreSumMap) = newLocalScoreSumMap;
-       }
 #if 0
-       if (randomReal(job.gen) <= 1) {
+       if (job.gen.real() <= 1) {
            double foo = eval(*A);
            if (fabs(foo - newCurrentScore) > 20) {
-               cout << "\nSwap: nCS " << newCurrentScore << " eval " << foo << " nCS - eval " << newCurrentScore - foo << " adj? " << (G1Matrix[source1][source2] & G2Matrix[target1][target2]);
+               cout << "\nSwap: nCS " << newCurrentScore << " eval " << foo << " nCS - eval " << newCurrentScore - foo << " adj? " << (G1Matrix.get(source1, source2) & G2Matrix.get(target1, target2));
                newCurrentScore = newSquaredAligEdges = foo;
            }
            else cout << "s";
@@ -3331,13 +3999,6 @@ void SANA::performSwap(Job &job, int type) {
     double newLocalScoreSum    = (needLocal) ? info.localScoreSum + localScoreSumIncSwapOp(job, sims, source1, source2, target1, target2) : -1;
     double newEdSum            = (needEd) ? info.edSum + edgeDifferenceIncSwapOp(job, source1, source2, target1, target2) : -1;
 
-    map<string, double> newLocalScoreSumMap;
-    if (needLocal) {
-        newLocalScoreSumMap = map<string, double>(*info.localScoreSumMap);
-        for (auto &item : newLocalScoreSumMap)
-            item.second += localScoreSumIncSwapOp(localSimMatrixMap[item.first], source1, source2, target1, target2);
-    }
-
     double newCurrentScore = 0;
     bool makeChange = scoreComparison(job, newAligEdges, info.inducedEdges, newTCSum, newLocalScoreSum, newWecSum, newNcSum, newCurrentScore, newEwecSum, newSquaredAligEdges, newExposedEdgesNumer, newEdSum);
 #ifdef CORES
@@ -3350,17 +4011,17 @@ void SANA::performSwap(Job &job, int type) {
         uint betterDest2 = wasBadMove ? target2 : target1;
 #if UNWEIGHTED_CORES
         numPegSamples[source1]++; numPegSamples[source2]++;
-        pegHoleFreq[source1][betterDest1]++; pegHoleFreq[source2][betterDest2]++;
+        pegHoleFreq.add(source1, betterDest1, 1); pegHoleFreq.add(source2, betterDest2, 1);
 #endif
         totalWeightedPegWeight_pBad[source1] += pBad;
-        weightedPegHoleFreq_pBad[source1][betterDest1] += pBad;
+        weightedPegHoleFreq_pBad.add(source1, betterDest1, pBad);
         totalWeightedPegWeight_pBad[source2] += pBad;
-        weightedPegHoleFreq_pBad[source2][betterDest2] += pBad;
+        weightedPegHoleFreq_pBad.add(source2, betterDest2, pBad);
 
         totalWeightedPegWeight_1mpBad[source1] += 1-pBad;
-        weightedPegHoleFreq_1mpBad[source1][betterDest1] += 1-pBad;
+        weightedPegHoleFreq_1mpBad.add(source1, betterDest1, 1-pBad);
         totalWeightedPegWeight_1mpBad[source2] += 1-pBad;
-        weightedPegHoleFreq_1mpBad[source2][betterDest2] += 1-pBad;
+        weightedPegHoleFreq_1mpBad.add(source2, betterDest2, 1-pBad);
 #endif
     if (makeChange) {
         (*A)[source1]       = target2;
@@ -3375,13 +4036,11 @@ void SANA::performSwap(Job &job, int type) {
         info.squaredAligEdges    = newSquaredAligEdges;
         info.edSum               = newEdSum;
 		info.exposedEdgesNumer	 = newExposedEdgesNumer;
-        if (needLocal)
-            (*info.localScoreSumMap) = newLocalScoreSumMap;
 #if 0
-        if (randomReal(job.gen) <= 1) {
+        if (job.gen.real() <= 1) {
             double foo = eval(*A);
             if (fabs(foo - newCurrentScore) > 20) {
-                cout << "\nSwap: nCS " << newCurrentScore << " eval " << foo << " nCS - eval " << newCurrentScore - foo << " adj? " << (G1Matrix[source1][source2] & G2Matrix[target1][target2]);
+                cout << "\nSwap: nCS " << newCurrentScore << " eval " << foo << " nCS - eval " << newCurrentScore - foo << " adj? " << (G1Matrix.get(source1, source2) & G2Matrix.get(target1, target2));
                 newCurrentScore = newSquaredAligEdges = foo;
             }
             else cout << "s";
@@ -3398,9 +4057,9 @@ void SANA::parallelParetoSANAIteration(Job &job) {
 	// For example if no locking, then prob (gene) >> prob (miRNA)
 	// And if locking, then arrange prob(gene) and prob(miRNA) appropriately
         int type = /* something clever */ 0;
-        (randomReal(job.gen) < changeProbability[type]) ? performChange(job, type) : performSwap(job, type);
+        (job.gen.real() < changeProbability[type]) ? performChange(job, type) : performSwap(job, type);
     }
-        (randomReal(job.gen) < changeProbability[0]) ? performChange(job, 0) : performSwap(job, 0);
+        (job.gen.real() < changeProbability[0]) ? performChange(job, 0) : performSwap(job, 0);
 }
 
 
@@ -3436,7 +4095,9 @@ void SANA::startParallelParetoRunByIteration(Job &job, long long int maxExecutio
             //job.Temperature = temperatureFunction(startIter + i, TInitial, TDecay);
 
             // Temperature is based on how much iterations each thread has yet performed.
-            job.Temperature = temperatureFunction(job.iterationsPerformed, TInitial, TDecay);
+            if (i == 0 or job.iterationsPerformed % TEMPERATURE_STEP == 0) {
+                job.Temperature = temperatureFunction(job.iterationsPerformed, TInitial, TDecay);
+            }
 
             parallelParetoSANAIteration(job);
         }
@@ -3452,6 +4113,7 @@ unordered_set<vector<uint>*>* SANA::parallelParetoRun(const Alignment& startA, l
     paretoFront = ParetoFront(paretoCapacity, numOfMeasures, measureNames);
     assert(numOfMeasures > 1 && "Pareto mode must optimize on more than one measure");
     score = Score::pareto;
+    chooseIterationKernel();
     initializeParetoFront();
     initializeJobs();
 
@@ -3508,7 +4170,9 @@ void SANA::startParallelParetoRunByTime(Job &job, double maxExecutionSeconds) {
             //job.Temperature = temperatureFunction(startIter + i, TInitial, TDecay);
 
             // Temperature is based on how much iterations each thread has yet performed.
-            job.Temperature = temperatureFunction(job.iterationsPerformed, TInitial, TDecay);
+            if (i == 0 or job.iterationsPerformed % TEMPERATURE_STEP == 0) {
+                job.Temperature = temperatureFunction(job.iterationsPerformed, TInitial, TDecay);
+            }
 
             parallelParetoSANAIteration(job);
         }
@@ -3524,6 +4188,7 @@ unordered_set<vector<uint>*>* SANA::parallelParetoRun(const Alignment& startA, d
     paretoFront = ParetoFront(paretoCapacity, numOfMeasures, measureNames);
     assert(numOfMeasures > 1 && "Pareto mode must optimize on more than one measure");
     score = Score::pareto;
+    chooseIterationKernel();
     initializeParetoFront();
     initializeJobs();
 
@@ -3550,7 +4215,7 @@ void SANA::initializeJobs() {
     jobs = vector<Job>(paretoThreads);
     for (uint i = 0; i < paretoThreads; ++i) {
         jobs[i].id = i;
-        jobs[i].gen = mt19937(getRandomSeed());
+        jobs[i].gen.seed(getRandomSeed() + i);
         jobs[i].iterationsPerformed = 0;
     }
 }
@@ -3562,8 +4227,6 @@ void SANA::releaseAlignment(Job &job) {
     delete info.unassignedNodesG2;
     delete info.unassignedmiRNAsG2;
     delete info.unassignedgenesG2;
-    if (needLocal)
-        delete info.localScoreSumMap;
 }
 
 double SANA::trueAcceptingProbability(Job &job) {
@@ -3609,7 +4272,6 @@ void SANA::storeAlignment(Job &job) {
     if(needTC)                   storedTCSum[A]            = info.TCSum;
     if(needEd)                   storedEdSum[A]            = info.edSum;
     if(needLocal)                storedLocalScoreSum[A]    = info.localScoreSum;
-    if(needLocal)                storedLocalScoreSumMap[A] = info.localScoreSumMap;
     if(needWec)                  storedWecSum[A]           = info.wecSum;
     if(needEwec)                 storedEwecSum[A]          = info.ewecSum;
     if(needNC)                   storedNcSum[A]            = info.ncSum;
@@ -3627,7 +4289,6 @@ void SANA::copyAlignmentFromStorage(Job &job, vector<uint> *A) {
     info.TCSum            = (needTC) ?  storedTCSum[A] : -1;
     info.edSum            = (needEd) ?  storedEdSum[A] : -1;
     info.localScoreSum    = (needLocal) ? storedLocalScoreSum[A] : -1;
-    info.localScoreSumMap = (needLocal) ? new map<string, double>(*storedLocalScoreSumMap[A]) : nullptr;
     info.wecSum           = (needWec) ?  storedWecSum[A] : -1;
     info.ewecSum          = (needEwec) ?  storedEwecSum[A] : -1;
     info.ncSum            = (needNC) ? storedNcSum[A] : -1;
@@ -3755,13 +4416,13 @@ int SANA::aligEdgesIncChangeOp(Job &job, uint source, uint oldTarget, uint newTa
     uint neighbor;
     for (uint i = 0; i < n; ++i) {
         neighbor = G1AdjLists[source][i];
-        res -= G2Matrix[oldTarget][(*A)[neighbor]];
-        res += G2Matrix[newTarget][(*A)[neighbor]];
+        res -= G2Matrix.get(oldTarget, (*A)[neighbor]);
+        res += G2Matrix.get(newTarget, (*A)[neighbor]);
     }
     return res;
 }
 
-#define SQRDIFF2(A,i,j) ((_edgeVal=G2Matrix[i][(*A)[j]]), 2*((_edgeVal<1000?_edgeVal:0) + 1))
+#define SQRDIFF2(A,i,j) ((_edgeVal=G2Matrix.get(i, (*A)[j])), 2*((_edgeVal<1000?_edgeVal:0) + 1))
 int SANA::squaredAligEdgesIncChangeOp(Job &job, uint source, uint oldTarget, uint newTarget) {
     int res = 0, diff;
     uint neighbor;
@@ -3796,7 +4457,7 @@ int SANA::inducedEdgesIncChangeOp(Job &job, uint source, uint oldTarget, uint ne
         res += (*assignedNodesG2)[neighbor];
     }
     // address case changing between adjacent nodes:
-    res -= G2Matrix[oldTarget][newTarget];
+    res -= G2Matrix.get(oldTarget, newTarget);
     return res;
 }
 
@@ -3809,13 +4470,13 @@ double SANA::TCIncChangeOp(Job &job, uint source, uint oldTarget, uint newTarget
         for(uint j = i+1; j < n; ++j){
             neighbor1 = G1AdjLists[source][i];
             neighbor2 = G1AdjLists[source][j];
-            if(G1Matrix[neighbor1][neighbor2]){
+            if(G1Matrix.get(neighbor1, neighbor2)){
                 //G1 has a triangle
-                if(G2Matrix[oldTarget][(*A)[neighbor1]] and G2Matrix[oldTarget][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]]){
+                if(G2Matrix.get(oldTarget, (*A)[neighbor1]) and G2Matrix.get(oldTarget, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2])){
                     //G2 HAD a triangle
                     deltaTriangles -= 1;
                 }
-                if(G2Matrix[newTarget][(*A)[neighbor1]] and G2Matrix[newTarget][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]]){
+                if(G2Matrix.get(newTarget, (*A)[neighbor1]) and G2Matrix.get(newTarget, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2])){
                     //G2 GAINS a triangle
                     deltaTriangles += 1;
                 }
@@ -3825,7 +4486,7 @@ double SANA::TCIncChangeOp(Job &job, uint source, uint oldTarget, uint newTarget
     return ((double)deltaTriangles/maxTriangles);
 }
 
-double SANA::localScoreSumIncChangeOp(Job &job, vector<vector<float> > const & sim, uint const & source, uint const & oldTarget, uint const & newTarget) {
+double SANA::localScoreSumIncChangeOp(Job &job, SimMatrix const & sim, uint const & source, uint const & oldTarget, uint const & newTarget) {
     return sim[source][newTarget] - sim[source][oldTarget];
 }
 
@@ -3836,11 +4497,11 @@ double SANA::WECIncChangeOp(Job &job, uint source, uint oldTarget, uint newTarge
     uint neighbor;
     for (uint j = 0; j < n; ++j) {
         neighbor = G1AdjLists[source][j];
-        if (G2Matrix[oldTarget][(*A)[neighbor]]) {
+        if (G2Matrix.get(oldTarget, (*A)[neighbor])) {
             res -= wecSims[source][oldTarget];
             res -= wecSims[neighbor][(*A)[neighbor]];
         }
-        if (G2Matrix[newTarget][(*A)[neighbor]]) {
+        if (G2Matrix.get(newTarget, (*A)[neighbor])) {
             res += wecSims[source][newTarget];
             res += wecSims[neighbor][(*A)[neighbor]];
         }
@@ -3861,7 +4522,7 @@ double SANA::EWECSimCombo(Job &job, uint source, uint target) {
     uint neighbor;
     for (uint i = 0; i < n; ++i) {
         neighbor = G1AdjLists[source][i];
-        if (G2Matrix[target][(*A)[neighbor]]) {
+        if (G2Matrix.get(target, (*A)[neighbor])) {
             int e1 = ewec->getRowIndex(source, neighbor);
             int e2 = ewec->getColIndex(target, (*A)[neighbor]);
             score+=ewec->getScore(e2,e1);
@@ -3912,8 +4573,8 @@ bool SANA::scoreComparison(Job &job, double newAligEdges, double newInducedEdges
         newCurrentScore += ncWeight * (newNcSum / trueA.back());
         job.energyInc = newCurrentScore - info.currentScore;
         wasBadMove = job.energyInc < 0;
-        badProbability = exp(job.energyInc / job.Temperature);
-        makeChange = (addScores[info.currentMeasure] > info.currentScores[info.currentMeasure] or job.energyInc >= 0 or randomReal(job.gen) <= exp(job.energyInc / job.Temperature));
+        if (wasBadMove) badProbability = exp(job.energyInc / job.Temperature);
+        makeChange = (addScores[info.currentMeasure] > info.currentScores[info.currentMeasure] or job.energyInc >= 0 or job.gen.real() <= badProbability);
         if(makeChange) info.currentScores = addScores;
     }
     if (((TCWeight > 0 && job.iterationsPerformed % 32 == 0) || job.iterationsPerformed % 512 == 0) && wasBadMove) { //this will never run in the case of iterationsPerformed never being changed so that it doesn't greatly slow down the program if for some reason iterationsPerformed doesn't need to be changed.
@@ -3968,20 +4629,20 @@ int SANA::aligEdgesIncSwapOp(Job &job, uint source1, uint source2, uint target1,
     uint i = 0;
     for (; i < n; ++i) {
         neighbor = G1AdjLists[source1][i];
-        res -= G2Matrix[target1][(*A)[neighbor]];
-        res += G2Matrix[target2][(*A)[neighbor]];
+        res -= G2Matrix.get(target1, (*A)[neighbor]);
+        res += G2Matrix.get(target2, (*A)[neighbor]);
     }
     const uint m = G1AdjLists[source2].size();
     for (i = 0; i < m; ++i) {
         neighbor = G1AdjLists[source2][i];
-        res -= G2Matrix[target2][(*A)[neighbor]];
-        res += G2Matrix[target1][(*A)[neighbor]];
+        res -= G2Matrix.get(target2, (*A)[neighbor]);
+        res += G2Matrix.get(target1, (*A)[neighbor]);
     }
     //address case swapping between adjacent nodes with adjacent images:
 #ifdef MULTI_PAIRWISE
-    res += (-1 << 1) & (G1Matrix[source1][source2] + G2Matrix[target1][target2]);
+    res += (-1 << 1) & (G1Matrix.get(source1, source2) + G2Matrix.get(target1, target2));
 #else
-    res += 2*(G1Matrix[source1][source2] & G2Matrix[target1][target2]);
+    res += 2*(G1Matrix.get(source1, source2) & G2Matrix.get(target1, target2));
 #endif
     return res;
 }
@@ -3995,16 +4656,16 @@ double SANA::TCIncSwapOp(Job &job, uint source1, uint source2, uint target1, uin
         for(uint j = i+1; j < n; ++j){
             neighbor1 = G1AdjLists[source1][i];
             neighbor2 = G1AdjLists[source1][j];
-            if(G1Matrix[neighbor1][neighbor2]){
+            if(G1Matrix.get(neighbor1, neighbor2)){
                 //G1 has a triangle
-                if(G2Matrix[target1][(*A)[neighbor1]] and G2Matrix[target1][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]]){
+                if(G2Matrix.get(target1, (*A)[neighbor1]) and G2Matrix.get(target1, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2])){
                     //G2 HAD a triangle
                     deltaTriangles -= 1;
                 }
 
-                if((G2Matrix[target2][(*A)[neighbor1]] and G2Matrix[target2][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]])
-                || (neighbor1 == source2 and G2Matrix[target2][target1] and G2Matrix[target2][(*A)[neighbor2]] and G2Matrix[target1][(*A)[neighbor2]])
-                || (neighbor2 == source2 and G2Matrix[target2][(*A)[neighbor1]] and G2Matrix[target2][target1] and G2Matrix[(*A)[neighbor1]][target1])) {
+                if((G2Matrix.get(target2, (*A)[neighbor1]) and G2Matrix.get(target2, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2]))
+                || (neighbor1 == source2 and G2Matrix.get(target2, target1) and G2Matrix.get(target2, (*A)[neighbor2]) and G2Matrix.get(target1, (*A)[neighbor2]))
+                || (neighbor2 == source2 and G2Matrix.get(target2, (*A)[neighbor1]) and G2Matrix.get(target2, target1) and G2Matrix.get((*A)[neighbor1], target1))) {
                     //G2 GAINS a triangle
                     deltaTriangles += 1;
                 }
@@ -4016,16 +4677,16 @@ double SANA::TCIncSwapOp(Job &job, uint source1, uint source2, uint target1, uin
         for(uint j = i+1; j < m; ++j){
             neighbor1 = G1AdjLists[source2][i];
             neighbor2 = G1AdjLists[source2][j];
-            if(G1Matrix[neighbor1][neighbor2]){
+            if(G1Matrix.get(neighbor1, neighbor2)){
                 //G1 has a triangle
-                if(G2Matrix[target2][(*A)[neighbor1]] and G2Matrix[target2][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]]){
+                if(G2Matrix.get(target2, (*A)[neighbor1]) and G2Matrix.get(target2, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2])){
                     //G2 HAD a triangle
                     deltaTriangles -= 1;
                 }
 
-                if((G2Matrix[target1][(*A)[neighbor1]] and G2Matrix[target1][(*A)[neighbor2]] and G2Matrix[(*A)[neighbor1]][(*A)[neighbor2]])
-                   || (neighbor1 == source1 and G2Matrix[target1][target2] and G2Matrix[target1][(*A)[neighbor2]] and G2Matrix[target2][(*A)[neighbor2]])
-                   || (neighbor2 == source1 and G2Matrix[target1][(*A)[neighbor1]] and G2Matrix[target1][target2] and G2Matrix[(*A)[neighbor1]][target2])){
+                if((G2Matrix.get(target1, (*A)[neighbor1]) and G2Matrix.get(target1, (*A)[neighbor2]) and G2Matrix.get((*A)[neighbor1], (*A)[neighbor2]))
+                   || (neighbor1 == source1 and G2Matrix.get(target1, target2) and G2Matrix.get(target1, (*A)[neighbor2]) and G2Matrix.get(target2, (*A)[neighbor2]))
+                   || (neighbor2 == source1 and G2Matrix.get(target1, (*A)[neighbor1]) and G2Matrix.get(target1, target2) and G2Matrix.get((*A)[neighbor1], target2))){
                     //G2 GAINS a triangle
                     deltaTriangles += 1;
                 }
@@ -4063,7 +4724,7 @@ int SANA::squaredAligEdgesIncSwapOp(Job &job, uint source1, uint source2, uint t
     }
     //  How to do for squared?
     // address case swapping between adjacent nodes with adjacent images:
-    if(G1Matrix[source1][source2] and G2Matrix[target1][target2])
+    if(G1Matrix.get(source1, source2) and G2Matrix.get(target1, target2))
     {
         res += 2 * SQRDIFF2(A, target1,source2);
     }
@@ -4078,11 +4739,11 @@ double SANA::WECIncSwapOp(Job &job, uint source1, uint source2, uint target1, ui
     uint neighbor;
     for (uint j = 0; j < n; ++j) {
         neighbor = G1AdjLists[source1][j];
-        if (G2Matrix[target1][(*A)[neighbor]]) {
+        if (G2Matrix.get(target1, (*A)[neighbor])) {
             res -= wecSims[source1][target1];
             res -= wecSims[neighbor][(*A)[neighbor]];
         }
-        if (G2Matrix[target2][(*A)[neighbor]]) {
+        if (G2Matrix.get(target2, (*A)[neighbor])) {
             res += wecSims[source1][target2];
             res += wecSims[neighbor][(*A)[neighbor]];
         }
@@ -4090,20 +4751,20 @@ double SANA::WECIncSwapOp(Job &job, uint source1, uint source2, uint target1, ui
     const uint m = G1AdjLists[source2].size();
     for (uint j = 0; j < m; ++j) {
         neighbor = G1AdjLists[source2][j];
-        if (G2Matrix[target2][(*A)[neighbor]]) {
+        if (G2Matrix.get(target2, (*A)[neighbor])) {
             res -= wecSims[source2][target2];
             res -= wecSims[neighbor][(*A)[neighbor]];
         }
-        if (G2Matrix[target1][(*A)[neighbor]]) {
+        if (G2Matrix.get(target1, (*A)[neighbor])) {
             res += wecSims[source2][target1];
             res += wecSims[neighbor][(*A)[neighbor]];
         }
     }
     //address case swapping between adjacent nodes with adjacent images:
 #ifdef MULTI_PAIRWISE
-    if (G1Matrix[source1][source2] > 0 and G2Matrix[target1][target2] > 0) {
+    if (G1Matrix.get(source1, source2) > 0 and G2Matrix.get(target1, target2) > 0) {
 #else
-    if (G1Matrix[source1][source2] and G2Matrix[target1][target2]) {
+    if (G1Matrix.get(source1, source2) and G2Matrix.get(target1, target2)) {
 #endif
         res += 2*wecSims[source1][target1];
         res += 2*wecSims[source2][target2];
@@ -4114,7 +4775,7 @@ double SANA::WECIncSwapOp(Job &job, uint source1, uint source2, uint target1, ui
 double SANA::EWECIncSwapOp(Job &job, uint source1, uint source2, uint target1, uint target2) {
     double score = 0;
     score = (EWECSimCombo(job, source1, target2)) + (EWECSimCombo(job, source2, target1)) - (EWECSimCombo(job, source1, target1)) - (EWECSimCombo(job, source2, target2));
-    if(G1Matrix[source1][source2] and G2Matrix[target1][target2]){
+    if(G1Matrix.get(source1, source2) and G2Matrix.get(target1, target2)){
         score += ewec->getScore(ewec->getColIndex(target1, target2), ewec->getRowIndex(source1, source2))/(g1Edges); //correcting for missed edges when swapping 2 adjacent pairs
     }
     return score;
@@ -4129,7 +4790,7 @@ int SANA::ncIncSwapOp(Job &job, uint source1, uint source2, uint target1, uint t
     return change;
 }
 
-double SANA::localScoreSumIncSwapOp(Job &job, vector<vector<float> > const & sim, uint const & source1, uint const & source2, uint const & target1, uint const & target2) {
+double SANA::localScoreSumIncSwapOp(Job &job, SimMatrix const & sim, uint const & source1, uint const & source2, uint const & target1, uint const & target2) {
     return sim[source1][target2] - sim[source1][target1] + sim[source2][target1] - sim[source2][target2];
 }
 
@@ -4138,14 +4799,14 @@ double SANA::edgeDifferenceIncChangeOp(Job &job, uint source, uint oldTarget, ui
    double edgeDifferenceIncDiff = 0;
    double c = 0;
    for (uint node2 = 0; node2 < n1; ++node2) {
-       double y = -abs(G1FloatWeights[source][node2] - G2FloatWeights[oldTarget][(*A)[node2]])
+       double y = -abs(G1FloatWeights.get(source, node2) - G2FloatWeights.get(oldTarget, (*A)[node2]))
                   - c;
        double t = edgeDifferenceIncDiff + y;
        c = (t - edgeDifferenceIncDiff) - y;
        edgeDifferenceIncDiff = t;
 
        uint node2Target = node2 == source ? newTarget : (*A)[node2];
-       y = +abs(G1FloatWeights[source][node2] - G2FloatWeights[newTarget][node2Target])
+       y = +abs(G1FloatWeights.get(source, node2) - G2FloatWeights.get(newTarget, node2Target))
                   - c;
        t = edgeDifferenceIncDiff + y;
        c = (t - edgeDifferenceIncDiff) - y;
@@ -4167,7 +4828,7 @@ double SANA::edgeDifferenceIncSwapOp(Job &job, uint source1, uint source2, uint
     double edgeDifferenceIncDiff = 0;
     double c = 0;
     for (uint node2 = 0; node2 < n1; ++node2) {
-        double y = -abs(G1FloatWeights[source1][node2] - G2FloatWeights[target1][(*A)[node2]])
+        double y = -abs(G1FloatWeights.get(source1, node2) - G2FloatWeights.get(target1, (*A)[node2]))
                   - c;
         double t = edgeDifferenceIncDiff + y;
         c = (t - edgeDifferenceIncDiff) - y;
@@ -4181,7 +4842,7 @@ double SANA::edgeDifferenceIncSwapOp(Job &job, uint source1, uint source2, uint
         } else {
             node2Target = (*A)[node2];
         }
-        y = +abs(G1FloatWeights[source1][node2] - G2FloatWeights[target2][node2Target])
+        y = +abs(G1FloatWeights.get(source1, node2) - G2FloatWeights.get(target2, node2Target))
            - c;
         t = edgeDifferenceIncDiff + y;
         c = (t - edgeDifferenceIncDiff) - y;
@@ -4192,7 +4853,7 @@ double SANA::edgeDifferenceIncSwapOp(Job &job, uint source1, uint source2, uint
     // Add source2-target1
     for (uint node2 = 0; node2 < n1; ++node2) {
         if (node2 == source1) continue;
-        double y = -abs(G1FloatWeights[source2][node2] - G2FloatWeights[target2][(*A)[node2]])
+        double y = -abs(G1FloatWeights.get(source2, node2) - G2FloatWeights.get(target2, (*A)[node2]))
                   - c;
         double t = edgeDifferenceIncDiff + y;
         c = (t - edgeDifferenceIncDiff) - y;
@@ -4204,7 +4865,7 @@ double SANA::edgeDifferenceIncSwapOp(Job &job, uint source1, uint source2, uint
         } else {
             node2Target = (*A)[node2];
         }
-        y = +abs(G1FloatWeights[source2][node2] - G2FloatWeights[target1][node2Target])
+        y = +abs(G1FloatWeights.get(source2, node2) - G2FloatWeights.get(target1, node2Target))
            - c;
         t = edgeDifferenceIncDiff + y;
         c = (t - edgeDifferenceIncDiff) - y;
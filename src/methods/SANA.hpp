@@ -7,12 +7,18 @@
 #include <chrono>
 #include <ctime>
 #include <random>
+#include <functional>
+#include <memory>
 #include "../measures/localMeasures/LocalMeasure.hpp"
 #include "../measures/Measure.hpp"
 #include "../measures/MeasureCombination.hpp"
 #include "../utils/randomSeed.hpp"
+#include "../utils/Xoshiro256.hpp"
 #include "../utils/ParetoFront.hpp"
+#include "../utils/SnapshotVerifier.hpp"
+#include "../utils/PegHoleFrequency.hpp"
 #include "../measures/ExternalWeightedEdgeConservation.hpp"
+#include "../measures/ShortestPathConservation.hpp"
 
 #ifdef MULTI_PAIRWISE
 #define PARAMS int aligEdges, int g1Edges, int inducedEdges, int g2Edges, double TCSum, int localScoreSum, int n1, double wecSum, double ewecSum, int ncSum, unsigned int trueA_back, double g1WeightedEdges, double g2WeightedEdges, int squaredAligEdges, int exposedEdgesNumer, double edSum, uint pairsCount, uint MS3Numer
@@ -41,6 +47,31 @@ public:
     void enableRestartScheme(double minutesNewAlignments, uint iterationsPerStep,
         uint numCandidates, double minutesPerCandidate, double minutesFinalist);
 
+    //anneal numReplicas alignments in parallel, one per thread
+    void enableReplicas(uint numReplicas);
+
+    //check the incrementally computed score against a from-scratch evaluation
+    //every step-th progress report (never if 0), on a background thread unless sync
+    void setScoreCheck(uint step, bool sync);
+
+    //Checkpoints: every everySeconds of annealing, the whole state of the run
+    //(alignment, iteration, schedule, random generator, incremental sums and
+    //pBad buffer) is written to fileName. After resumeFrom, run() continues a
+    //run exactly where its checkpoint was written, except for an asynchronous
+    //score check still pending at that point, which is dropped. Neither works
+    //with the restart scheme or with replicas.
+    void enableCheckpoints(const string& fileName, double everySeconds);
+    void resumeFrom(const string& fileName);
+
+    //Hill climbing over the complete change and swap neighborhoods of the
+    //unlocked nodes, scored incrementally under the sum objective. A step scans
+    //the neighborhoods on numThreads threads and applies the best move, or the
+    //first improving one in scan order; it returns false at a local maximum.
+    void initHillClimbing(const Alignment& startA);
+    bool hillClimbingStep(uint numThreads, bool firstImprovement);
+    double getCurrentScore() const { return currentScore; }
+    Alignment getAlignment() const { return *A; }
+
     //set temperature schedule automatically
     double temperatureBracket(double l, bool b); //Helper function in finding lower / upper bound for initial temperature
 	void findingUpperLowerTemperatureBound(double& low, double& high); //Finds the initial lower / upper bound for temperature
@@ -48,6 +79,11 @@ public:
     void searchTemperaturesByStatisticalTest();
     void setTDecay(double t);
     void setTDecayAutomatically();
+
+    //TInitial, TFinal and TDecay as fitted by an earlier run on the same networks and
+    //objective; settings describes everything else the estimation depended on
+    bool loadSchedule(const string& settings);
+    void saveSchedule(const string& settings);
     //to compute TDecay automatically
     //returns a value of lambda such that with this TInitial, temperature reaches
     //0 after a certain number of minutes
@@ -77,6 +113,8 @@ public:
     double searchSpaceSizeLog();
     string startAligName = "";
     void prune(string& startAligName);
+    //start from this alignment instead of a random one (or -startalignment)
+    void setStartingAlignment(const Alignment& A) { startMapping = A.getMapping(); }
 
     //to compute TDecay automatically
     //returns a value of lambda such that with this TInitial, temperature reaches
@@ -113,10 +151,11 @@ private:
     double g2WeightedEdges;
 #endif
     double g2Edges; //stored as double because it appears in division
-    Matrix<MATRIX_UNIT> G1Matrix;
-    Matrix<MATRIX_UNIT> G2Matrix;
-    vector<vector<uint> > G1AdjLists;
-    vector<vector<uint> > G2AdjLists;
+    //owned by G1 and G2 and shared by all replicas (see -threads); only prune() writes to them
+    Matrix<MATRIX_UNIT>& G1Matrix;
+    Matrix<MATRIX_UNIT>& G2Matrix;
+    const vector<vector<uint> >& G1AdjLists;
+    const vector<vector<uint> >& G2AdjLists;
 
     Matrix<float>& G1FloatWeights;
     Matrix<float>& G2FloatWeights;
@@ -125,22 +164,27 @@ private:
     vector<uint> unLockedNodesG1;
     bool nodesHaveType = false;
     //random number generation
-    mt19937 gen;
-    uniform_int_distribution<> G1RandomNode;
+    Xoshiro256 gen;
     uniform_int_distribution<> G1RandomUnlockedNodeDist;
     uniform_int_distribution<> G2RandomUnassignedNode;
-    uniform_real_distribution<> randomReal;
     uniform_int_distribution<> G1RandomUnlockedGeneDist;
     uniform_int_distribution<> G1RandomUnlockedmiRNADist;
     uniform_int_distribution<> G2RandomUnassignedGeneDist;
     uniform_int_distribution<> G2RandomUnassignedmiRNADist;
 
+    //move sampling. Locking and node types are resolved once by initMoveSampler:
+    //a G1 node to swap with source1 comes from G1UnlockedPools[G1PoolOf[source1]],
+    //and the new target of a change from oldTarget is an index into
+    //*G2UnassignedPools[G2PoolOf[oldTarget]]. Without node types there is a
+    //single pool on each side and every node maps to it.
+    vector<uint> G1UnlockedPools[2];
+    vector<uint8_t> G1PoolOf;
+    vector<uint>* G2UnassignedPools[2];
+    vector<uint8_t> G2PoolOf;
+    void initMoveSampler();
 
     uint G1RandomUnlockedNode();
-    uint G1RandomUnlockedNode(uint source1); // used in nodes-have-type because
-    uint G1RandomUnlockedNode_Fast();
-    uint G2RandomUnlockedNode(uint target1);
-    uint G2RandomUnlockedNode_Fast();
+    uint G1RandomUnlockedNode(uint source1); //of the same type as source1
 
     //temperature schedule
     double TInitial;
@@ -161,6 +205,11 @@ private:
     double SANAtime;
 
     double Temperature;
+    //iterations between temperature updates; the schedule is piecewise constant
+    static const long long int TEMPERATURE_STEP = 1024;
+    long long int temperatureIter = -1; //last iteration updateTemperature saw
+    long long int runIterations = 0; //length of the current run, for trackProgress
+    void updateTemperature(long long int iter);
     double temperatureFunction(long long int iter, double TInitial, double TDecay);
     double acceptingProbability(double energyInc, double Temperature);
     double trueAcceptingProbability();
@@ -170,8 +219,8 @@ private:
     bool isRandomTInitial(double TInitial, double highThresholdScore, double lowThresholdScore);
     double scoreRandom();
 
-    double TrimCoreScores(Matrix<ulong>& Freq, vector<ulong>& numPegSamples);
-    double TrimCoreScores(Matrix<double>& Freq, vector<double>& totalPegWeight);
+    template <typename T, typename Total>
+    double TrimCoreScores(const PegHoleFrequency<T>& Freq, const vector<Total>& totalPegWeight);
 
     bool initializedIterPerSecond;
     double iterPerSecond;
@@ -196,7 +245,8 @@ private:
     //objective function
     MeasureCombination* MC;
     double eval(const Alignment& A);
-    bool scoreComparison(double newAligEdges, double newInducedEdges, double newTCSum, double newLocalScoreSum, double newWecSum, double newNcSum, double& newCurrentScore, double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer, double newEdgeDifferenceSum, double newMS3Numer);
+    bool scoreComparison(double newAligEdges, double newInducedEdges, double newTCSum, double newLocalScoreSum, double newWecSum, double newNcSum, double& newCurrentScore, double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer, double newEdgeDifferenceSum, double newMS3Numer, double newSpcSum);
+    double sumScore(double newAligEdges, double newInducedEdges, double newTCSum, double newLocalScoreSum, double newWecSum, double newNcSum, double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer, double newEdgeDifferenceSum, double newMS3Numer, double newSpcSum) const;
     double ecWeight;
     double edWeight;
     double s3Weight;
@@ -211,6 +261,7 @@ private:
     double ms3Weight;
     double ewecWeight;
     double TCWeight;
+    double spcWeight;
 
     enum class Score{sum, product, inverse, max, min, maxFactor, pareto};
     Score score;
@@ -238,6 +289,22 @@ private:
     uint getLowestIndex() const;
     uint getHighestIndex() const;
 
+    //replicas: independent anneals on the same schedule that share the networks
+    //and similarity matrices. Every iterationsPerStep iterations the worst one
+    //continues from a copy of the best one.
+    uint numReplicas = 1;
+    vector<SANA*> createReplicas(uint count);
+    Alignment replicaRun(const Alignment& startA, double maxExecutionSeconds, long long int maxExecutionIterations,
+        long long int& iter);
+    void annealSteps(long long int iter, long long int endIter);
+    void copyStateFrom(const SANA& other);
+
+    //the score after a move of the hill climbing neighborhoods, which is
+    //also made if apply; without apply the state is left untouched, so
+    //several threads can score moves at once (except with MS3)
+    double changeScore(uint source, uint newTargetIndex, bool apply);
+    double swapScore(uint source1, uint source2, bool apply);
+
 
     //to evaluate EC incrementally
     bool needAligEdges;
@@ -285,6 +352,15 @@ private:
     double TCIncChangeOp(uint source, uint oldTarget, uint newTarget);
     double TCIncSwapOp(uint source1, uint source2, uint target1, uint target2);
 
+    //to evaluate SPC incrementally: spcSum is the sum of the distance
+    //differences over all pairs, and a move changes only the pairs of the
+    //moved nodes, so it costs one pass over a row of each distance matrix
+    bool needSpc;
+    double spcSum;
+    ShortestPathConservation* spc;
+    double SPCIncChangeOp(uint source, uint oldTarget, uint newTarget);
+    double SPCIncSwapOp(uint source1, uint source2, uint target1, uint target2);
+
     //to evaluate nc incrementally
     bool needNC;
     int ncSum;
@@ -295,7 +371,7 @@ private:
     //to evaluate wec incrementally
     bool needWec;
     double wecSum;
-    vector<vector<float> > wecSims;
+    const SimMatrix& wecSims; //owned by the WEC node measure
     double WECIncChangeOp(uint source, uint oldTarget, uint newTarget);
     double WECIncSwapOp(uint source1, uint source2, uint target1, uint target2);
 
@@ -310,21 +386,19 @@ private:
     //to evaluate local measures incrementally
     bool needLocal;
     double localScoreSum;
-    map<string, double>* localScoreSumMap;
-    vector<vector<float> > sims;
+    const SimMatrix& sims; //owned by MC
 #ifdef CORES
 #if UNWEIGHTED_CORES
-    Matrix<ulong> pegHoleFreq;
+    PegHoleFrequency<ulong> pegHoleFreq;
     vector<ulong> numPegSamples; // number of times this node in g1 was sampled.
 #endif
-    Matrix<double> weightedPegHoleFreq_pBad; // weighted by 1-pBad
+    PegHoleFrequency<double> weightedPegHoleFreq_pBad; // weighted by pBad
     vector<double> totalWeightedPegWeight_pBad;
-    Matrix<double> weightedPegHoleFreq_1mpBad; // weighted by 1-pBad
+    PegHoleFrequency<double> weightedPegHoleFreq_1mpBad; // weighted by 1-pBad
     vector<double> totalWeightedPegWeight_1mpBad;
 #endif
-    map<string, vector<vector<float> > > localSimMatrixMap;
-    double localScoreSumIncChangeOp(vector<vector<float> > const & sim, uint const & source, uint const & oldTarget, uint const & newTarget);
-    double localScoreSumIncSwapOp(vector<vector<float> > const & sim, uint const & source1, uint const & source2, uint const & target1, uint const & target2);
+    double localScoreSumIncChangeOp(SimMatrix const & sim, uint const & source, uint const & oldTarget, uint const & newTarget);
+    double localScoreSumIncSwapOp(SimMatrix const & sim, uint const & source1, uint const & source2, uint const & target1, uint const & target2);
 
 
 
@@ -332,6 +406,18 @@ private:
     bool constantTemp; //tempertare does not decrease as a function of iteration
     bool enableTrackProgress; //shows output periodically
     void trackProgress(long long int i, bool end = false);
+
+    //drift check of currentScore, see setScoreCheck
+    uint scoreCheckStep = 1;
+    bool scoreCheckSync = false;
+    uint progressSteps = 0;
+    long long int lastCheckedIter = -1; //the iteration of the last checked snapshot
+    long long int lastCorrectionIter = -1; //snapshots from before it are stale
+    vector<pair<Measure*, double> > objectiveMeasures; //the non-local measures of the objective, with their weights
+    unique_ptr<SnapshotVerifier> scoreVerifier; //created by the first asynchronous check
+    double evalObjective(const vector<uint>& mapping);
+    void checkScore(long long int i, bool end);
+    void applyScoreCheck(const SnapshotVerifier::Result& res, long long int i);
     double avgEnergyInc;
 
 
@@ -353,9 +439,40 @@ private:
     double sampledProbability[CIRCULAR_BUFFER_SIZE];
     int sampledProbabilitySize = 0;
     void SANAIteration();
+    void genericIteration();
     void performChange(int type);
     void performSwap(int type);
 
+    //the incremental sums after a change or a swap (-1 for unused measures),
+    //shared by the annealing and hill climbing, and the MS3 degree counts of
+    //the two G2 nodes involved, which the MS3 ops update and a rejected move restores
+    struct MoveSums {
+        int aligEdges, inducedEdges;
+        double edSum, squaredAligEdges, exposedEdgesNumer, MS3Numer, TCSum;
+        double localScoreSum, wecSum, ewecSum, ncSum, spcSum;
+        unsigned oldTarget1Deg = 0, oldTarget2Deg = 0, oldMs3Denom = 0;
+    };
+    void changeSums(uint source, uint oldTarget, uint newTarget, MoveSums& sums);
+    void swapSums(uint source1, uint source2, uint target1, uint target2, MoveSums& sums);
+    void storeSums(const MoveSums& sums);
+    void restoreMS3(uint target1, uint target2, const MoveSums& sums);
+    bool acceptBadMove(double energyInc, double& badProbability);
+    void sampleBadProbability(double badProbability);
+
+    //Iteration kernels specialized for the most common objectives. Each one
+    //only updates the incremental sums its terms need and always scores as a
+    //sum, so the per-move branches on the need* flags and on score fold away.
+    //chooseIterationKernel picks one when a run starts; any other objective
+    //goes through genericIteration.
+    enum KernelTerm { EC_TERM = 1, S3_TERM = 2, ICS_TERM = 4, LOCAL_TERM = 8, WEC_TERM = 16, MS3_TERM = 32 };
+    void (SANA::*iterationKernel)() = &SANA::genericIteration;
+    void chooseIterationKernel();
+    template<uint Terms> void kernelIteration();
+    template<uint Terms> void kernelChange();
+    template<uint Terms> void kernelSwap();
+    template<uint Terms> bool kernelAccept(double newAligEdges, double newInducedEdges, double newLocalScoreSum,
+        double newWecSum, double newMS3Numer, double& newCurrentScore);
+
 
     //others
     Timer timer;
@@ -368,9 +485,29 @@ private:
     Alignment getStartingAlignment();
     bool implementsLocking(){ return true; }
 
+    //pBad after annealing at a constant temperature; a batch of temperatures is
+    //sampled concurrently, each by its own replica
     double pForTInitial(double TInitial);
-    double getPforTInitial(const Alignment& startA, double maxExecutionSeconds,
-        long long int& iter);
+    vector<double> pForTInitials(const vector<double>& temperatures);
+    double samplePBad(double maxExecutionSeconds, long long int& iter);
+    //the first of start, start+step, start+2*step, ... (log10 temperatures) whose pBad satisfies found
+    double walkLog10Temperature(double start, double step, const function<bool(double)>& found,
+        const string& label);
+    uint64_t objectiveKey();
+    string scheduleCacheFile(const string& settings, uint64_t& key);
+
+    //checkpoints, see enableCheckpoints
+    string checkpointFileName;
+    double checkpointSeconds = 0;
+    double lastCheckpointTime = 0;
+    string resumeFileName;
+    vector<uint> resumeMapping;
+    long long int resumedIter = -1; //its progress report was made before the checkpoint
+    vector<uint> startMapping; //see setStartingAlignment
+    void saveCheckpoint(long long int iter);
+    void readCheckpointHeader(cereal::BinaryInputArchive& archive, const string& fileName);
+    void restoreCheckpoint(long long int& iter);
+    template<class Archive> void checkpointState(Archive& archive, long long int& iter, double& elapsed);
     string getFolder();
     string haveFolder();
     string mkdir(const std::string& file);
@@ -419,7 +556,6 @@ private:
     unordered_map<vector<uint>*, double> storedTCSum;
     unordered_map<vector<uint>*, double> storedEdSum;
     unordered_map<vector<uint>*, double> storedCurrentScore;
-    unordered_map<vector<uint>*, map<string, double>*> storedLocalScoreSumMap;
     typedef double (*calc)(PARAMS);
     unordered_map<string, calc> measureCalculation;
     unordered_set<string> localScoreNames = { "edgec", "edged", "esim", "go", "graphlet",
@@ -437,7 +573,6 @@ private:
         vector<uint> *unassignedNodesG2;
         vector<uint> *unassignedmiRNAsG2;
         vector<uint> *unassignedgenesG2;
-        map<string, double> *localScoreSumMap;
         int aligEdges;
         int squaredAligEdges;
 		int exposedEdgesNumer;
@@ -464,9 +599,8 @@ private:
         double Temperature;
 		vector<double> sampledProbability;
 
-        // mt19937 is a random generator that is implemented with mutex.
-        // Which means each thread should have an unique random generator.
-        mt19937 gen;
+        // Each thread has its own random generator, seeded differently.
+        Xoshiro256 gen;
     };
     vector<Job> jobs;
     void initializeJobs();
@@ -503,7 +637,7 @@ private:
 	int exposedEdgesIncChangeOp(Job &job, uint source, uint oldTarget, uint newTarget);
     int inducedEdgesIncChangeOp(Job &job, uint source, uint oldTarget, uint newTarget);
     double TCIncChangeOp(Job &job, uint source, uint oldTarget, uint newTarget);
-    double localScoreSumIncChangeOp(Job &job, vector<vector<float> > const & sim, uint const & source, uint const & oldTarget, uint const & newTarget);
+    double localScoreSumIncChangeOp(Job &job, SimMatrix const & sim, uint const & source, uint const & oldTarget, uint const & newTarget);
     double WECIncChangeOp(Job &job, uint source, uint oldTarget, uint newTarget);
     double EWECSimCombo(Job &job, uint source, uint target);
     double EWECIncChangeOp(Job &job, uint source, uint oldTarget, uint newTarget);
@@ -518,7 +652,7 @@ private:
     double WECIncSwapOp(Job &job, uint source1, uint source2, uint target1, uint target2);
     double EWECIncSwapOp(Job &job, uint source1, uint source2, uint target1, uint target2);
     int ncIncSwapOp(Job &job, uint source1, uint source2, uint target1, uint target2);
-    double localScoreSumIncSwapOp(Job &job, vector<vector<float> > const & sim, uint const & source1, uint const & source2, uint const & target1, uint const & target2);
+    double localScoreSumIncSwapOp(Job &job, SimMatrix const & sim, uint const & source1, uint const & source2, uint const & target1, uint const & target2);
 
     bool scoreComparison(Job &job, double newAligEdges, double newInducedEdges, double newTCSum,
                          double newLocalScoreSum, double newWecSum, double newNcSum, double& newCurrentScore,
@@ -77,7 +77,7 @@ private:
     //to evaluate wec incrementally
     bool needWec;
     double wecSum;
-    vector<vector<float> > wecSims;
+    SimMatrix wecSims;
     double WECIncChangeOp(uint source, uint oldTarget, uint newTarget);
     double WECIncSwapOp(uint source1, uint source2, uint target1, uint target2);
 
@@ -85,7 +85,7 @@ private:
     //to evaluate local measures incrementally
     bool needLocal;
     double localScoreSum;
-    vector<vector<float> > sims;
+    SimMatrix sims;
     double localScoreSumIncChangeOp(uint source, uint oldTarget, uint newTarget);
     double localScoreSumIncSwapOp(uint source1, uint source2, uint target1, uint target2);
 
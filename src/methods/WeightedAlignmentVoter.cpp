@@ -10,42 +10,65 @@ WeightedAlignmentVoter::WeightedAlignmentVoter(Graph* G1, Graph* G2, LocalMeasur
 
 }
 
-uint WeightedAlignmentVoter::addBestPair(const vector<vector<double> >& simMatrix, vector<bool>& alreadyAlignedG1, vector<bool>& alreadyAlignedG2) {
-    uint n1 = simMatrix.size();
-    uint n2 = simMatrix[0].size();
-    uint bestNodeG1 = -1;
-    uint bestNodeG2 = -1;
-    double bestScore = -1;
-    for (uint i = 0; i < n1; i++) {
-        if (not alreadyAlignedG1[i]) {
-            for (uint j = 0; j < n2; j++) {
-                if (not alreadyAlignedG2[j]) {
-                    if (simMatrix[i][j] > bestScore) {
-                        bestNodeG1 = i;
-                        bestNodeG2 = j;
-                        bestScore = simMatrix[i][j];
-                    }
-                }
-            }
+void WeightedAlignmentVoter::pushRow(uint nodeG1) {
+    rowMaxima.push({votes[nodeG1][bestColumn[nodeG1]], nodeG1, ++rowVersion[nodeG1]});
+}
+
+void WeightedAlignmentVoter::rescanRow(uint nodeG1) {
+    const float* row = votes[nodeG1];
+    uint n2 = votes.numCols();
+    uint best = n2;
+    for (uint j = 0; j < n2; j++) {
+        if (not alreadyAlignedG2[j] and (best == n2 or row[j] > row[best])) {
+            best = j;
+        }
+    }
+    bestColumn[nodeG1] = best;
+    pushRow(nodeG1);
+}
+
+uint WeightedAlignmentVoter::addBestPair() {
+    while (true) {
+        RowBest top = rowMaxima.top();
+        rowMaxima.pop();
+        uint i = top.node;
+        if (alreadyAlignedG1[i] or top.version != rowVersion[i]) {
+            continue; //superseded by a later entry of the same row
         }
+        if (alreadyAlignedG2[bestColumn[i]]) {
+            rescanRow(i);
+            continue;
+        }
+        A[i] = bestColumn[i];
+        alreadyAlignedG1[i] = true;
+        alreadyAlignedG2[A[i]] = true;
+        return i;
     }
-    A[bestNodeG1] = bestNodeG2;
-    alreadyAlignedG1[bestNodeG1] = true;
-    alreadyAlignedG2[bestNodeG2] = true;
-    return bestNodeG1;
 }
 
-void WeightedAlignmentVoter::updateNeighbors(const vector<bool>& alreadyAlignedG1, const vector<bool>& alreadyAlignedG2, uint node, const vector<vector<double> >& nodeSimMatrix, vector<vector<double> >& simMatrix) {
-    vector<vector<uint> > adjListsG1, adjListsG2;
-    G1->getAdjLists(adjListsG1);
-    G2->getAdjLists(adjListsG2);
+void WeightedAlignmentVoter::raiseVotes(uint nodeG1, uint nodeG2, float increment) {
+    float* row = votes[nodeG1];
+    row[nodeG2] += increment;
+    uint& best = bestColumn[nodeG1];
+    if (nodeG2 == best) {
+        pushRow(nodeG1);
+    } else if (row[nodeG2] > row[best] or (row[nodeG2] == row[best] and nodeG2 < best)) {
+        best = nodeG2;
+        pushRow(nodeG1);
+    }
+}
+
+void WeightedAlignmentVoter::updateNeighbors(uint node) {
+    const vector<vector<uint> >& adjListsG1 = G1->getAdjLists();
+    const vector<vector<uint> >& adjListsG2 = G2->getAdjLists();
+    const SimMatrix& nodeSimMatrix = *(nodeSim->getSimMatrix());
     for (uint neighborG1 : adjListsG1[node]) {
         if (not alreadyAlignedG1[neighborG1]) {
             for (uint neighborG2 : adjListsG2[A[node]]) {
                 if (not alreadyAlignedG2[neighborG2]) {
-                    simMatrix[neighborG1][neighborG2] +=
+                    raiseVotes(neighborG1, neighborG2,
                         nodeSimMatrix[neighborG1][neighborG2] +
-                        nodeSimMatrix[node][A[node]];
+                        nodeSimMatrix[node][A[node]]);
                 }
             }
         }
@@ -53,23 +76,24 @@ void WeightedAlignmentVoter::updateNeighbors(const vector<bool>& alreadyAlignedG
 }
 
 Alignment WeightedAlignmentVoter::run() {
-    int n1 = G1->getNumNodes();
-    int n2 = G2->getNumNodes();
-    vector<vector<double> > nodeSimMatrix(n1, vector<double> (n2));
-    vector<vector<double> > simMatrix(n1, vector<double> (n2));
-    for (int i = 0; i < n1; i++) {
-        for (int j = 0; j < n2; j++) {
-            nodeSimMatrix[i][j] = (*(nodeSim->getSimMatrix()))[i][j];
-            simMatrix[i][j] = nodeSimMatrix[i][j];
-        }
-    }
+    uint n1 = G1->getNumNodes();
+    uint n2 = G2->getNumNodes();
+    votes = *(nodeSim->getSimMatrix());
     A = vector<uint> (n1);
-    vector<bool> alreadyAlignedG1(n1, false);
-    vector<bool> alreadyAlignedG2(n2, false);
-    for (int i = 0; i < n1; i++) {
-        uint newNode = addBestPair(simMatrix, alreadyAlignedG1, alreadyAlignedG2);
-        updateNeighbors(alreadyAlignedG1, alreadyAlignedG2, newNode, nodeSimMatrix, simMatrix);
+    alreadyAlignedG1 = vector<bool> (n1, false);
+    alreadyAlignedG2 = vector<bool> (n2, false);
+    bestColumn = vector<uint> (n1);
+    rowVersion = vector<uint> (n1, 0);
+    rowMaxima = priority_queue<RowBest>();
+    for (uint i = 0; i < n1; i++) {
+        rescanRow(i);
+    }
+    for (uint i = 0; i < n1; i++) {
+        uint newNode = addBestPair();
+        updateNeighbors(newNode);
     }
+    votes = SimMatrix();
+    rowMaxima = priority_queue<RowBest>();
     return A;
 }
 
@@ -1,10 +1,23 @@
 #ifndef WEIGHTEDALIGNMENTVOTER_HPP
 #define WEIGHTEDALIGNMENTVOTER_HPP
 #include <iostream>
+#include <queue>
 #include "Method.hpp"
 #include "../measures/localMeasures/LocalMeasure.hpp"
 using namespace std;
 
+/*
+WAVE: greedily adds the unaligned pair with the most votes, where the votes of
+a pair start at its node similarity and grow every time two of its neighbors
+are aligned to each other.
+
+Instead of rescanning the whole vote matrix for every pair, each G1 node keeps
+its best unaligned G2 node, and a max-heap holds those per-row maxima. A row
+maximum can go stale when its G2 node is taken by another row; it is then still
+an upper bound, so the row is only rescanned when it reaches the top of the heap.
+Ties are broken towards the lowest G1 node and then the lowest G2 node, as in
+a row-major scan.
+*/
 class WeightedAlignmentVoter: public Method {
 public:
     WeightedAlignmentVoter(Graph* G1, Graph* G2, LocalMeasure* nodeSim);
@@ -12,10 +25,28 @@ public:
     void describeParameters(ostream& stream);
     string fileNameSuffix(const Alignment& A);
 private:
+    struct RowBest {
+        float votes;
+        uint node; //in G1
+        uint version; //only the latest entry of each row is current
+        bool operator < (const RowBest& other) const {
+            return votes < other.votes or (votes == other.votes and node > other.node);
+        }
+    };
+
     LocalMeasure* nodeSim;
     vector<uint> A;
-    void updateNeighbors(const vector<bool>& alreadyAlignedG1, const vector<bool>& alreadyAlignedG2, uint node, const vector<vector<double> >& nodeSimMatrix, vector<vector<double> >& simMatrix);
-    uint addBestPair(const vector<vector<double> >& simMatrix, vector<bool>& alreadyAlignedG1, vector<bool>& alreadyAlignedG2);
+    SimMatrix votes;
+    vector<bool> alreadyAlignedG1, alreadyAlignedG2;
+    vector<uint> bestColumn; //best unaligned G2 node of each G1 node, as of its last update
+    vector<uint> rowVersion;
+    priority_queue<RowBest> rowMaxima;
+
+    void updateNeighbors(uint node);
+    void raiseVotes(uint nodeG1, uint nodeG2, float increment);
+    void pushRow(uint nodeG1);
+    void rescanRow(uint nodeG1);
+    uint addBestPair();
 };
 
 #endif
@@ -0,0 +1,34 @@
+#include "ConvertMode.hpp"
+
+#include "../utils/utils.hpp"
+#include "../utils/Timer.hpp"
+
+void ConvertMode::run(ArgumentParser& args) {
+    vector<string> sources;
+    string fg1 = args.strings["-fg1"], fg2 = args.strings["-fg2"];
+    if (fg1 != "" or fg2 != "") {
+        if (fg1 != "") sources.push_back(fg1);
+        if (fg2 != "") sources.push_back(fg2);
+    } else {
+        for (string name : {args.strings["-g1"], args.strings["-g2"]}) {
+            sources.push_back("networks/"+name+"/"+name+".gw");
+        }
+    }
+
+    string output = args.strings["-o"];
+    string folder = output.find('/') == string::npos ? "" : output.substr(0, output.find_last_of('/')+1);
+    for (const string& source : sources) {
+        Timer T;
+        T.start();
+        string name = extractFileNameNoExtension(source);
+        Graph G;
+        Graph::loadGraphFromPath(source, name, G, args.bools["-nodes-have-types"]);
+        string binaryFile = folder+name+".sgb";
+        G.saveBinaryGraph(binaryFile, source);
+        cout << "Converted " << source << " to " << binaryFile << " (" << T.elapsedString() << ")" << endl;
+    }
+}
+
+string ConvertMode::getName(void) {
+    return "ConvertMode";
+}
@@ -0,0 +1,20 @@
+#ifndef CONVERTMODE_HPP_
+#define CONVERTMODE_HPP_
+
+#include "Mode.hpp"
+#include "../Graph.hpp"
+#include "../arguments/ArgumentParser.hpp"
+
+/*
+Converts the input networks to the compact binary format (.sgb), which
+later runs load with -fg1/-fg2 without parsing any text. Converts -fg1 and
+-fg2 if either is given, or else -g1 and -g2; each network is written as
+<name>.sgb in the folder of -o.
+*/
+class ConvertMode : public Mode {
+public:
+    void run(ArgumentParser& args);
+    std::string getName(void);
+};
+
+#endif /* CONVERTMODE_HPP_ */
@@ -0,0 +1,193 @@
+#include "MultiAlignMode.hpp"
+#include "NormalMode.hpp"
+
+#include <mutex>
+#include <numeric>
+#include <iomanip>
+#include <functional>
+
+#include "../utils/utils.hpp"
+#include "../utils/Timer.hpp"
+#include "../utils/parallelFor.hpp"
+#include "../utils/SimMatrix.hpp"
+#include "../arguments/measureSelector.hpp"
+#include "../arguments/methodSelector.hpp"
+#include "../methods/SANA.hpp"
+
+#ifdef MULTI_PAIRWISE
+namespace {
+
+string exactString(double x) {
+    ostringstream oss;
+    oss << setprecision(17) << x;
+    return oss.str();
+}
+
+//the multi-network measures read their denominators from the environment, where
+//multi-pairwise.sh used to put them; values already set there are kept
+void exportMeasureDenominators(const vector<Graph>& networks) {
+    vector<ulong> edges;
+    for (const Graph& G : networks) edges.push_back(G.getNumEdges());
+    sort(edges.begin(), edges.end());
+    uint K = edges.size();
+    //ses: an edge aligned by all the networks with at least m edges scores their count squared
+    double sesDenom = 0;
+    ulong edgeSum = 0, previous = 0;
+    for (uint i = 0; i < K; i++) {
+        sesDenom += (double) (K-i) * (K-i) * (edges[i] - previous);
+        previous = edges[i];
+        edgeSum += edges[i];
+    }
+    setenv("SES_DENOM", exactString(sesDenom).c_str(), 0);
+    setenv("EDGE_SUM", to_string(edgeSum).c_str(), 0);
+    setenv("MAX_EDGE", to_string(edges.back()).c_str(), 0);
+    setenv("NUM_GRAPHS", to_string(K).c_str(), 0);
+}
+
+bool isAutoTemperature(const string& value) {
+    return value == "auto" or value == "by-linear-regression" or value == "by-statistical-test";
+}
+
+}
+#endif
+
+void MultiAlignMode::run(ArgumentParser& args) {
+#ifndef MULTI_PAIRWISE
+    throw runtime_error("-mode multi needs SANA built with -DMULTI_PAIRWISE");
+#else
+    NormalMode::createFolders();
+    const vector<string>& files = args.stringVectors["-multi-networks"];
+    uint K = files.size();
+    if (K < 2) throw runtime_error("-mode multi needs at least 2 networks in -multi-networks");
+    if (K >= (1u << 8*sizeof(MATRIX_UNIT)) - 1) throw runtime_error("too many networks for the shadow edge weights");
+    if (args.bools["-nodes-have-types"] or args.strings["-lock"] != "" or args.bools["-lock-same-names"])
+        throw runtime_error("-mode multi does not support node types or locking");
+    uint numIterations = args.doubles["-multi-iterations"];
+    string output = args.strings["-o"];
+    string shadowName = extractFileName(output) + "-shadow";
+
+    vector<Graph> networks(K);
+    vector<string> names(K);
+    uint numShadowNodes = 0;
+    for (uint k = 0; k < K; k++) {
+        names[k] = extractFileNameNoExtension(files[k]);
+        Graph::loadGraphFromPath(files[k], names[k], networks[k], false);
+        numShadowNodes = max(numShadowNodes, networks[k].getNumNodes());
+    }
+    exportMeasureDenominators(networks);
+
+    //one spare node, as in multi-pairwise.sh, so that the largest network has a hole to move to.
+    //Every network starts with its i-th node on shadow node i.
+    Graph shadow(shadowName, numShadowNodes + 1);
+    vector<vector<uint> > alignments(K);
+    for (uint k = 0; k < K; k++) {
+        alignments[k].resize(networks[k].getNumNodes());
+        iota(alignments[k].begin(), alignments[k].end(), 0);
+        shadow.addMappedEdges(networks[k], alignments[k], 1);
+    }
+
+    uint numThreads = args.doubles["-multi-threads"] > 0 ? (uint) args.doubles["-multi-threads"] : defaultNumThreads();
+    if (args.doubles["-ms3"] > 0) {
+        //MultiS3 keeps its incremental state in static members
+        cout << "ms3 is in the objective: aligning one network at a time" << endl;
+        numThreads = 1;
+    }
+    numThreads = min(numThreads, K);
+
+    //every pruned shadow network is aligned once, so caching the schedules and
+    //similarities fitted to it would only leave files that are never reused
+    simMatrixCache = false;
+    mutex measuresMutex; //the measure constructors are not thread-safe
+    //builds SANA for network k against the shadow network without network k's edges
+    auto withSANA = [&](uint k, uint iter, ArgumentParser& netArgs, function<void(SANA*)> use) {
+        Graph pruned = shadow.prunedShadow(networks[k], alignments[k], shadowName+to_string(iter)+"-"+names[k]);
+        MeasureCombination M;
+        {
+            lock_guard<mutex> lock(measuresMutex);
+            initMeasures(M, networks[k], pruned, netArgs);
+        }
+        SANA* sana = (SANA*) initSANA(networks[k], pruned, netArgs, M);
+        use(sana);
+        delete sana;
+    };
+    auto argsFor = [&](uint k) {
+        ArgumentParser netArgs = args;
+        netArgs.strings["-o"] = output + "-" + names[k];
+        //a checkpoint belongs to a single run
+        netArgs.strings["-checkpoint"] = netArgs.strings["-resume"] = "";
+        netArgs.bools["-no-schedule-cache"] = true;
+        return netArgs;
+    };
+
+    vector<double> TInitial(K), TDecay(K);
+    if (isAutoTemperature(args.strings["-tinitial"]) or isAutoTemperature(args.strings["-tdecay"])) {
+        cout << "Estimating the temperature schedule of each network against the initial shadow network" << endl;
+        parallelFor(K, numThreads, 1, [&](uint begin, uint end, uint) {
+            for (uint k = begin; k < end; k++) {
+                ArgumentParser netArgs = argsFor(k);
+                withSANA(k, 0, netArgs, [&](SANA* sana) {
+                    TInitial[k] = sana->getTInitial();
+                    TDecay[k] = sana->getTDecay();
+                });
+            }
+        });
+    } else {
+        fill(TInitial.begin(), TInitial.end(), stod(args.strings["-tinitial"]));
+        fill(TDecay.begin(), TDecay.end(), stod(args.strings["-tdecay"]));
+    }
+
+    for (uint iter = 0; iter < numIterations; iter++) {
+        Timer T;
+        T.start();
+        vector<vector<uint> > newAlignments(K);
+        parallelFor(K, numThreads, 1, [&](uint begin, uint end, uint) {
+            for (uint k = begin; k < end; k++) {
+                ArgumentParser netArgs = argsFor(k);
+                //the iterations split the schedule into equal slices
+                netArgs.strings["-tinitial"] = exactString(TInitial[k] * exp(-TDecay[k]*iter/numIterations));
+                netArgs.strings["-tdecay"] = exactString(TDecay[k] / numIterations);
+                withSANA(k, iter, netArgs, [&](SANA* sana) {
+                    sana->setStartingAlignment(Alignment(alignments[k]));
+                    newAlignments[k] = sana->run().getMapping();
+                });
+            }
+        });
+        for (uint k = 0; k < K; k++) {
+            shadow.addMappedEdges(networks[k], alignments[k], -1);
+            shadow.addMappedEdges(networks[k], newAlignments[k], 1);
+        }
+        alignments.swap(newAlignments);
+        cout << "Multi-alignment iteration " << iter+1 << "/" << numIterations << " done (" << T.elapsedString()
+             << "): the shadow network has " << shadow.getNumEdges() << " edges of total weight "
+             << shadow.getWeightedNumEdges() << endl;
+    }
+
+    //one row per used shadow node, one column per network ("_" if the network has no node there)
+    vector<vector<string> > rows(shadow.getNumNodes());
+    for (uint k = 0; k < K; k++) {
+        ofstream alignFile(output + "-" + names[k] + ".align");
+        Alignment(alignments[k]).writeEdgeList(&networks[k], &shadow, alignFile);
+        unordered_map<uint,string> nodeNames = networks[k].getIndexToNodeNameMap();
+        for (uint i = 0; i < alignments[k].size(); i++) {
+            vector<string>& row = rows[alignments[k][i]];
+            row.resize(K, "_");
+            row[k] = nodeNames[i];
+        }
+    }
+    ofstream multiAlignFile(output + ".multiAlign.tsv");
+    for (const vector<string>& row : rows) {
+        if (row.empty()) continue;
+        for (uint k = 0; k < K; k++) multiAlignFile << row[k] << (k+1 < K ? "\t" : "\n");
+    }
+    ofstream shadowFile(output + "-shadow.el");
+    for (const vector<uint>& edge : shadow.getEdgeList()) {
+        shadowFile << "shadow" << edge[0] << " shadow" << edge[1] << " " << edge[2] << endl;
+    }
+    cout << "Saved the alignments to " << output << "-<network>.align, " << output << ".multiAlign.tsv and "
+         << output << "-shadow.el" << endl;
+#endif
+}
+
+string MultiAlignMode::getName(void) {
+    return "MultiAlignMode";
+}
@@ -0,0 +1,27 @@
+#ifndef MULTIALIGNMODE_HPP_
+#define MULTIALIGNMODE_HPP_
+
+#include "Mode.hpp"
+#include "../Graph.hpp"
+#include "../arguments/ArgumentParser.hpp"
+
+/*
+Multiple network alignment through a shadow network, in a single process
+(what multi-pairwise.sh does with one sana run per network and iteration).
+The networks of -multi-networks and the weighted shadow network stay in memory:
+every iteration, each network is aligned with SANA to the shadow network
+without its own edges, starting from its previous alignment, and the networks
+are aligned concurrently. Then the shadow edge weights are updated by taking
+out each network's old alignment and adding its new one.
+
+Iteration i of -multi-iterations anneals the i-th slice of each network's
+temperature schedule for -t minutes. Needs a build with -DMULTI_PAIRWISE.
+Writes <-o>-<network>.align, <-o>.multiAlign.tsv and <-o>-shadow.el.
+*/
+class MultiAlignMode : public Mode {
+public:
+    void run(ArgumentParser& args);
+    std::string getName(void);
+};
+
+#endif /* MULTIALIGNMODE_HPP_ */
@@ -20,7 +20,7 @@ void SimilarityMode::run(ArgumentParser& args) {
         exit(-1);
     }
 
-    vector<vector <float> > sim = M.getAggregatedLocalSims();
+    SimMatrix& sim = M.getAggregatedLocalSims();
 
     assert(args.doubleVectors["-simFormat"].size() == 1);
     saveSimilarityMatrix(sim, G1, G2, args.strings["-o"] + ".sim", args.doubleVectors["-simFormat"][0]);
@@ -28,7 +28,7 @@ void SimilarityMode::run(ArgumentParser& args) {
     cout << "Finished. Saved similarity file as " << (args.strings["-o"] + ".sim") << endl;
 }
 
-void SimilarityMode::saveSimilarityMatrix(vector<vector <float> > sim, Graph &G1, Graph &G2, string file, int format) {
+void SimilarityMode::saveSimilarityMatrix(const SimMatrix& sim, Graph &G1, Graph &G2, string file, int format) {
     ofstream outfile;
     outfile.open(file.c_str());
 
@@ -40,7 +40,7 @@ void SimilarityMode::saveSimilarityMatrix(vector<vector <float> > sim, Graph &G1
     switch(format) {
         case 0:
             for(uint i = 0; i < sim.size(); ++i) {
-                for(uint j = 0; j < sim[i].size(); ++j) if(sim[i][j]) {
+                for(uint j = 0; j < sim.numCols(); ++j) if(sim[i][j]) {
                     outfile << i << " " << j << " " << sim[i][j] << endl;
                 }
             }
@@ -49,7 +49,7 @@ void SimilarityMode::saveSimilarityMatrix(vector<vector <float> > sim, Graph &G1
             unordered_map<uint,string> g1Map = G1.getIndexToNodeNameMap();
             unordered_map<uint,string>  g2Map = G2.getIndexToNodeNameMap();
             for(uint i = 0; i < sim.size(); ++i) {
-                for(uint j = 0; j < sim[i].size(); ++j) if(sim[i][j]) {
+                for(uint j = 0; j < sim.numCols(); ++j) if(sim[i][j]) {
                     outfile << g1Map[i] << " " << g2Map[j] << " " << sim[i][j] << endl;
                 }
             }
@@ -1,13 +1,114 @@
 #include "report.hpp"
 
-#include "measures/EdgeCorrectness.hpp"
-#include "measures/InducedConservedStructure.hpp"
-#include "measures/SymmetricSubstructureScore.hpp"
+#include <algorithm>
+#include <limits>
 #include "utils/utils.hpp"
 #include "utils/randomSeed.hpp"
 
 bool multiPairwiseIteration;
 
+/*
+The subgraph of G1 made of the edges that A maps onto edges of G2, analyzed
+straight from the edge lists and the mapping: no Graph is built for it or for
+its connected components. Components are found with union-find and listed
+largest first; the nodes of each component are in increasing order.
+*/
+struct CommonSubgraph {
+  uint numEdges = 0; //aligned edges
+  uint numInducedEdges = 0; //edges of G2 between images of G1 nodes
+  vector<uint> nodes; //the nodes of component c are nodes[start[c]..start[c+1])
+  vector<uint> start;
+  vector<uint> edges, inducedEdges; //per component
+
+  uint numComponents() const { return edges.size(); }
+  uint size(uint c) const { return start[c+1] - start[c]; }
+
+  CommonSubgraph(const Graph& G1, Graph& G2, const Alignment& A) {
+    uint n1 = G1.getNumNodes(), n2 = G2.getNumNodes();
+    const Matrix<MATRIX_UNIT>& G2Matrix = G2.getMatrix();
+
+    vector<uint> parent(n1), rank(n1, 0);
+    for (uint i = 0; i < n1; i++) parent[i] = i;
+    auto find = [&parent](uint x) {
+      while (parent[x] != x) x = parent[x] = parent[parent[x]];
+      return x;
+    };
+    vector<uint> alignedEdgeEnds; //one endpoint of every aligned edge
+    for (const auto& edge : G1.getEdgeList()) {
+      uint node1 = edge[0], node2 = edge[1];
+      if (not G2Matrix.get(A[node1], A[node2])) continue;
+      alignedEdgeEnds.push_back(node1);
+      uint r1 = find(node1), r2 = find(node2);
+      if (r1 == r2) continue;
+      if (rank[r1] < rank[r2]) swap(r1, r2);
+      parent[r2] = r1;
+      if (rank[r1] == rank[r2]) rank[r1]++;
+    }
+    numEdges = alignedEdgeEnds.size();
+
+    //components are numbered by their smallest node, then ranked by size
+    const uint NONE = numeric_limits<uint>::max();
+    vector<uint> idOfRoot(n1, NONE), sizeOfId;
+    for (uint i = 0; i < n1; i++) {
+      uint r = find(i);
+      if (idOfRoot[r] == NONE) {
+        idOfRoot[r] = sizeOfId.size();
+        sizeOfId.push_back(0);
+      }
+      sizeOfId[idOfRoot[r]]++;
+    }
+    uint k = sizeOfId.size();
+    vector<uint> order(k);
+    for (uint c = 0; c < k; c++) order[c] = c;
+    //same comparator and initial order as Graph::initConnectedComponents, so ties come out the same
+    sort(order.begin(), order.end(), [&sizeOfId](uint a, uint b) { return sizeOfId[a] > sizeOfId[b]; });
+    vector<uint> rankOfId(k);
+    for (uint c = 0; c < k; c++) rankOfId[order[c]] = c;
+
+    vector<uint> comp(n1);
+    start = vector<uint>(k+1, 0);
+    for (uint i = 0; i < n1; i++) {
+      comp[i] = rankOfId[idOfRoot[find(i)]];
+      start[comp[i]+1]++;
+    }
+    for (uint c = 0; c < k; c++) start[c+1] += start[c];
+    nodes = vector<uint>(n1);
+    vector<uint> next(start.begin(), start.end()-1);
+    for (uint i = 0; i < n1; i++) nodes[next[comp[i]]++] = i;
+
+    edges = vector<uint>(k, 0);
+    for (uint node : alignedEdgeEnds) edges[comp[node]]++;
+
+    //G2 edges are counted from both ends
+    vector<uint> preimage(n2, NONE);
+    for (uint i = 0; i < n1; i++) preimage[A[i]] = i;
+    const vector<vector<uint> >& G2AdjLists = G2.getAdjLists();
+    inducedEdges = vector<uint>(k, 0);
+    for (uint i = 0; i < n1; i++) {
+      for (uint w : G2AdjLists[A[i]]) {
+        uint j = preimage[w];
+        if (j == NONE) continue;
+        numInducedEdges++;
+        if (comp[j] == comp[i]) inducedEdges[comp[i]]++;
+      }
+    }
+    numInducedEdges /= 2;
+    for (uint& count : inducedEdges) count /= 2;
+  }
+
+  //same layout as Graph::printStats
+  void printStats(int numConnectedComponentsToPrint, ostream& stream) const {
+    stream << "n    = " << nodes.size() << endl;
+    stream << "m    = " << numEdges << endl;
+    stream << "#connectedComponents = " << numComponents() << endl;
+    stream << "Largest connectedComponents (nodes, edges) = ";
+    for (uint c = 0; c < min((uint) numConnectedComponentsToPrint, numComponents()); c++) {
+      stream << "(" << size(c) << ", " << edges[c] << ") ";
+    }
+    stream << endl;
+  }
+};
+
 void makeReport(const Graph& G1, Graph& G2, const Alignment& A,
   const MeasureCombination& M, Method* method, ofstream& stream, bool multiPairwiseIteration = false) {
 
@@ -52,12 +153,12 @@ void makeReport(const Graph& G1, Graph& G2, const Alignment& A,
       Timer T3;
       T3.start();
 
-      Graph CS = A.commonSubgraph(G1, G2);
+      CommonSubgraph CS(G1, G2, A);
       stream << "Common subgraph:" << endl;
       CS.printStats(numCCsToPrint, stream);
       stream << endl;
 
-      int tableRows = min(5, CS.getConnectedComponents().size())+2;
+      int tableRows = min(5u, CS.numComponents())+2;
       vector<vector<string> > table(tableRows, vector<string> (8));
 
       table[0][0] = "Graph"; table[0][1] = "n"; table[0][2] = "m"; table[0][3] = "alig-edges";
@@ -65,25 +166,20 @@ void makeReport(const Graph& G1, Graph& G2, const Alignment& A,
       table[0][6] = "ICS"; table[0][7] = "S3";
 
       table[1][0] = "G1"; table[1][1] = to_string(G1.getNumNodes()); table[1][2] = to_string(G1.getNumEdges());
-      table[1][3] = to_string(A.numAlignedEdges(G1, G2)); table[1][4] = to_string(G2.numNodeInducedSubgraphEdges(A.getMapping()));
+      table[1][3] = to_string(CS.numEdges); table[1][4] = to_string(CS.numInducedEdges);
       table[1][5] = to_string(M.eval("ec",A));
       table[1][6] = to_string(M.eval("ics",A)); table[1][7] = to_string(M.eval("s3",A));
 
       for (int i = 0; i < tableRows-2; i++) {
-	const vector<uint>& nodes = CS.getConnectedComponents()[i];
-	Graph H = CS.nodeInducedSubgraph(nodes);
-	Alignment newA(nodes);
-	newA.compose(A);
-	table[i+2][0] = "CCS_"+to_string(i); table[i+2][1] = to_string(H.getNumNodes());
-	table[i+2][2] = to_string(H.getNumEdges());
-	table[i+2][3] = to_string(newA.numAlignedEdges(H, G2));
-	table[i+2][4] = to_string(G2.numNodeInducedSubgraphEdges(newA.getMapping()));
-	EdgeCorrectness ec(&H, &G2);
-	table[i+2][5] = to_string(ec.eval(newA));
-	InducedConservedStructure ics(&H, &G2);
-	table[i+2][6] = to_string(ics.eval(newA));
-	SymmetricSubstructureScore s3(&H, &G2);
-	table[i+2][7] = to_string(s3.eval(newA));
+	//every edge of a component is aligned, so its EC is 1 (or 0/0 for a single node)
+	double aligEdges = CS.edges[i], induEdges = CS.inducedEdges[i];
+	table[i+2][0] = "CCS_"+to_string(i); table[i+2][1] = to_string(CS.size(i));
+	table[i+2][2] = to_string(CS.edges[i]);
+	table[i+2][3] = to_string(CS.edges[i]);
+	table[i+2][4] = to_string(CS.inducedEdges[i]);
+	table[i+2][5] = to_string(aligEdges / CS.edges[i]);
+	table[i+2][6] = to_string(aligEdges / induEdges);
+	table[i+2][7] = to_string(aligEdges / (CS.edges[i] + induEdges - aligEdges));
       }
 
       stream << "Common connected subgraphs:" << endl;
@@ -92,29 +188,36 @@ void makeReport(const Graph& G1, Graph& G2, const Alignment& A,
 #define PRINT_CCS 1
 #if PRINT_CCS
 #define EDGE_COUNT_DIST 0
-      unordered_map<uint,string> mapG1 = G1.getIndexToNodeNameMap();
-      unordered_map<uint,string> mapG2 = G2.getIndexToNodeNameMap();
-      for(uint cc=0; cc < CS.getConnectedComponents().size(); cc++)
+      vector<string> namesG1 = G1.getNodeNames();
+      vector<string> namesG2 = G2.getNodeNames();
+      const Matrix<MATRIX_UNIT>& G2Matrix = G2.getMatrix();
+      for(uint cc=0; cc < CS.numComponents(); cc++)
       {
 	stream << "CCS_" << cc << " Alignment, local (distance 1 to " << EDGE_COUNT_DIST << ") edge counts and s3 score\n";
-	const vector<uint>& nodes = CS.getConnectedComponents()[cc];
-	if(nodes.size() < 2) break;
-	for(uint i=0; i<nodes.size(); i++)
+	if(CS.size(cc) < 2) break;
+	for(uint i=CS.start[cc]; i<CS.start[cc+1]; i++)
 	{
-	    stream << mapG1[nodes[i]] << '\t' << mapG2[A[nodes[i]]];
+	    uint node = CS.nodes[i];
+	    stream << namesG1[node] << '\t' << namesG2[A[node]];
 	    for(uint d=1; d<=EDGE_COUNT_DIST; d++){
-		uint fullCount=0; vector<uint> V1 = G1.numEdgesAround(nodes[i], d); for(uint j=0;j<d;j++) fullCount+= V1[j];
+		uint fullCount=0; vector<uint> V1 = G1.numEdgesAround(node, d); for(uint j=0;j<d;j++) fullCount+= V1[j];
 		stream << '\t' << fullCount;
-		fullCount=0; vector<uint> V2 = G2.numEdgesAround(A[nodes[i]], d); for(uint j=0;j<d;j++) fullCount+= V2[j];
+		fullCount=0; vector<uint> V2 = G2.numEdgesAround(A[node], d); for(uint j=0;j<d;j++) fullCount+= V2[j];
 		stream << '\t' << fullCount;
-		vector<uint> localNodes(G1.getAllNodesAround(nodes[i], d));
-		Graph H = CS.nodeInducedSubgraph(localNodes);
-		Alignment localA(localNodes);
-		localA.compose(A);
-		SymmetricSubstructureScore s3(&H, &G2);
-		stream << '\t' << to_string(s3.eval(localA));
+		//s3 of the common subgraph induced on the nodes around node: all its edges are aligned
+		vector<uint> localNodes(G1.getAllNodesAround(node, d));
+		vector<bool> isLocal(G1.getNumNodes(), false);
+		for (uint u : localNodes) isLocal[u] = true;
+		double localAligEdges = 0, localInducedEdges = 0;
+		for (uint a = 0; a < localNodes.size(); a++) {
+		    for (uint b = a+1; b < localNodes.size(); b++)
+			if (G2Matrix.get(A[localNodes[a]], A[localNodes[b]])) localInducedEdges++;
+		    for (uint w : G1.getAdjLists()[localNodes[a]])
+			if (w > localNodes[a] and isLocal[w] and G2Matrix.get(A[localNodes[a]], A[w])) localAligEdges++;
+		}
+		stream << '\t' << to_string(localAligEdges / localInducedEdges);
 	    }
-	    stream << endl;
+	    stream << '\n';
 	}
       }
 #endif
@@ -0,0 +1,234 @@
+#include "Decompressor.hpp"
+#include <stdexcept>
+#include <vector>
+#include <climits>
+#include <cstring>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_BZIP2
+#include <bzlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const size_t BUFFER_SIZE = 1 << 20;
+
+string extension(const string& fileName) {
+    return fileName.substr(fileName.find_last_of(".") + 1);
+}
+
+}
+
+class Decompressor::Source {
+public:
+    virtual size_t read(char* buffer, size_t size) = 0;
+    virtual ~Source() {}
+};
+
+namespace {
+
+#ifdef HAVE_ZLIB
+class GzSource : public Decompressor::Source {
+public:
+    GzSource(const string& fileName): fileName(fileName) {
+        file = gzopen(fileName.c_str(), "rb");
+        if (file == NULL) throw runtime_error("Cannot read "+fileName);
+        gzbuffer(file, BUFFER_SIZE);
+    }
+    ~GzSource() { gzclose(file); }
+
+    size_t read(char* buffer, size_t size) {
+        int res = gzread(file, buffer, min(size, (size_t) INT_MAX));
+        if (res <= 0) {
+            //a truncated file reads as the data it has and then as its end,
+            //which only gzerror tells apart from a complete one
+            int error;
+            const char* message = gzerror(file, &error); //starts with the file name
+            if (res < 0 or error == Z_BUF_ERROR) {
+                throw runtime_error(string("Corrupted gzip file: ")+message);
+            }
+        }
+        return res;
+    }
+
+private:
+    string fileName;
+    gzFile file;
+};
+#endif
+
+#ifdef HAVE_BZIP2
+class Bz2Source : public Decompressor::Source {
+public:
+    Bz2Source(const string& fileName): fileName(fileName), stream(NULL), unusedLength(0) {
+        file = fopen(fileName.c_str(), "rb");
+        if (file == NULL) throw runtime_error("Cannot read "+fileName);
+        setvbuf(file, NULL, _IOFBF, BUFFER_SIZE);
+        openStream();
+    }
+    ~Bz2Source() {
+        int error;
+        if (stream) BZ2_bzReadClose(&error, stream);
+        fclose(file);
+    }
+
+    size_t read(char* buffer, size_t size) {
+        size_t done = 0;
+        while (stream and done < size) {
+            int error;
+            int res = BZ2_bzRead(&error, stream, buffer+done, min(size-done, (size_t) INT_MAX));
+            if (error != BZ_OK and error != BZ_STREAM_END) {
+                throw runtime_error("Corrupted bzip2 file "+fileName);
+            }
+            done += res;
+            if (error == BZ_STREAM_END) nextStream();
+        }
+        return done;
+    }
+
+private:
+    string fileName;
+    FILE* file;
+    BZFILE* stream;
+    char unused[BZ_MAX_UNUSED];
+    int unusedLength;
+
+    void openStream() {
+        int error;
+        stream = BZ2_bzReadOpen(&error, file, 0, 0, unused, unusedLength);
+        if (error != BZ_OK) throw runtime_error("Cannot read bzip2 file "+fileName);
+    }
+
+    //a .bz2 file can be several streams back to back
+    void nextStream() {
+        int error;
+        void* leftover;
+        BZ2_bzReadGetUnused(&error, stream, &leftover, &unusedLength);
+        memcpy(unused, leftover, unusedLength);
+        BZ2_bzReadClose(&error, stream);
+        stream = NULL;
+        if (unusedLength == 0) {
+            int c = fgetc(file);
+            if (c == EOF) return;
+            ungetc(c, file);
+        }
+        openStream();
+    }
+};
+#endif
+
+#ifdef HAVE_LZMA
+class XzSource : public Decompressor::Source {
+public:
+    XzSource(const string& fileName): fileName(fileName), input(BUFFER_SIZE), finished(false) {
+        file = fopen(fileName.c_str(), "rb");
+        if (file == NULL) throw runtime_error("Cannot read "+fileName);
+        stream = LZMA_STREAM_INIT;
+        if (lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+            fclose(file);
+            throw runtime_error("Cannot read xz file "+fileName);
+        }
+    }
+    ~XzSource() {
+        lzma_end(&stream);
+        fclose(file);
+    }
+
+    size_t read(char* buffer, size_t size) {
+        stream.next_out = (uint8_t*) buffer;
+        stream.avail_out = size;
+        while (not finished and stream.avail_out > 0) {
+            if (stream.avail_in == 0 and not feof(file)) {
+                stream.next_in = input.data();
+                stream.avail_in = fread(input.data(), 1, input.size(), file);
+            }
+            lzma_ret res = lzma_code(&stream, feof(file) ? LZMA_FINISH : LZMA_RUN);
+            if (res == LZMA_STREAM_END) finished = true;
+            else if (res != LZMA_OK) throw runtime_error("Corrupted xz file "+fileName);
+        }
+        return size - stream.avail_out;
+    }
+
+private:
+    string fileName;
+    FILE* file;
+    lzma_stream stream;
+    vector<uint8_t> input;
+    bool finished;
+};
+#endif
+
+}
+
+bool Decompressor::supports(const string& fileName) {
+    string ext = extension(fileName);
+#ifdef HAVE_ZLIB
+    if (ext == "gz") return true;
+#endif
+#ifdef HAVE_BZIP2
+    if (ext == "bz2") return true;
+#endif
+#ifdef HAVE_LZMA
+    if (ext == "xz") return true;
+#endif
+    return false;
+}
+
+Decompressor::Decompressor(const string& fileName) {
+    string ext = extension(fileName);
+#ifdef HAVE_ZLIB
+    if (ext == "gz") source.reset(new GzSource(fileName));
+#endif
+#ifdef HAVE_BZIP2
+    if (ext == "bz2") source.reset(new Bz2Source(fileName));
+#endif
+#ifdef HAVE_LZMA
+    if (ext == "xz") source.reset(new XzSource(fileName));
+#endif
+    if (not source) throw runtime_error("No in-process decompression for "+fileName);
+}
+
+Decompressor::~Decompressor() {}
+
+size_t Decompressor::read(char* buffer, size_t size) {
+    return source->read(buffer, size);
+}
+
+namespace {
+
+ssize_t cookieRead(void* cookie, char* buffer, size_t size) {
+    try {
+        return ((Decompressor*) cookie)->read(buffer, size);
+    } catch (const exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return -1;
+    }
+}
+
+int cookieClose(void* cookie) {
+    delete (Decompressor*) cookie;
+    return 0;
+}
+
+}
+
+FILE* openDecompressed(const string& fileName) {
+    Decompressor* decompressor = new Decompressor(fileName);
+    cookie_io_functions_t functions;
+    memset(&functions, 0, sizeof(functions));
+    functions.read = cookieRead;
+    functions.close = cookieClose;
+    FILE* fp = fopencookie(decompressor, "r", functions);
+    if (fp == NULL) {
+        delete decompressor;
+        return NULL;
+    }
+    setvbuf(fp, NULL, _IOFBF, BUFFER_SIZE);
+    return fp;
+}
@@ -0,0 +1,39 @@
+#ifndef DECOMPRESSOR_HPP
+#define DECOMPRESSOR_HPP
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+/*
+Streaming, in-process decompression of .gz, .bz2 and .xz files with zlib,
+libbzip2 and liblzma, for the formats whose library SANA was built with
+(see the Makefile). Concatenated streams are read through, like the
+command-line tools do. Formats without their library are still read by
+piping them through the external program (see readFileAsFilePointer).
+*/
+class Decompressor {
+public:
+    //whether fileName is compressed in a format that is decompressed in process
+    static bool supports(const std::string& fileName);
+
+    explicit Decompressor(const std::string& fileName);
+    ~Decompressor();
+    Decompressor(const Decompressor&) = delete;
+    Decompressor& operator=(const Decompressor&) = delete;
+
+    //reads up to size decompressed bytes into buffer; 0 means the end of the
+    //file. Throws runtime_error on corrupted input
+    size_t read(char* buffer, size_t size);
+
+    class Source;
+
+private:
+    std::unique_ptr<Source> source;
+};
+
+//fileName, decompressed in process, as a regular (buffered) FILE* that is
+//closed with fclose
+FILE* openDecompressed(const std::string& fileName);
+
+#endif
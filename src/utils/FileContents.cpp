@@ -0,0 +1,77 @@
+#include "FileContents.hpp"
+#include "utils.hpp"
+#include "Decompressor.hpp"
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+FileContents::FileContents(const string& fileName): data(""), length(0), mapped(false) {
+    checkFileExists(fileName);
+    if (getDecompressionProgram(fileName) == "") {
+        int fd = open(fileName.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 or fstat(fd, &info) != 0) {
+            if (fd >= 0) close(fd);
+            throw runtime_error("Cannot read "+fileName);
+        }
+        length = info.st_size;
+        if (length > 0) {
+            void* map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED) {
+                close(fd);
+                throw runtime_error("Cannot map "+fileName);
+            }
+            madvise(map, length, MADV_SEQUENTIAL);
+            data = (const char*) map;
+            mapped = true;
+        }
+        close(fd);
+        return;
+    }
+    const size_t BLOCK = 1 << 20;
+    if (Decompressor::supports(fileName)) {
+        Decompressor decompressor(fileName);
+        for (size_t read = BLOCK; read > 0; ) {
+            size_t size = decompressed.size();
+            decompressed.resize(size + BLOCK);
+            read = decompressor.read(&decompressed[size], BLOCK);
+            decompressed.resize(size + read);
+        }
+    } else {
+        bool piped;
+        FILE* fp = readFileAsFilePointer(fileName, piped);
+        if (fp == NULL) throw runtime_error("Cannot read "+fileName);
+        for (size_t read = BLOCK; read == BLOCK; ) {
+            size_t size = decompressed.size();
+            decompressed.resize(size + BLOCK);
+            read = fread(&decompressed[size], 1, BLOCK, fp);
+            decompressed.resize(size + read);
+        }
+        closeFile(fp, piped);
+    }
+    data = decompressed.data();
+    length = decompressed.size();
+}
+
+FileContents::~FileContents() {
+    if (mapped) munmap((void*) data, length);
+}
+
+vector<const char*> FileContents::lineChunks(unsigned int numChunks, const char* from) const {
+    if (from == nullptr) from = begin();
+    vector<const char*> res(1, from);
+    size_t size = end() - from;
+    for (unsigned int k = 1; k < numChunks; k++) {
+        const char* p = max(res.back(), from + size/numChunks*k);
+        if (p == end()) break;
+        const char* newline = (const char*) memchr(p, '\n', end() - p);
+        if (newline == NULL) break;
+        res.push_back(newline + 1);
+    }
+    res.push_back(end());
+    return res;
+}
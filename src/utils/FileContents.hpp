@@ -0,0 +1,82 @@
+#ifndef FILECONTENTS_HPP
+#define FILECONTENTS_HPP
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+/*
+The whole contents of a (possibly compressed) text file, for the loaders
+that tokenize it by hand. Plain files are memory-mapped; compressed ones are
+decompressed into memory in large blocks. Tokens are spans of the contents,
+so they stay valid as long as the FileContents does.
+*/
+class FileContents {
+public:
+    explicit FileContents(const std::string& fileName);
+    ~FileContents();
+    FileContents(const FileContents&) = delete;
+    FileContents& operator=(const FileContents&) = delete;
+
+    const char* begin() const { return data; }
+    const char* end() const { return data + length; }
+
+    //about numChunks consecutive pieces of [from, end), each starting at the
+    //beginning of a line; chunk k is [res[k], res[k+1]). from defaults to begin
+    std::vector<const char*> lineChunks(unsigned int numChunks, const char* from = nullptr) const;
+
+private:
+    const char* data;
+    size_t length;
+    bool mapped;
+    std::string decompressed;
+};
+
+//span of a whitespace-delimited token
+struct Token {
+    const char* begin = nullptr;
+    unsigned int length = 0;
+
+    bool empty() const { return length == 0; }
+    std::string str() const { return std::string(begin, length); }
+    bool operator==(const Token& other) const {
+        return length == other.length and memcmp(begin, other.begin, length) == 0;
+    }
+};
+
+//the line that starts at p, without the newline; p is moved past the newline
+inline Token nextLine(const char*& p, const char* end) {
+    Token line;
+    line.begin = p;
+    const char* newline = (const char*) memchr(p, '\n', end - p);
+    const char* lineEnd = newline ? newline : end;
+    line.length = lineEnd - p;
+    p = newline ? newline + 1 : end;
+    return line;
+}
+
+//the next token of [p, end), skipping blanks (also '\r'); p is moved past it
+inline Token nextToken(const char*& p, const char* end) {
+    while (p < end and (*p == ' ' or *p == '\t' or *p == '\r')) p++;
+    Token token;
+    token.begin = p;
+    while (p < end and *p != ' ' and *p != '\t' and *p != '\r') p++;
+    token.length = p - token.begin;
+    return token;
+}
+
+//parses a token made only of digits into value
+inline bool parseUint(const Token& token, unsigned int& value) {
+    if (token.empty()) return false;
+    unsigned long long res = 0;
+    for (unsigned int i = 0; i < token.length; i++) {
+        unsigned int digit = token.begin[i] - '0';
+        if (digit > 9) return false;
+        res = res*10 + digit;
+        if (res > 0xFFFFFFFFull) return false;
+    }
+    value = res;
+    return true;
+}
+
+#endif
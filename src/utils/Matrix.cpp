@@ -1,3 +1,3 @@
 #include "Matrix.hpp"
 
-
+bool sparseMatrix = false;
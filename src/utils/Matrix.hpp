@@ -2,8 +2,12 @@
 #define MATRIX_HPP
 
 #include "utils.hpp"
-#include "SparseMatrix.hpp"
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
 
 using namespace std;
 typedef unsigned char uchar;
@@ -14,89 +18,315 @@ typedef unsigned char uchar;
     #define MATRIX_UNIT bool
 #endif
 
-#ifdef SPARSE
-    #define INNER_CONTAINER unordered_map<uint, T>
-    #define MATRIX_DATA_STRUCTURE SparseMatrix<T>
-#else
-    #define INNER_CONTAINER vector<T>
-    #define MATRIX_DATA_STRUCTURE vector<vector<T> >
-#endif
+// Every row of a dense Matrix starts on its own cache line.
+#define MATRIX_ALIGNMENT 64
+
+// Set by the -sparse argument: graph adjacency matrices use the sparse (CSR) layout instead of the dense one.
+extern bool sparseMatrix;
+
+/*
+Minimal allocator handing out MATRIX_ALIGNMENT-aligned blocks, so that a dense
+Matrix is a single flat allocation whose rows never straddle a cache line boundary.
+*/
+template <typename T>
+class AlignedAllocator {
+public:
+    typedef T value_type;
+
+    AlignedAllocator() {}
+    template <typename U> AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n > numeric_limits<size_t>::max() / sizeof(T)) throw bad_alloc();
+        void* p = nullptr;
+        if (posix_memalign(&p, MATRIX_ALIGNMENT, n * sizeof(T) > 0 ? n * sizeof(T) : MATRIX_ALIGNMENT) != 0)
+            throw bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) { free(p); }
+
+    template <typename U> struct rebind { typedef AlignedAllocator<U> other; };
+};
 
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return false; }
+
+/*
+Cell layout of a dense Matrix<T>: one T per cell, rows padded to a whole number of cache lines.
+*/
+template <typename T>
+struct MatrixCells {
+    typedef T Word;
+
+    static uint wordsPerRow(uint cols) {
+        const uint perLine = sizeof(T) >= MATRIX_ALIGNMENT ? 1 : MATRIX_ALIGNMENT / sizeof(T);
+        return (cols + perLine - 1) / perLine * perLine;
+    }
+    static T get(const Word* row, uint col) { return row[col]; }
+    static void set(Word* row, uint col, T value) { row[col] = value; }
+};
+
+/*
+bool cells are packed 64 per word, so a 20k x 20k adjacency matrix is a single 50MB block
+*/
+template <>
+struct MatrixCells<bool> {
+    typedef uint64_t Word;
+
+    static uint wordsPerRow(uint cols) {
+        const uint bitsPerLine = MATRIX_ALIGNMENT * 8;
+        return (cols + bitsPerLine - 1) / bitsPerLine * (MATRIX_ALIGNMENT / sizeof(Word));
+    }
+    static bool get(const Word* row, uint col) { return (row[col >> 6] >> (col & 63)) & 1; }
+    static void set(Word* row, uint col, bool value) {
+        if (value) row[col >> 6] |= uint64_t(1) << (col & 63);
+        else row[col >> 6] &= ~(uint64_t(1) << (col & 63));
+    }
+};
+
+template <typename T> class Matrix;
+
+// Writable reference to one cell, so that m[i][j] = x, m[i][j] += x, etc. work on either layout
+template <typename T>
+class MatrixReference {
+public:
+    MatrixReference(Matrix<T>* matrix, uint row, uint col): matrix(matrix), row(row), col(col) {}
+
+    operator T() const { return matrix->get(row, col); }
+    MatrixReference& operator = (T value) { matrix->set(row, col, value); return *this; }
+    MatrixReference& operator = (const MatrixReference& other) { return *this = T(other); }
+    MatrixReference& operator += (T value) { return *this = T(T(*this) + value); }
+    MatrixReference& operator -= (T value) { return *this = T(T(*this) - value); }
+    MatrixReference& operator ++ () { return *this = T(T(*this) + 1); }
+    MatrixReference& operator -- () { return *this = T(T(*this) - 1); }
+    T operator ++ (int) { T old = *this; ++*this; return old; }
+    T operator -- (int) { T old = *this; --*this; return old; }
+
+private:
+    Matrix<T>* matrix;
+    uint row, col;
+};
+
+// Row view returned by Matrix<T>::operator[] so that m[i][j] keeps working on the flat storage
+template <typename T>
+class MatrixRow {
+public:
+    MatrixRow(Matrix<T>* matrix, uint row): matrix(matrix), row(row) {}
+
+    MatrixReference<T> operator [] (uint col) { return MatrixReference<T>(matrix, row, col); }
+    T operator [] (uint col) const { return matrix->get(row, col); }
+    uint size() const { return matrix->numCols(); }
+
+private:
+    Matrix<T>* matrix;
+    uint row;
+};
+
+/*
+A Matrix has one of two layouts, chosen when it is constructed:
+ - dense: a single flat block (see MatrixCells), O(1) lookups, n*n cells of memory.
+ - sparse: only nonzero cells are stored, each row's columns kept sorted and
+   looked up by binary search. While cells are being inserted each row lives in
+   its own vector; compress() then packs everything into compressed sparse row
+   form (rowOffsets + colIndex + values). Overwriting a stored cell keeps the CSR
+   form, inserting a new one falls back to per-row vectors until the next compress().
+*/
 template <typename T>
 class Matrix {
 public:
     Matrix();
     Matrix(const Matrix & matrix);
     Matrix(uint numberOfNodes);
-    Matrix(uint row, uint col);
+    Matrix(uint row, uint col, bool sparse = false);
 
     Matrix & operator = (const Matrix & matrix);
-    INNER_CONTAINER & operator [] (uint node1);
+    MatrixRow<T> operator [] (uint node1);
 
     const T get(uint node1, uint node2) const;
+    void set(uint node1, uint node2, T value);
     uint size() const;
+    uint numCols() const;
+
+    bool isSparse() const;
+    void compress();
 
     template <class Archive>
     void serialize(Archive & archive) {
-        archive(CEREAL_NVP(data));
+        archive(CEREAL_NVP(rows), CEREAL_NVP(cols), CEREAL_NVP(stride), CEREAL_NVP(data),
+                CEREAL_NVP(sparse), CEREAL_NVP(compressed), CEREAL_NVP(rowOffsets), CEREAL_NVP(colIndex),
+                CEREAL_NVP(values), CEREAL_NVP(openCols), CEREAL_NVP(openValues));
     }
 
 private:
-   MATRIX_DATA_STRUCTURE data;
-};
+    uint rows = 0;
+    uint cols = 0;
+
+    //dense layout
+    uint stride = 0; // words per row, including cache line padding
+    vector<typename MatrixCells<T>::Word, AlignedAllocator<typename MatrixCells<T>::Word> > data;
 
+    //sparse layout
+    bool sparse = false;
+    bool compressed = false;
+    vector<size_t> rowOffsets;
+    vector<uint> colIndex;
+    vector<T> values;
+    vector<vector<uint> > openCols;
+    vector<vector<T> > openValues;
+
+    T sparseGet(uint node1, uint node2) const;
+    void sparseSet(uint node1, uint node2, T value);
+    void decompress();
+};
 
 template <typename T>
-inline INNER_CONTAINER & Matrix<T>::operator [] (uint node1) {
-    return data[node1];
+Matrix<T>::Matrix() {
 }
 
 template <typename T>
-Matrix<T>::Matrix(uint row, uint col) {
-#ifdef SPARSE
-    data = MATRIX_DATA_STRUCTURE(row);
-#else
-    data = MATRIX_DATA_STRUCTURE(row,
-           vector<T>(col, T()));
-#endif
+Matrix<T>::Matrix(const Matrix & matrix) {
+    *this = matrix;
 }
 
 template <typename T>
-inline const T Matrix<T>::get(uint node1, uint node2) const {
-#ifdef SPARSE
-    return data.get(node1, node2);
-#else
-    return data[node1][node2];
-#endif
+Matrix<T>::Matrix(uint numberOfNodes): Matrix(numberOfNodes, numberOfNodes) {
 }
 
 template <typename T>
-Matrix<T>::Matrix() {
+Matrix<T>::Matrix(uint row, uint col, bool sparse):
+    rows(row), cols(col), sparse(sparse) {
+    if (sparse) {
+        openCols = vector<vector<uint> >(rows);
+        openValues = vector<vector<T> >(rows);
+    } else {
+        stride = MatrixCells<T>::wordsPerRow(col);
+        data = decltype(data)((size_t)rows * stride);
+    }
 }
 
 template <typename T>
-Matrix<T>::Matrix(const Matrix & matrix) {
+Matrix<T> & Matrix<T>::operator = (const Matrix & matrix) {
+    rows = matrix.rows;
+    cols = matrix.cols;
+    stride = matrix.stride;
     data = matrix.data;
+    sparse = matrix.sparse;
+    compressed = matrix.compressed;
+    rowOffsets = matrix.rowOffsets;
+    colIndex = matrix.colIndex;
+    values = matrix.values;
+    openCols = matrix.openCols;
+    openValues = matrix.openValues;
+    return *this;
 }
 
 template <typename T>
-Matrix<T>::Matrix(uint numberOfNodes) {
-#ifdef SPARSE
-    data = MATRIX_DATA_STRUCTURE(numberOfNodes);
-#else
-    data = MATRIX_DATA_STRUCTURE(numberOfNodes,
-           vector<T>(numberOfNodes, T()));
-#endif
+inline MatrixRow<T> Matrix<T>::operator [] (uint node1) {
+    return MatrixRow<T>(this, node1);
 }
 
 template <typename T>
-Matrix<T> & Matrix<T>::operator = (const Matrix & matrix) {
-    data = matrix.data;
-    return *this;
+inline const T Matrix<T>::get(uint node1, uint node2) const {
+    if (not sparse) return MatrixCells<T>::get(data.data() + (size_t)node1 * stride, node2);
+    return sparseGet(node1, node2);
+}
+
+template <typename T>
+inline void Matrix<T>::set(uint node1, uint node2, T value) {
+    if (not sparse) MatrixCells<T>::set(data.data() + (size_t)node1 * stride, node2, value);
+    else sparseSet(node1, node2, value);
 }
 
 template <typename T>
 uint Matrix<T>::size() const {
-    return data.size();
+    return rows;
+}
+
+template <typename T>
+uint Matrix<T>::numCols() const {
+    return cols;
+}
+
+template <typename T>
+bool Matrix<T>::isSparse() const {
+    return sparse;
+}
+
+template <typename T>
+T Matrix<T>::sparseGet(uint node1, uint node2) const {
+    if (compressed) {
+        auto first = colIndex.begin() + rowOffsets[node1];
+        auto last = colIndex.begin() + rowOffsets[node1+1];
+        auto it = lower_bound(first, last, node2);
+        return (it != last and *it == node2) ? T(values[it - colIndex.begin()]) : T();
+    }
+    const vector<uint>& rowCols = openCols[node1];
+    auto it = lower_bound(rowCols.begin(), rowCols.end(), node2);
+    return (it != rowCols.end() and *it == node2) ? T(openValues[node1][it - rowCols.begin()]) : T();
+}
+
+template <typename T>
+void Matrix<T>::sparseSet(uint node1, uint node2, T value) {
+    if (compressed) {
+        auto first = colIndex.begin() + rowOffsets[node1];
+        auto last = colIndex.begin() + rowOffsets[node1+1];
+        auto it = lower_bound(first, last, node2);
+        if (it != last and *it == node2) {
+            values[it - colIndex.begin()] = value;
+            return;
+        }
+        if (value == T()) return;
+        decompress();
+    }
+    vector<uint>& rowCols = openCols[node1];
+    vector<T>& rowValues = openValues[node1];
+    auto it = lower_bound(rowCols.begin(), rowCols.end(), node2);
+    uint pos = it - rowCols.begin();
+    if (it != rowCols.end() and *it == node2) {
+        if (value == T()) {
+            rowCols.erase(it);
+            rowValues.erase(rowValues.begin() + pos);
+        } else {
+            rowValues[pos] = value;
+        }
+    } else if (value != T()) {
+        rowCols.insert(it, node2);
+        rowValues.insert(rowValues.begin() + pos, value);
+    }
+}
+
+// Packs the per-row vectors into CSR form. No-op for dense or already compressed matrices.
+template <typename T>
+void Matrix<T>::compress() {
+    if (not sparse or compressed) return;
+    rowOffsets = vector<size_t>(rows+1, 0);
+    for (uint i = 0; i < rows; i++) rowOffsets[i+1] = rowOffsets[i] + openCols[i].size();
+    colIndex.clear();
+    values.clear();
+    colIndex.reserve(rowOffsets[rows]);
+    values.reserve(rowOffsets[rows]);
+    for (uint i = 0; i < rows; i++) {
+        colIndex.insert(colIndex.end(), openCols[i].begin(), openCols[i].end());
+        values.insert(values.end(), openValues[i].begin(), openValues[i].end());
+    }
+    vector<vector<uint> >().swap(openCols);
+    vector<vector<T> >().swap(openValues);
+    compressed = true;
+}
+
+template <typename T>
+void Matrix<T>::decompress() {
+    openCols = vector<vector<uint> >(rows);
+    openValues = vector<vector<T> >(rows);
+    for (uint i = 0; i < rows; i++) {
+        openCols[i].assign(colIndex.begin() + rowOffsets[i], colIndex.begin() + rowOffsets[i+1]);
+        openValues[i].assign(values.begin() + rowOffsets[i], values.begin() + rowOffsets[i+1]);
+    }
+    vector<size_t>().swap(rowOffsets);
+    vector<uint>().swap(colIndex);
+    vector<T>().swap(values);
+    compressed = false;
 }
 #endif
@@ -0,0 +1,73 @@
+#ifndef PEGHOLEFREQUENCY_HPP
+#define PEGHOLEFREQUENCY_HPP
+
+#include <vector>
+#include <limits>
+#include <sys/types.h>
+
+/*
+How often (or with how much weight) each G1 node (peg) sat on each G2 node
+(hole), for the core alignment statistics of -DCORES builds. A dense n1 x n2
+table does not fit for large networks, so each peg keeps at most capacity
+holes, by the Space-Saving rule: a new hole in a full table replaces the hole
+with the smallest total and carries on from that total.
+
+A peg that visited at most capacity distinct holes has exact totals. Otherwise
+a total is over by at most the smallest total of its peg, and every hole that
+got more than 1/capacity of the peg's weight is in the table.
+*/
+template <typename T>
+class PegHoleFrequency {
+public:
+    static const uint NO_HOLE = std::numeric_limits<uint>::max();
+
+    PegHoleFrequency(): capacity(0) {}
+    PegHoleFrequency(uint numPegs, uint capacity):
+        capacity(capacity),
+        holes((size_t) numPegs * capacity, NO_HOLE),
+        totals((size_t) numPegs * capacity, 0) {}
+
+    void add(uint peg, uint hole, T weight) {
+        uint* pegHoles = &holes[(size_t) peg * capacity];
+        T* pegTotals = &totals[(size_t) peg * capacity];
+        //holes are filled in order, so the first NO_HOLE ends the used part
+        uint smallest = 0;
+        for (uint k = 0; k < capacity; k++) {
+            if (pegHoles[k] == hole) {
+                pegTotals[k] += weight;
+                return;
+            }
+            if (pegHoles[k] == NO_HOLE) {
+                pegHoles[k] = hole;
+                pegTotals[k] = weight;
+                return;
+            }
+            if (pegTotals[k] < pegTotals[smallest]) smallest = k;
+        }
+        pegHoles[smallest] = hole;
+        pegTotals[smallest] += weight;
+    }
+
+    //0 if hole is not in peg's table
+    T get(uint peg, uint hole) const {
+        for (size_t k = (size_t) peg * capacity, end = k + capacity; k < end and holes[k] != NO_HOLE; k++) {
+            if (holes[k] == hole) return totals[k];
+        }
+        return 0;
+    }
+
+    //calls visit(hole, total) for every hole in peg's table
+    template <class Visit>
+    void forEach(uint peg, Visit visit) const {
+        for (size_t k = (size_t) peg * capacity, end = k + capacity; k < end and holes[k] != NO_HOLE; k++) {
+            visit(holes[k], totals[k]);
+        }
+    }
+
+private:
+    uint capacity;
+    std::vector<uint> holes; //capacity per peg, peg-major
+    std::vector<T> totals;
+};
+
+#endif
@@ -17,7 +17,7 @@ void SeedMatrix::init_column_vector(){
   column_vector.reserve(sims.size());
   for(uint i = 0; i < sims.size(); ++i){
     float max = -1;
-    for(uint j = 0; j < sims[i].size(); ++j){
+    for(uint j = 0; j < sims.numCols(); ++j){
       if(sims[i][j] > max){
     max = sims[i][j];
       }
@@ -27,14 +27,14 @@ void SeedMatrix::init_column_vector(){
     curr.pairs = NULL;
     curr.top = max;
     curr.start = 0;
-    curr.end = (uint)sims[i].size();
+    curr.end = sims.numCols();
     /*
     seed_t curr = {
       i, 
       NULL,
       max,
       0, 
-      (uint)sims[i].size()
+      sims.numCols()
     };
     */
     column_vector.push_back(curr);
@@ -125,12 +125,12 @@ uint SeedMatrix::bin_search(vector<node_t> & vec, float val, uint i, uint j){
 
 vector<node_t> * SeedMatrix::create_node(uint node_num){
   std::cout << "create node " << node_num << std::endl;
-  vector<float> & sim_row = sims[node_num];
-  std::cout << "row size" << sim_row.size() << std::endl;
+  const float * sim_row = sims[node_num];
+  std::cout << "row size" << sims.numCols() << std::endl;
   vector<node_t> * out = new vector<node_t>();
-  out->reserve(sim_row.size());
+  out->reserve(sims.numCols());
   std::cout << "out vector created" << std::endl;
-  for(uint j = 0; j < sim_row.size(); ++j){
+  for(uint j = 0; j < sims.numCols(); ++j){
     node_t curr = {sim_row[j], j};
     //std::cout << "node " << j << curr.sim << std::endl;
     out->push_back(curr);
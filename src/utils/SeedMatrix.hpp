@@ -60,7 +60,7 @@ public:
   SeedMatrix(MeasureCombination * MC, double delta, bool isMaxHeap, std::unordered_set<uint> & lex, std::unordered_set<uint> & rex);
   ~SeedMatrix();
   std::pair<uint,uint> pop_uniform();
-  void init_column_vector(vector<vector<float> > & sims);
+  void init_column_vector(SimMatrix & sims);
   //void save();
   //void load();
   /*
@@ -69,7 +69,7 @@ public:
 protected:
   
 private:
-  vector<vector<float> > sims;
+  SimMatrix sims;
   uint init_ptr;
   float delta;
   bool isMaxHeap;
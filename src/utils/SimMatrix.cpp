@@ -0,0 +1,73 @@
+#include "SimMatrix.hpp"
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+bool simMatrixCache = true;
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'S','A','N','A','S','I','M','\0'};
+const uint32_t CACHE_VERSION = 1;
+
+//64 bytes so the cells that follow stay cache-line aligned in the mapping
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t unused;
+    uint64_t key;
+    char reserved[32];
+};
+static_assert(sizeof(CacheHeader) == 64, "cache header must stay 64 bytes");
+
+}
+
+bool SimMatrix::mapCacheFile(const string& fileName, uint numRows, uint numCols, uint64_t key) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+    size_t length = sizeof(CacheHeader) + (size_t)numRows * numCols * sizeof(float);
+    struct stat st;
+    CacheHeader header;
+    bool valid = fstat(fd, &st) == 0 and (size_t)st.st_size == length and
+        pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) and
+        memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 and
+        header.version == CACHE_VERSION and header.rows == numRows and
+        header.cols == numCols and header.key == key;
+    void* addr = MAP_FAILED;
+    if (valid) addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return false;
+
+    rows = numRows;
+    cols = numCols;
+    cells.clear();
+    cells.shrink_to_fit();
+    mapping = shared_ptr<void>(addr, [length](void* p) { munmap(p, length); });
+    base = (float*) ((char*) addr + sizeof(CacheHeader));
+    return true;
+}
+
+bool SimMatrix::writeCacheFile(const string& fileName, uint64_t key) const {
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.rows = rows;
+    header.cols = cols;
+    header.key = key;
+
+    string tmpName = fileName + ".tmp" + to_string(getpid());
+    FILE* fp = fopen(tmpName.c_str(), "wb");
+    if (not fp) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 and
+        fwrite(data(), sizeof(float), numCells(), fp) == numCells();
+    ok = (fclose(fp) == 0) and ok;
+    if (ok) ok = rename(tmpName.c_str(), fileName.c_str()) == 0;
+    if (not ok) remove(tmpName.c_str());
+    return ok;
+}
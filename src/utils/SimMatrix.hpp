@@ -0,0 +1,88 @@
+#ifndef SIMMATRIX_HPP
+#define SIMMATRIX_HPP
+
+#include "Matrix.hpp"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <cstdint>
+
+using namespace std;
+
+//false when running with -no-sim-cache
+extern bool simMatrixCache;
+
+/*
+Dense n1 x n2 similarity matrix stored row-major in a single aligned block.
+sims[i] is a plain pointer to row i, so sims[i][j] costs one multiply-add
+and whole-matrix passes (aggregation, scaling, sums) are flat, vectorizable loops.
+
+The cells either live in the matrix itself or in a mapped cache file (see
+mapCacheFile). Mapped pages are copy-on-write, so they are shared with every
+other process that maps the same file until someone writes to them. Copies of
+a mapped matrix always own their cells.
+*/
+class SimMatrix {
+public:
+    SimMatrix(): rows(0), cols(0), base(nullptr) {}
+    SimMatrix(uint rows, uint cols, float value = 0):
+        rows(rows), cols(cols), cells((size_t)rows * cols, value), base(cells.data()) {}
+    SimMatrix(const SimMatrix& other):
+        rows(other.rows), cols(other.cols),
+        cells(other.data(), other.data() + other.numCells()), base(cells.data()) {}
+    SimMatrix(SimMatrix&& other):
+        rows(other.rows), cols(other.cols), cells(move(other.cells)),
+        mapping(move(other.mapping)), base(other.base) {
+        other.rows = other.cols = 0;
+        other.base = nullptr;
+    }
+    SimMatrix& operator = (SimMatrix other) {
+        swap(rows, other.rows);
+        swap(cols, other.cols);
+        cells.swap(other.cells);
+        mapping.swap(other.mapping);
+        swap(base, other.base);
+        return *this;
+    }
+
+    float* operator [] (uint i) { return base + (size_t)i * cols; }
+    const float* operator [] (uint i) const { return base + (size_t)i * cols; }
+
+    uint size() const { return rows; } //number of rows, as with vector<vector<float> >
+    uint numRows() const { return rows; }
+    uint numCols() const { return cols; }
+    size_t numCells() const { return (size_t)rows * cols; }
+
+    float* data() { return base; }
+    const float* data() const { return base; }
+
+    bool isMapped() const { return mapping != nullptr; }
+
+    //cache files: a fixed header (magic, version, rows, cols, key) followed
+    //by the cells. mapCacheFile returns false, leaving the matrix untouched,
+    //if the file is missing or does not match rows, cols and key.
+    bool mapCacheFile(const string& fileName, uint rows, uint cols, uint64_t key);
+    //written to a temporary file and renamed, so concurrent readers never see a partial file
+    bool writeCacheFile(const string& fileName, uint64_t key) const;
+
+private:
+    uint rows, cols;
+    vector<float, AlignedAllocator<float> > cells;
+    shared_ptr<void> mapping;
+    float* base;
+};
+
+inline void writeMatrixToBinaryFile(const SimMatrix& matrix, const string& fileName) {
+    ofstream fout(fileName.c_str(), ios::out | ios::binary);
+    fout.write((const char*)matrix.data(), matrix.numCells()*sizeof(float));
+    fout.close();
+}
+
+inline void readMatrixFromBinaryFile(SimMatrix& matrix, const string& fileName) {
+    ifstream fin(fileName.c_str(), ios::in | ios::binary);
+    fin.read((char*)matrix.data(), matrix.numCells()*sizeof(float));
+    fin.close();
+}
+
+#endif
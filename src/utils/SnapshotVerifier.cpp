@@ -0,0 +1,58 @@
+#include "SnapshotVerifier.hpp"
+
+using namespace std;
+
+SnapshotVerifier::SnapshotVerifier(function<double(const vector<unsigned int>&)> evaluate):
+    evaluate(evaluate), worker(&SnapshotVerifier::work, this) {}
+
+SnapshotVerifier::~SnapshotVerifier() {
+    {
+        lock_guard<mutex> lock(stateMutex);
+        stop = true;
+    }
+    changed.notify_all();
+    worker.join();
+}
+
+void SnapshotVerifier::submit(const vector<unsigned int>& mapping, double expected, long long int stamp) {
+    {
+        lock_guard<mutex> lock(stateMutex);
+        back.assign(mapping.begin(), mapping.end()); //reuses the buffer's capacity
+        backExpected = expected;
+        backStamp = stamp;
+        waiting = true;
+    }
+    changed.notify_all();
+}
+
+bool SnapshotVerifier::takeResult(Result& res) {
+    lock_guard<mutex> lock(stateMutex);
+    if (not hasResult) return false;
+    res = result;
+    hasResult = false;
+    return true;
+}
+
+void SnapshotVerifier::wait() {
+    unique_lock<mutex> lock(stateMutex);
+    changed.wait(lock, [this]() { return not waiting and not busy; });
+}
+
+void SnapshotVerifier::work() {
+    unique_lock<mutex> lock(stateMutex);
+    while (true) {
+        changed.wait(lock, [this]() { return waiting or stop; });
+        if (stop) return;
+        front.swap(back);
+        Result current = {backStamp, backExpected, 0};
+        waiting = false;
+        busy = true;
+        lock.unlock();
+        current.actual = evaluate(front);
+        lock.lock();
+        result = current;
+        hasResult = true;
+        busy = false;
+        changed.notify_all();
+    }
+}
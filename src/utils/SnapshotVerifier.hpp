@@ -0,0 +1,52 @@
+#ifndef SNAPSHOTVERIFIER_HPP
+#define SNAPSHOTVERIFIER_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/*
+Evaluates a function of a mapping on a background thread while the caller
+keeps changing the mapping. The snapshots are double buffered: submit() copies
+the mapping into the back buffer and returns at once; the worker swaps it with
+the front buffer and evaluates the front one. If the worker is still busy, a
+newer submit() replaces the snapshot that is waiting, so at most one waits.
+*/
+class SnapshotVerifier {
+public:
+    struct Result {
+        long long int stamp; //as given to submit()
+        double expected; //the value the caller had for the snapshot
+        double actual; //the value evaluate computed for it
+    };
+
+    //evaluate is only ever called from the worker thread
+    explicit SnapshotVerifier(std::function<double(const std::vector<unsigned int>&)> evaluate);
+    ~SnapshotVerifier();
+    SnapshotVerifier(const SnapshotVerifier&) = delete;
+    SnapshotVerifier& operator=(const SnapshotVerifier&) = delete;
+
+    void submit(const std::vector<unsigned int>& mapping, double expected, long long int stamp);
+    //the most recent result not taken yet, if any
+    bool takeResult(Result& result);
+    //blocks until no snapshot is waiting or being evaluated
+    void wait();
+
+private:
+    std::function<double(const std::vector<unsigned int>&)> evaluate;
+    std::vector<unsigned int> back, front;
+    double backExpected;
+    long long int backStamp;
+    bool waiting = false, busy = false, stop = false;
+    Result result;
+    bool hasResult = false;
+    std::mutex stateMutex;
+    std::condition_variable changed;
+    std::thread worker;
+
+    void work();
+};
+
+#endif
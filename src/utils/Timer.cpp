@@ -13,6 +13,10 @@ void Timer::start() {
     startTime = get();
 }
 
+void Timer::startFrom(double elapsedSeconds) {
+    startTime = get() - (long long) (elapsedSeconds * 1000);
+}
+
 double Timer::elapsed() const {
     long long current;
     if (startTime == -1 or (current = get()) == -1) return -1;
@@ -8,6 +8,7 @@ public:
     Timer();
 
     void start();
+    void startFrom(double elapsedSeconds); //as if elapsedSeconds had already passed
     double elapsed() const;
     string elapsedString() const;
 
@@ -0,0 +1,80 @@
+#ifndef XOSHIRO256_HPP
+#define XOSHIRO256_HPP
+
+#include <cstdint>
+#include <limits>
+
+/*
+xoshiro256** (Blackman and Vigna): a 256-bit state generator that is several
+times cheaper than mt19937 and passes BigCrush. It satisfies
+UniformRandomBitGenerator, so it also works with the <random> distributions,
+but the hot paths should use below() and real(), which are cheaper still.
+The same seed always gives the same sequence, on every platform.
+*/
+class Xoshiro256 {
+public:
+    typedef uint64_t result_type;
+
+    explicit Xoshiro256(uint64_t seed = 0) { this->seed(seed); }
+
+    //the 4 state words are expanded from the seed with splitmix64, so that
+    //nearby seeds (e.g., seed+1 for a second thread) give unrelated streams
+    void seed(uint64_t seed) {
+        for (int i = 0; i < 4; i++) {
+            uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            s[i] = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    //uniform in [0, range), range > 0. Lemire's multiply-shift, which only
+    //divides (and redraws) in the rare case the product lands in the biased zone.
+    uint32_t below(uint32_t range) {
+        uint64_t m = (uint64_t) (uint32_t) ((*this)() >> 32) * range;
+        uint32_t low = (uint32_t) m;
+        if (low < range) {
+            const uint32_t threshold = (0u - range) % range;
+            while (low < threshold) {
+                m = (uint64_t) (uint32_t) ((*this)() >> 32) * range;
+                low = (uint32_t) m;
+            }
+        }
+        return m >> 32;
+    }
+
+    //uniform in [0, 1), with 53 random bits
+    double real() {
+        return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    //for cereal: saving and loading the state continues the same sequence
+    template<class Archive>
+    void serialize(Archive& archive) {
+        archive(s[0], s[1], s[2], s[3]);
+    }
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef PARALLELFOR_HPP
+#define PARALLELFOR_HPP
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+//one thread per core, at least one
+inline unsigned int defaultNumThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+//Runs body(begin, end, thread) over [0, count) on numThreads threads. Chunks
+//of chunkSize indices are handed out dynamically, so uneven work (e.g.,
+//high-degree nodes) does not leave threads idle. thread is in [0, numThreads)
+//and can index per-thread scratch space.
+template<class Body>
+void parallelFor(unsigned int count, unsigned int numThreads, unsigned int chunkSize, Body body) {
+    std::atomic<unsigned int> next(0);
+    auto worker = [&](unsigned int t) {
+        for (unsigned int begin; (begin = next.fetch_add(chunkSize)) < count; ) {
+            body(begin, std::min(begin+chunkSize, count), t);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < numThreads; t++) {
+        workers.push_back(std::thread(worker, t));
+    }
+    worker(0);
+    for (std::thread& w : workers) w.join();
+}
+
+#endif
@@ -17,6 +17,7 @@
 #include <dirent.h>
 #include "utils.hpp"
 #include "randomSeed.hpp"
+#include "Decompressor.hpp"
 
 using namespace std;
 
@@ -190,7 +191,9 @@ FILE* readFileAsFilePointer(const string& fileName, bool& piped) {
     FILE* fp;
     string decompressionProg = getDecompressionProgram(fileName);
     piped = false;
-    if(decompressionProg != "")
+    if(Decompressor::supports(fileName))
+        fp = openDecompressed(fileName);
+    else if(decompressionProg != "")
     {
         fp = decompressFile(decompressionProg, fileName);
         piped = true;
@@ -510,3 +513,18 @@ pair<unsigned, unsigned> countVecLens(string& fileName) //overcounts # of nodes
     pair<unsigned, unsigned> ret { nodes.size(), i / 2};
     return ret;
 }
+
+uint64_t hashBytes(const void* data, size_t length, uint64_t hash) {
+    const unsigned char* bytes = (const unsigned char*) data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+string fileStamp(const string& fileName) {
+    struct stat st;
+    if (stat(fileName.c_str(), &st) != 0) return "";
+    return to_string((long long) st.st_size) + ":" + to_string((long long) st.st_mtime);
+}
@@ -100,4 +100,9 @@ vector<string> split(const string& s, char c);
 
 bool newerGraphAvailable(const char* graphDir, const char* binaryDir);
 pair<unsigned, unsigned> countVecLens(string& fileName);
+
+//64-bit FNV-1a; pass the previous result as hash to chain several buffers
+uint64_t hashBytes(const void* data, size_t length, uint64_t hash = 14695981039346656037ULL);
+//"size:mtime" of a file, or "" if it does not exist. Used to key caches on input files.
+string fileStamp(const string& fileName);
 #endif
\ No newline at end of file